@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file iolink_bench.c
+ * @brief Native throughput benchmark for the DLL frame path and ISDU collection
+ *
+ * Feeds pre-generated M-sequences from an in-memory PHY for every M-sequence type
+ * and PD length 0..32, and prints frames/sec, ns/frame and ns/byte as JSON. A
+ * multi-instance run serves up to BENCH_MAX_INSTANCES contexts round-robin.
+ *
+ * Built against a library with IOLINK_FIXED_* set (iolink_bench_fixed), only the
+ * pinned configuration is measured; pass the same type and length to the generic
+ * build to compare both paths.
+ *
+ * Usage: iolink_bench [frames_per_config [m_seq_type pd_len]]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "iolinki/iolink.h"
+#include "iolinki/crc.h"
+#include "iolinki/isdu.h"
+#include "iolinki/protocol.h"
+
+#define BENCH_DEFAULT_FRAMES 20000U
+#define BENCH_FRAME_VARIANTS 16U
+#define BENCH_MAX_FRAME 48U
+#define BENCH_ISDU_MAX_STREAM 512U
+#define BENCH_MAX_INSTANCES 2048U
+
+#ifdef IOLINK_FIXED_M_SEQ_TYPE
+#define BENCH_MULTI_M_SEQ_TYPE ((iolink_m_seq_type_t) IOLINK_FIXED_M_SEQ_TYPE)
+#define BENCH_MULTI_PD_LEN ((uint8_t) IOLINK_FIXED_PD_OUT_LEN)
+#else
+#define BENCH_MULTI_M_SEQ_TYPE IOLINK_M_SEQ_TYPE_2_2
+#define BENCH_MULTI_PD_LEN 4U
+#endif
+
+#ifdef IOLINK_FIXED_M_SEQ_TYPE
+#define BENCH_BUILD "fixed"
+#else
+#define BENCH_BUILD "generic"
+#endif
+
+/* In-memory PHY: serves one frame per iolink_process() pass */
+static const uint8_t* g_rx_data;
+static size_t g_rx_len;
+static size_t g_rx_pos;
+static int g_wakeup;
+static size_t g_tx_bytes;
+
+static int bench_recv_byte(uint8_t* byte)
+{
+    if (g_rx_pos >= g_rx_len) {
+        return 0;
+    }
+    *byte = g_rx_data[g_rx_pos++];
+    return 1;
+}
+
+static int bench_recv_buf(uint8_t* buf, size_t len)
+{
+    size_t avail = g_rx_len - g_rx_pos;
+    if (avail == 0U) {
+        return 0;
+    }
+    if (avail > len) {
+        avail = len;
+    }
+    (void) memcpy(buf, &g_rx_data[g_rx_pos], avail);
+    g_rx_pos += avail;
+    return (int) avail;
+}
+
+static int bench_send(const uint8_t* data, size_t len)
+{
+    (void) data;
+    g_tx_bytes += len;
+    return (int) len;
+}
+
+static int bench_detect_wakeup(void)
+{
+    int ret = g_wakeup;
+    g_wakeup = 0;
+    return ret;
+}
+
+static const iolink_phy_api_t g_phy_byte = {
+    .send = bench_send, .recv_byte = bench_recv_byte, .detect_wakeup = bench_detect_wakeup};
+
+static const iolink_phy_api_t g_phy_burst = {.send = bench_send,
+                                             .recv_byte = bench_recv_byte,
+                                             .detect_wakeup = bench_detect_wakeup,
+                                             .recv_buf = bench_recv_buf};
+
+static void bench_feed(const uint8_t* data, size_t len)
+{
+    g_rx_data = data;
+    g_rx_len = len;
+    g_rx_pos = 0U;
+}
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+static const char* bench_type_name(iolink_m_seq_type_t type)
+{
+    switch (type) {
+        case IOLINK_M_SEQ_TYPE_0:
+            return "0";
+        case IOLINK_M_SEQ_TYPE_1_1:
+            return "1_1";
+        case IOLINK_M_SEQ_TYPE_1_2:
+            return "1_2";
+        case IOLINK_M_SEQ_TYPE_1_V:
+            return "1_V";
+        case IOLINK_M_SEQ_TYPE_2_1:
+            return "2_1";
+        case IOLINK_M_SEQ_TYPE_2_2:
+            return "2_2";
+        case IOLINK_M_SEQ_TYPE_2_V:
+            return "2_V";
+        default:
+            return "?";
+    }
+}
+
+static uint8_t bench_od_len(iolink_m_seq_type_t type)
+{
+    return ((type == IOLINK_M_SEQ_TYPE_2_1) || (type == IOLINK_M_SEQ_TYPE_2_2) ||
+            (type == IOLINK_M_SEQ_TYPE_2_V))
+               ? 2U
+               : 1U;
+}
+
+/* Build a master frame: MC | CKT | PD_out | OD | CK (Type 0: MC | CK) */
+static uint8_t bench_build_frame(iolink_m_seq_type_t type, uint8_t pd_len, uint8_t variant,
+                                 uint8_t* frame)
+{
+    if (type == IOLINK_M_SEQ_TYPE_0) {
+        frame[0] = 0x80U;
+        frame[1] = iolink_checksum_ck(frame[0], 0U);
+        return 2U;
+    }
+
+    uint8_t len = (uint8_t) (IOLINK_M_SEQ_HEADER_LEN + pd_len + bench_od_len(type) + 1U);
+    (void) memset(frame, 0, len);
+    frame[0] = 0x80U;
+    for (uint8_t i = 0U; i < pd_len; i++) {
+        frame[IOLINK_M_SEQ_HEADER_LEN + i] = (uint8_t) ((variant * 31U) + i);
+    }
+    frame[len - 1U] = iolink_crc6(frame, (uint8_t) (len - 1U));
+    return len;
+}
+
+static int bench_to_operate(iolink_instance_t* inst, const iolink_phy_api_t* phy,
+                            iolink_m_seq_type_t type, uint8_t pd_len)
+{
+    iolink_config_t config = {.m_seq_type = type, .pd_in_len = pd_len, .pd_out_len = pd_len};
+    if (iolink_instance_init(inst, phy, &config) != 0) {
+        return -1;
+    }
+    iolink_dll_set_timing_enforcement(&inst->dll, false);
+
+    g_wakeup = 1;
+    bench_feed(NULL, 0U);
+    iolink_instance_process(inst);
+
+    static uint8_t trans[2];
+    trans[0] = IOLINK_MC_TRANSITION_COMMAND;
+    trans[1] = iolink_checksum_ck(trans[0], 0U);
+    bench_feed(trans, sizeof(trans));
+    iolink_instance_process(inst);
+
+    static uint8_t first[BENCH_MAX_FRAME];
+    size_t len = bench_build_frame(type, pd_len, 0U, first);
+    bench_feed(first, len);
+    iolink_instance_process(inst);
+
+    iolink_dll_state_t state = iolink_instance_get_state(inst);
+    if (type == IOLINK_M_SEQ_TYPE_0) {
+        return (state == IOLINK_DLL_STATE_ESTAB_COM) ? 0 : -1;
+    }
+    return (state == IOLINK_DLL_STATE_OPERATE) ? 0 : -1;
+}
+
+static int bench_dll_config(iolink_m_seq_type_t type, uint8_t pd_len, bool burst,
+                            uint32_t frames, bool* first)
+{
+    static iolink_instance_t inst;
+    static uint8_t variants[BENCH_FRAME_VARIANTS][BENCH_MAX_FRAME];
+    const iolink_phy_api_t* phy = burst ? &g_phy_burst : &g_phy_byte;
+
+    if (bench_to_operate(&inst, phy, type, pd_len) != 0) {
+        fprintf(stderr, "bench: type %s pd %u did not reach OPERATE\n", bench_type_name(type),
+                (unsigned) pd_len);
+        return -1;
+    }
+
+    uint8_t frame_len = 0U;
+    for (uint8_t v = 0U; v < BENCH_FRAME_VARIANTS; v++) {
+        frame_len = bench_build_frame(type, pd_len, v, variants[v]);
+    }
+
+    iolink_dll_stats_t before;
+    iolink_instance_get_stats(&inst, &before);
+    g_tx_bytes = 0U;
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0U; i < frames; i++) {
+        bench_feed(variants[i % BENCH_FRAME_VARIANTS], frame_len);
+        iolink_instance_process(&inst);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    iolink_dll_stats_t after;
+    iolink_instance_get_stats(&inst, &after);
+    if ((after.crc_errors != before.crc_errors) ||
+        (after.framing_errors != before.framing_errors)) {
+        fprintf(stderr, "bench: type %s pd %u produced frame errors\n", bench_type_name(type),
+                (unsigned) pd_len);
+        return -1;
+    }
+
+    double ns_frame = (double) elapsed / (double) frames;
+    printf("%s\n    {\"m_seq_type\": \"%s\", \"pd_len\": %u, \"rx_path\": \"%s\", "
+           "\"frame_len\": %u, \"frames\": %u, \"frames_per_sec\": %.0f, "
+           "\"ns_per_frame\": %.1f, \"ns_per_byte\": %.2f}",
+           *first ? "" : ",", bench_type_name(type), (unsigned) pd_len, burst ? "burst" : "byte",
+           (unsigned) frame_len, (unsigned) frames, 1e9 / ns_frame, ns_frame,
+           ns_frame / (double) frame_len);
+    *first = false;
+    return 0;
+}
+
+/*
+ * Many instances served round-robin, one frame each, as on a multi-port master
+ * simulation or gateway: per-frame cost once the contexts no longer fit in cache.
+ */
+static int bench_dll_multi(uint32_t instances, uint32_t frames, bool* first)
+{
+    static iolink_instance_t insts[BENCH_MAX_INSTANCES];
+    static uint8_t variants[BENCH_FRAME_VARIANTS][BENCH_MAX_FRAME];
+    const iolink_m_seq_type_t type = BENCH_MULTI_M_SEQ_TYPE;
+    const uint8_t pd_len = BENCH_MULTI_PD_LEN;
+
+    for (uint32_t n = 0U; n < instances; n++) {
+        if (bench_to_operate(&insts[n], &g_phy_burst, type, pd_len) != 0) {
+            fprintf(stderr, "bench: instance %u did not reach OPERATE\n", (unsigned) n);
+            return -1;
+        }
+    }
+    uint8_t frame_len = 0U;
+    for (uint8_t v = 0U; v < BENCH_FRAME_VARIANTS; v++) {
+        frame_len = bench_build_frame(type, pd_len, v, variants[v]);
+    }
+
+    uint32_t rounds = (frames + instances - 1U) / instances;
+    uint64_t start = bench_now_ns();
+    for (uint32_t r = 0U; r < rounds; r++) {
+        for (uint32_t n = 0U; n < instances; n++) {
+            bench_feed(variants[(r + n) % BENCH_FRAME_VARIANTS], frame_len);
+            iolink_instance_process(&insts[n]);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    double ns_frame = (double) elapsed / (double) (rounds * instances);
+    printf("%s\n    {\"instances\": %u, \"m_seq_type\": \"%s\", \"pd_len\": %u, "
+           "\"frames\": %u, \"ns_per_frame\": %.1f}",
+           *first ? "" : ",", (unsigned) instances, bench_type_name(type), (unsigned) pd_len,
+           (unsigned) (rounds * instances), ns_frame);
+    *first = false;
+    return 0;
+}
+
+/* Interleaved V1.1.5 request stream: [control][data] pairs */
+static size_t bench_isdu_stream(uint8_t payload_len, uint8_t* out)
+{
+    size_t n = 0U;
+    uint8_t seq = 0U;
+
+    out[n++] = 0x80U; /* Start, seq 0 */
+    if (payload_len == 0U) {
+        out[n++] = 0x80U; /* Read */
+    }
+    else if (payload_len <= 15U) {
+        out[n++] = (uint8_t) (0x90U | payload_len);
+    }
+    else {
+        out[n++] = 0x9FU;
+        out[n++] = (uint8_t) (++seq & 0x3FU);
+        out[n++] = payload_len;
+    }
+
+    const uint8_t header[3] = {0x00U, 0x40U, 0x00U}; /* Index 0x0040, subindex 0 */
+    for (uint8_t i = 0U; i < 3U; i++) {
+        uint8_t ctrl = (uint8_t) (++seq & 0x3FU);
+        if ((payload_len == 0U) && (i == 2U)) {
+            ctrl |= 0x40U; /* Last */
+        }
+        out[n++] = ctrl;
+        out[n++] = header[i];
+    }
+
+    for (uint8_t i = 0U; i < payload_len; i++) {
+        uint8_t ctrl = (uint8_t) (++seq & 0x3FU);
+        if (i == (uint8_t) (payload_len - 1U)) {
+            ctrl |= 0x40U;
+        }
+        out[n++] = ctrl;
+        out[n++] = (uint8_t) (i * 7U);
+    }
+    return n;
+}
+
+static void bench_isdu(uint8_t payload_len, uint32_t requests, bool* first)
+{
+    static iolink_isdu_ctx_t isdu;
+    static uint8_t stream[BENCH_ISDU_MAX_STREAM];
+    size_t len = bench_isdu_stream(payload_len, stream);
+
+    iolink_isdu_init(&isdu);
+    uint64_t start = bench_now_ns();
+    for (uint32_t r = 0U; r < requests; r++) {
+        for (size_t i = 0U; i < len; i++) {
+            (void) iolink_isdu_collect_byte(&isdu, stream[i]);
+        }
+        /* Request complete (SERVICE_EXECUTE): rearm without running the service */
+        isdu.state = ISDU_STATE_IDLE;
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    double ns_req = (double) elapsed / (double) requests;
+    printf("%s\n    {\"payload_len\": %u, \"stream_len\": %u, \"requests\": %u, "
+           "\"requests_per_sec\": %.0f, \"ns_per_request\": %.1f, \"ns_per_byte\": %.2f}",
+           *first ? "" : ",", (unsigned) payload_len, (unsigned) len, (unsigned) requests,
+           1e9 / ns_req, ns_req, ns_req / (double) len);
+    *first = false;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t frames = BENCH_DEFAULT_FRAMES;
+    int only_type = -1;
+    int only_pd = -1;
+    if (argc >= 2) {
+        frames = (uint32_t) strtoul(argv[1], NULL, 10);
+    }
+    if (argc >= 4) {
+        only_type = atoi(argv[2]);
+        only_pd = atoi(argv[3]);
+    }
+#ifdef IOLINK_FIXED_M_SEQ_TYPE
+    only_type = IOLINK_FIXED_M_SEQ_TYPE;
+    only_pd = IOLINK_FIXED_PD_OUT_LEN;
+#endif
+    if ((frames == 0U) || (argc == 3) || (only_type > (int) IOLINK_M_SEQ_TYPE_2_V) ||
+        (only_pd > (int) IOLINK_PD_OUT_MAX_SIZE)) {
+        fprintf(stderr, "Usage: %s [frames_per_config [m_seq_type pd_len]]\n", argv[0]);
+        return 1;
+    }
+
+    static const iolink_m_seq_type_t types[] = {
+        IOLINK_M_SEQ_TYPE_0,   IOLINK_M_SEQ_TYPE_1_1, IOLINK_M_SEQ_TYPE_1_2, IOLINK_M_SEQ_TYPE_1_V,
+        IOLINK_M_SEQ_TYPE_2_1, IOLINK_M_SEQ_TYPE_2_2, IOLINK_M_SEQ_TYPE_2_V};
+
+    int rc = 0;
+    bool first = true;
+    printf("{\n  \"build\": \"%s\",\n  \"frames_per_config\": %u,\n"
+           "  \"dll_ctx_bytes\": %u,\n  \"dll_hot_bytes\": %u,\n  \"dll_process\": [",
+           BENCH_BUILD, (unsigned) frames, (unsigned) sizeof(iolink_dll_ctx_t),
+           (unsigned) IOLINK_DLL_HOT_BYTES);
+    for (size_t t = 0U; t < (sizeof(types) / sizeof(types[0])); t++) {
+        if ((only_type >= 0) && ((int) types[t] != only_type)) {
+            continue;
+        }
+        uint8_t max_pd = (types[t] == IOLINK_M_SEQ_TYPE_0) ? 0U : IOLINK_PD_OUT_MAX_SIZE;
+        for (uint8_t pd = 0U; pd <= max_pd; pd++) {
+            if ((only_pd >= 0) && ((int) pd != only_pd)) {
+                continue;
+            }
+            for (int burst = 0; burst < 2; burst++) {
+                if (bench_dll_config(types[t], pd, burst != 0, frames, &first) != 0) {
+                    rc = 1;
+                }
+            }
+        }
+    }
+    printf("\n  ],\n  \"dll_multi_instance\": [");
+
+    static const uint32_t instance_counts[] = {1U, 16U, 256U, BENCH_MAX_INSTANCES};
+    first = true;
+    for (size_t i = 0U; i < (sizeof(instance_counts) / sizeof(instance_counts[0])); i++) {
+        if (bench_dll_multi(instance_counts[i], frames, &first) != 0) {
+            rc = 1;
+        }
+    }
+    printf("\n  ],\n  \"isdu_collect_byte\": [");
+
+    static const uint8_t payloads[] = {0U, 1U, 15U, 32U, 128U, 232U};
+    first = true;
+    for (size_t p = 0U; p < sizeof(payloads); p++) {
+        bench_isdu(payloads[p], frames, &first);
+    }
+    printf("\n  ]\n}\n");
+    return rc;
+}
@@ -8,6 +8,7 @@
 
 #include "iolinki/iolink.h"
 #include "iolinki/phy_virtual.h"
+#include "iolinki/params.h"
 
 /* Extern the volatile tick counter from time_utils_baremetal.c */
 extern volatile uint32_t g_iolink_ticks_ms;
@@ -32,6 +33,10 @@ int main(void)
         /* Process Stack */
         iolink_process();
 
+        /* Background work: write changed parameters to NVM (write-behind) */
+        iolink_params_process();
+        iolink_ds_process(iolink_get_ds_ctx());
+
         /* Simulate System Tick (Time Passage) */
         sys_tick_handler();
 
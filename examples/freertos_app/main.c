@@ -22,6 +22,7 @@
 
 #include "iolinki/iolink.h"
 #include "iolinki/platform.h"
+#include "iolinki/params.h"
 #include "iolinki/phy.h"
 
 /* Platform Override for Critical Sections */
@@ -66,12 +67,20 @@ void iolink_task_entry(void* pvParameters)
 void app_task_entry(void* pvParameters)
 {
     (void) pvParameters;
+    uint32_t ticks = 0U;
 
     for (;;) {
+        /* Parameter NVM writes run here, off the IO-Link cycle */
+        iolink_params_process();
+        iolink_ds_process(iolink_get_ds_ctx());
+
         /* Trigger an event every 5 seconds safely */
-        iolink_event_trigger(NULL /* ctx */, 0x1800, IOLINK_EVENT_TYPE_NOTIFICATION);
+        if (++ticks >= 50U) {
+            ticks = 0U;
+            iolink_event_trigger(NULL /* ctx */, 0x1800, IOLINK_EVENT_TYPE_NOTIFICATION);
+        }
 
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
@@ -6,11 +6,48 @@
  * See LICENSE for details.
  */
 
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <unistd.h>
 #include "iolinki/iolink.h"
 #include "iolinki/phy_virtual.h"
+#include "iolinki/run_loop.h"
+#include "iolinki/log.h"
+#include "iolinki/params.h"
+#include "iolinki/trace_pcapng.h"
+
+/* Optional frame capture: set IOLINK_TRACE=<file.pcapng> */
+static uint8_t g_trace_storage[16384];
+static iolink_trace_ring_t g_trace;
+
+/* Set by SIGINT/SIGTERM; the run loop wakes at least every 10 ms to check it */
+static volatile sig_atomic_t g_stop;
+
+static void on_signal(int sig)
+{
+    (void) sig;
+    g_stop = 1;
+}
+
+/* Detach the ring, write what is still queued and close the capture file */
+static void trace_close(FILE* fp)
+{
+    if (fp == NULL) {
+        return;
+    }
+    iolink_dll_trace_attach(&iolink_get_default_instance()->dll, NULL);
+    (void) iolink_trace_pcapng_drain(&g_trace, fp);
+    (void) fclose(fp);
+}
+
+/* Prints stack log records (build with -DIOLINK_LOG_LEVEL=1..4 to enable) */
+static void log_sink(void* arg, const iolink_log_record_t* rec, const char* text)
+{
+    static const char levels[] = "-EWID";
+    (void) arg;
+    char level = (rec->level < (sizeof(levels) - 1U)) ? levels[rec->level] : '?';
+    printf("[%10u us] %c %s\n", (unsigned int) rec->ts_us, level, text);
+}
 
 int main(int argc, char* argv[])
 {
@@ -74,18 +111,45 @@ int main(int argc, char* argv[])
         return -1;
     }
 
-    printf("Stack initialized successfully\n");
-    printf("Running protocol state machine...\n\n");
-
-    /* Simulate periodic processing and PD exchange */
+    FILE* trace_fp = NULL;
+    const char* trace_path = getenv("IOLINK_TRACE");
+    if (trace_path != NULL) {
+        trace_fp = fopen(trace_path, "wb");
+        if ((trace_fp != NULL) && (iolink_trace_pcapng_begin(trace_fp) == 0) &&
+            (iolink_trace_init(&g_trace, g_trace_storage, sizeof(g_trace_storage)) == 0)) {
+            iolink_dll_trace_attach(&iolink_get_default_instance()->dll, &g_trace);
+            printf("Tracing frames to %s\n", trace_path);
+        }
+        else {
+            printf("WARNING: Cannot open trace file %s\n", trace_path);
+            if (trace_fp != NULL) {
+                (void) fclose(trace_fp);
+                trace_fp = NULL;
+            }
+        }
+    }
 
-    while (1) {
-        iolink_process();
-        // ...
+    /* Sleep until the master sends bytes or a protocol deadline is due */
+    iolink_run_loop_t loop;
+    int phy_fd = iolink_phy_virtual_get_fd();
+    if (iolink_run_loop_init(&loop, iolink_get_default_instance(), phy_fd) != 0) {
+        printf("ERROR: Failed to set up the run loop\n");
+        trace_close(trace_fp);
+        return -1;
+    }
 
-        /* Update input data (Device -> Master) */
+    printf("Stack initialized successfully\n");
+    printf("Running protocol state machine...\n\n");
 
-        iolink_process();
+    (void) signal(SIGINT, on_signal);
+    (void) signal(SIGTERM, on_signal);
+    int ret = 0;
+    while (g_stop == 0) {
+        if (iolink_run_loop_once(&loop, 10) < 0) {
+            printf("ERROR: Run loop failed\n");
+            ret = -1;
+            break;
+        }
 
         /* Check for output data (Master -> Device) */
         uint8_t pd_buffer[32];
@@ -98,10 +162,19 @@ int main(int argc, char* argv[])
             iolink_pd_input_update(pd_buffer, (size_t) len, true);
         }
 
-        /* 1ms cycle time simulation */
-        /* Note: For accurate timing, use a timer or sleep less */
-        usleep(1000); /* 1ms polling to reduce CPU load */
+        /* Text formatting and NVM writes happen here, off the protocol path */
+        (void) iolink_log_drain(log_sink, NULL);
+        iolink_params_process();
+        iolink_ds_process(iolink_get_ds_ctx());
+
+        if (trace_fp != NULL) {
+            if (iolink_trace_pcapng_drain(&g_trace, trace_fp) > 0) {
+                (void) fflush(trace_fp);
+            }
+        }
     }
 
-    return 0;
+    iolink_run_loop_close(&loop);
+    trace_close(trace_fp);
+    return ret;
 }
@@ -16,6 +16,7 @@
 #include <zephyr/logging/log.h>
 #include "iolinki/iolink.h"
 #include "iolinki/phy_virtual.h"
+#include "iolinki/params.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -67,7 +68,9 @@ int main(void)
 
     while (1) {
         iolink_process();
-        k_msleep(1); /* 1ms cycle */
+        iolink_params_process(); /* Write-behind NVM flush; move to a low-priority thread */
+        iolink_ds_process(iolink_get_ds_ctx());
+        k_msleep(1);             /* 1ms cycle */
     }
     return 0;
 }
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_ATOMIC_H
+#define IOLINK_ATOMIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iolinki/platform.h"
+
+/**
+ * @file atomic.h
+ * @brief Minimal atomic helpers for lock-free producer/consumer structures
+ *
+ * Uses compiler builtins on GCC/Clang. Other toolchains fall back to
+ * iolink_critical_enter()/exit(), which platforms already provide.
+ *
+ * Read-modify-write operations need a native 32-bit compare-and-swap. Cores
+ * without one (ARMv6-M, e.g. Cortex-M0) would get __atomic_*_4 library calls
+ * that libgcc does not provide, so there they use the critical-section form;
+ * loads and stores stay plain builtins.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+
+static inline uint32_t iolink_atomic_load_u32(const volatile uint32_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void iolink_atomic_store_u32(volatile uint32_t* p, uint32_t value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+#else
+
+static inline uint32_t iolink_atomic_load_u32(const volatile uint32_t* p)
+{
+    iolink_critical_enter();
+    uint32_t value = *p;
+    iolink_critical_exit();
+    return value;
+}
+
+static inline void iolink_atomic_store_u32(volatile uint32_t* p, uint32_t value)
+{
+    iolink_critical_enter();
+    *p = value;
+    iolink_critical_exit();
+}
+
+#endif
+
+/** @brief 1 when read-modify-write helpers use native builtins, 0 for the critical-section form */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#define IOLINK_ATOMIC_NATIVE_CAS 1
+#else
+#define IOLINK_ATOMIC_NATIVE_CAS 0
+#endif
+
+#if IOLINK_ATOMIC_NATIVE_CAS
+
+static inline uint32_t iolink_atomic_exchange_u32(volatile uint32_t* p, uint32_t value)
+{
+    return __atomic_exchange_n(p, value, __ATOMIC_ACQ_REL);
+}
+
+static inline bool iolink_atomic_cas_u32(volatile uint32_t* p, uint32_t* expected,
+                                         uint32_t desired)
+{
+    return __atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t iolink_atomic_add_u32(volatile uint32_t* p, uint32_t value)
+{
+    return __atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+}
+
+#else
+
+static inline uint32_t iolink_atomic_exchange_u32(volatile uint32_t* p, uint32_t value)
+{
+    iolink_critical_enter();
+    uint32_t old = *p;
+    *p = value;
+    iolink_critical_exit();
+    return old;
+}
+
+static inline bool iolink_atomic_cas_u32(volatile uint32_t* p, uint32_t* expected,
+                                         uint32_t desired)
+{
+    iolink_critical_enter();
+    bool ok = (*p == *expected);
+    if (ok) {
+        *p = desired;
+    }
+    else {
+        *expected = *p;
+    }
+    iolink_critical_exit();
+    return ok;
+}
+
+static inline uint32_t iolink_atomic_add_u32(volatile uint32_t* p, uint32_t value)
+{
+    iolink_critical_enter();
+    uint32_t old = *p;
+    *p = old + value;
+    iolink_critical_exit();
+    return old;
+}
+
+#endif
+
+#endif  // IOLINK_ATOMIC_H
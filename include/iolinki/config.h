@@ -31,13 +31,34 @@
 #define IOLINK_ISDU_BUFFER_SIZE 256U
 #endif
 
+/**
+ * @brief Keep ISDU request and response in one buffer.
+ * ISDU is half-duplex: a handler consumes the request before the response is
+ * built, so the response can overwrite it in place. Halves ISDU buffer RAM.
+ * Default: 0 (separate request and response buffers).
+ */
+#ifndef IOLINK_ISDU_SINGLE_BUFFER
+#define IOLINK_ISDU_SINGLE_BUFFER 0
+#endif
+
+/**
+ * @brief ISDU buffers shared by all stack instances.
+ * 0 (default): every ISDU context embeds its own buffers. 1..32: contexts carry
+ * no buffers and borrow one from a common pool for the duration of a transfer.
+ * A request that finds the pool empty is answered with ISDU error 0x8030 (Busy).
+ */
+#ifndef IOLINK_ISDU_POOL_BUFFERS
+#define IOLINK_ISDU_POOL_BUFFERS 0
+#endif
+
 /* -------------------------------------------------------------------------
  * Events Configuration
  * ------------------------------------------------------------------------- */
 
 /**
  * @brief Size of the diagnostic Event Queue.
- * Start small for resource constrained devices.
+ * Start small for resource constrained devices. Must be a power of two.
+ * Repeated identical events share one entry, so bursts do not need extra depth.
  * Default: 4
  */
 #ifndef IOLINK_EVENT_QUEUE_SIZE
@@ -78,6 +99,18 @@
 #define IOLINK_TIMING_ENFORCE_DEFAULT 0U
 #endif
 
+/**
+ * @brief Width of the microsecond timebase (iolink_usec_t, see time_utils.h).
+ * 1: iolink_time_get_us() returns a free-running 32-bit tick that wraps every
+ * ~71.6 minutes; timestamps take 4 bytes and comparisons are single 32-bit ops
+ * (Cortex-M0/M3). All intervals the stack measures must stay below ~35 minutes.
+ * 0: 64-bit timestamps that do not wrap in practice.
+ * Default: 0
+ */
+#ifndef IOLINK_TIMEBASE_32BIT
+#define IOLINK_TIMEBASE_32BIT 0
+#endif
+
 /**
  * @brief Wake-up delay (t_dwu) in microseconds.
  * Default: 80us (spec-defined for wake-up pulse handling).
@@ -86,6 +119,17 @@
 #define IOLINK_T_DWU_US 80U
 #endif
 
+/**
+ * @brief Wake-up poll interval in SIO mode in microseconds.
+ * Wake-up requests are found by polling phy->detect_wakeup(), so in SIO mode
+ * iolink_next_deadline_us() reports a deadline at most this far ahead. The PHY
+ * must latch a wake-up request until it is polled.
+ * Default: 1000us
+ */
+#ifndef IOLINK_WAKEUP_POLL_US
+#define IOLINK_WAKEUP_POLL_US 1000U
+#endif
+
 /**
  * @brief Response time limits (t_ren) in microseconds.
  * Defaults are conservative and should be tuned per device/PHY.
@@ -102,6 +146,29 @@
 #define IOLINK_T_REN_COM3_US 230U
 #endif
 
+/**
+ * @brief Linear sub-buckets per octave of a latency histogram, as a power of two.
+ * Samples below 2^(SUB_BITS+1) us get one bucket each; above that every octave
+ * [2^k, 2^(k+1)) is split into 2^SUB_BITS equal buckets, so a bucket spans at most
+ * 1/2^SUB_BITS of its lower bound (2: 4 sub-buckets, within 25%). 0 gives plain
+ * log2 buckets, which can be off by a factor of two.
+ * Default: 2
+ */
+#ifndef IOLINK_LATENCY_HIST_SUB_BITS
+#define IOLINK_LATENCY_HIST_SUB_BITS 2U
+#endif
+
+/**
+ * @brief Number of buckets per latency histogram (4 bytes each, 3 per DLL context).
+ * The last bucket collects everything above the covered range. With the default
+ * 4 sub-buckets per octave, 56 buckets resolve samples up to ~28ms (16 buckets
+ * with IOLINK_LATENCY_HIST_SUB_BITS 0 cover about the same range).
+ * Default: 56
+ */
+#ifndef IOLINK_LATENCY_HIST_BUCKETS
+#define IOLINK_LATENCY_HIST_BUCKETS 56U
+#endif
+
 /* -------------------------------------------------------------------------
  * On-Request Data (OD) Configuration
  * ------------------------------------------------------------------------- */
@@ -125,4 +192,141 @@
 #define IOLINK_OD_EVENT_MODE 0U
 #endif
 
+/* -------------------------------------------------------------------------
+ * Fixed Link Configuration (build-time DLL specialization)
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Devices that ship with one M-sequence type and fixed PD lengths can pin them
+ * at build time. The DLL frame path then uses constants instead of the runtime
+ * fields: frame lengths fold, PD copies are unrolled and the branches for other
+ * M-sequence types drop out. iolink_init() and iolink_dll_set_pd_length() reject
+ * values that differ from the pinned ones.
+ *
+ * None of these is defined by default (generic path, any type and length).
+ *
+ * IOLINK_FIXED_M_SEQ_TYPE  Numeric iolink_m_seq_type_t value (0..6)
+ * IOLINK_FIXED_PD_IN_LEN   PD_In length in bytes (0..IOLINK_PD_IN_MAX_SIZE)
+ * IOLINK_FIXED_PD_OUT_LEN  PD_Out length in bytes (0..IOLINK_PD_OUT_MAX_SIZE)
+ */
+#if defined(IOLINK_FIXED_M_SEQ_TYPE) && ((IOLINK_FIXED_M_SEQ_TYPE) > 6)
+#error "IOLINK_FIXED_M_SEQ_TYPE must be an iolink_m_seq_type_t value (0..6)"
+#endif
+
+#if defined(IOLINK_FIXED_PD_IN_LEN) && ((IOLINK_FIXED_PD_IN_LEN) > IOLINK_PD_IN_MAX_SIZE)
+#error "IOLINK_FIXED_PD_IN_LEN exceeds IOLINK_PD_IN_MAX_SIZE"
+#endif
+
+#if defined(IOLINK_FIXED_PD_OUT_LEN) && ((IOLINK_FIXED_PD_OUT_LEN) > IOLINK_PD_OUT_MAX_SIZE)
+#error "IOLINK_FIXED_PD_OUT_LEN exceeds IOLINK_PD_OUT_MAX_SIZE"
+#endif
+
+/* -------------------------------------------------------------------------
+ * Interrupt-Driven Receive
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Enable iolink_dll_rx_isr() for feeding bytes from the UART RX interrupt.
+ * In OPERATE the ISR assembles the frame and sends the reply itself; other bytes
+ * are queued for iolink_process(). The PHY recv hooks are then not polled, and
+ * iolink_critical_enter() must mask the interrupt and nest.
+ * Default: 0 (bytes are polled through the PHY recv hooks)
+ */
+#ifndef IOLINK_DLL_RX_ISR
+#define IOLINK_DLL_RX_ISR 0
+#endif
+
+/**
+ * @brief Bytes the ISR can queue for iolink_process(). Must be a power of two.
+ * Covers the traffic outside OPERATE (start-up, PREOPERATE ISDU) between passes.
+ * Default: 32
+ */
+#ifndef IOLINK_DLL_RX_QUEUE_SIZE
+#define IOLINK_DLL_RX_QUEUE_SIZE 32U
+#endif
+
+#if ((IOLINK_DLL_RX_QUEUE_SIZE) == 0U) ||                                                         \
+    (((IOLINK_DLL_RX_QUEUE_SIZE) & ((IOLINK_DLL_RX_QUEUE_SIZE) - 1U)) != 0U)
+#error "IOLINK_DLL_RX_QUEUE_SIZE must be a power of two"
+#endif
+
+/* -------------------------------------------------------------------------
+ * Parameter Persistence Configuration
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Delay before dirty parameters are written to NVM, in milliseconds.
+ * Writes arriving within this window are coalesced into one NVM write.
+ * Default: 1000 ms
+ */
+#ifndef IOLINK_PARAMS_FLUSH_DELAY_MS
+#define IOLINK_PARAMS_FLUSH_DELAY_MS 1000U
+#endif
+
+/**
+ * @brief Number of persisted parameter writes that forces a flush before the delay.
+ * Default: 16 writes
+ */
+#ifndef IOLINK_PARAMS_FLUSH_COUNT
+#define IOLINK_PARAMS_FLUSH_COUNT 16U
+#endif
+
+/* -------------------------------------------------------------------------
+ * Data Storage Configuration (data_storage.h)
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Bytes per Data Storage image slot. Two slots (A/B) are used from
+ * storage address 0; with erasable storage this must be a multiple of the
+ * erase sector size. Holds a 12-byte header plus the image.
+ * Default: 128 bytes
+ */
+#ifndef IOLINK_DS_SLOT_SIZE
+#define IOLINK_DS_SLOT_SIZE 128U
+#endif
+
+/* -------------------------------------------------------------------------
+ * Log-Structured NVM Configuration (nvm_log.h)
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Number of keys held in the RAM index of an NVM log.
+ * Keys are 0 .. IOLINK_NVM_LOG_MAX_KEYS - 1; each index entry costs 8 bytes.
+ * Default: 16 keys
+ */
+#ifndef IOLINK_NVM_LOG_MAX_KEYS
+#define IOLINK_NVM_LOG_MAX_KEYS 16U
+#endif
+
+/**
+ * @brief Maximum number of flash sectors an NVM log can span (at least 2 are used).
+ * Default: 8 sectors
+ */
+#ifndef IOLINK_NVM_LOG_MAX_SECTORS
+#define IOLINK_NVM_LOG_MAX_SECTORS 8U
+#endif
+
+/* -------------------------------------------------------------------------
+ * Logging Configuration
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Highest log level compiled in (see log.h).
+ * 0: none, 1: error, 2: warning, 3: info, 4: debug. Calls above the level
+ * generate no code.
+ * Default: 0 (logging compiled out)
+ */
+#ifndef IOLINK_LOG_LEVEL
+#define IOLINK_LOG_LEVEL 0
+#endif
+
+/**
+ * @brief Number of records in the deferred log ring. Must be a power of two.
+ * Only allocated when IOLINK_LOG_LEVEL > 0.
+ * Default: 32 records
+ */
+#ifndef IOLINK_LOG_RING_SIZE
+#define IOLINK_LOG_RING_SIZE 32U
+#endif
+
 #endif  // IOLINK_CONFIG_H
@@ -16,6 +16,37 @@
  * @brief IO-Link CRC calculation (Spec V1.1.5)
  */
 
+/** @brief CRC6 register seed (0x15 in the upper six bits of the 8-bit register) */
+#define IOLINK_CRC6_SEED 0x15U
+
+/** @brief CRC6 byte lookup table (256 bytes, const) */
+extern const uint8_t g_iolink_crc6_table[256];
+
+/**
+ * @brief Feed one byte into a running CRC6 register
+ *
+ * Start from IOLINK_CRC6_SEED and finish with iolink_crc6_final().
+ *
+ * @param crc Current register value
+ * @param byte Next data byte
+ * @return uint8_t Updated register value
+ */
+static inline uint8_t iolink_crc6_update(uint8_t crc, uint8_t byte)
+{
+    return g_iolink_crc6_table[(uint8_t) (crc ^ byte)];
+}
+
+/**
+ * @brief Convert a running CRC6 register into the 6-bit CRC
+ *
+ * @param crc Register value after the last iolink_crc6_update()
+ * @return uint8_t 6-bit CRC
+ */
+static inline uint8_t iolink_crc6_final(uint8_t crc)
+{
+    return (uint8_t) ((crc >> 2U) & 0x3FU);
+}
+
 /**
  * @brief Calculate IO-Link 6-bit CRC
  *
@@ -10,6 +10,8 @@
 #define IOLINK_DATA_STORAGE_H
 
 #include "iolinki/protocol.h"
+#include "iolinki/config.h"
+#include "iolinki/time_utils.h"
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -17,8 +19,38 @@
 /**
  * @file data_storage.h
  * @brief IO-Link Data Storage (DS) for parameter backup and restore
+ *
+ * The DS-relevant parameters are serialized into one image:
+ * [index:16][subindex][len][value] per parameter, followed by the 16-bit
+ * iolink_ds_calc_checksum() of all records (big-endian). Index 0x0003
+ * subindex IOLINK_DS_SUBIDX_IMAGE carries the image: a read streams it with
+ * no staging copy, writes between ParamDownloadStart and ParamDownloadEnd
+ * append chunks to the inactive one of two storage slots (A/B).
+ *
+ * The checksum is kept per parameter record and merged by position, so
+ * iolink_ds_check() only re-serializes parameters whose iolink_params_revision()
+ * changed; the whole image is read once, in iolink_ds_init().
+ *
+ * ParamDownloadEnd hands the staged image to iolink_ds_process(), which checks
+ * its structure and checksum, commits it by programming the slot header last
+ * and applies the values as one parameter block. An image committed but not
+ * yet applied (power loss) is applied again by iolink_ds_init().
  */
 
+/** @brief Data Storage index (0x0003) subindices */
+#define IOLINK_DS_SUBIDX_COMMAND 0x01U    /**< DS_Command (write) */
+#define IOLINK_DS_SUBIDX_STATE 0x02U      /**< State_Property (read) */
+#define IOLINK_DS_SUBIDX_SIZE 0x03U       /**< Data_Storage_Size: image bytes (read) */
+#define IOLINK_DS_SUBIDX_CHECKSUM 0x04U   /**< Parameter_Checksum (read) */
+#define IOLINK_DS_SUBIDX_INDEX_LIST 0x05U /**< Index_List (read) */
+#define IOLINK_DS_SUBIDX_IMAGE 0x06U      /**< Vendor: serialized parameter image (read/write) */
+
+/** @brief Largest value of a DS-relevant parameter */
+#define IOLINK_DS_VALUE_MAX 32U
+
+/** @brief Number of DS-relevant parameters (see iolink_ds_get_indices()) */
+#define IOLINK_DS_PARAM_COUNT 3U
+
 /**
  * @brief DS engine states
  */
@@ -34,7 +66,8 @@ typedef enum
     IOLINK_DS_STATE_UPLOADING = 2U,    /**< Parameter upload in progress */
     IOLINK_DS_STATE_DOWNLOAD_REQ = 3U, /**< Master requested parameter download */
     IOLINK_DS_STATE_DOWNLOADING = 4U,  /**< Parameter download in progress */
-    IOLINK_DS_STATE_LOCKED = 5U        /**< DS operation disabled/locked */
+    IOLINK_DS_STATE_LOCKED = 5U,       /**< DS operation disabled/locked */
+    IOLINK_DS_STATE_COMMIT = 6U        /**< Download ended, image waits for verify/commit */
 } iolink_ds_state_t;
 
 /**
@@ -72,6 +105,33 @@ typedef struct
     int (*erase)(uint32_t addr, size_t len);
 } iolink_ds_storage_api_t;
 
+/**
+ * @brief Transfer statistics
+ *
+ * Durations run from the start command to UploadEnd, or to the applied commit.
+ */
+typedef struct
+{
+    uint32_t upload_us;          /**< Duration of the last upload */
+    uint32_t download_us;        /**< Duration of the last committed download */
+    uint16_t upload_bytes;       /**< Image size of the last upload */
+    uint16_t download_bytes;     /**< Image size of the last committed download */
+    uint32_t commits;            /**< Downloaded images committed and applied */
+    uint32_t rejects;            /**< Downloads rejected (format, checksum or storage error) */
+    uint32_t records_serialized; /**< Parameter records re-read to update the checksum */
+} iolink_ds_stats_t;
+
+/**
+ * @brief Cached checksum contribution of one parameter record
+ */
+typedef struct
+{
+    uint32_t revision; /**< iolink_params_revision() the sums belong to */
+    uint8_t len;       /**< Record length */
+    uint8_t sum1;      /**< Fletcher-16 sum1 of the record alone */
+    uint8_t sum2;      /**< Fletcher-16 sum2 of the record alone */
+} iolink_ds_record_sum_t;
+
 /**
  * @brief Data Storage Engine Context
  *
@@ -79,15 +139,36 @@ typedef struct
  */
 typedef struct
 {
-    iolink_ds_state_t state;                /**< Current DS state machine position */
-    const iolink_ds_storage_api_t* storage; /**< Bound storage implementation API */
-    uint16_t current_checksum;              /**< Last calculated local parameter checksum */
-    uint16_t master_checksum;               /**< Most recent checksum verified by Master */
+    iolink_ds_state_t state;                  /**< Current DS state machine position */
+    const iolink_ds_storage_api_t* storage;   /**< Bound storage implementation API */
+    uint16_t current_checksum;                /**< Last calculated local parameter checksum */
+    uint16_t master_checksum;                 /**< Most recent checksum verified by Master */
+    iolink_usec_t transfer_start_us;          /**< Start of the running transfer */
+    uint32_t seq;                             /**< Sequence number of the active slot */
+    uint8_t active_slot;                      /**< Slot of the committed image (0xFF: none) */
+    uint16_t rx_len;                          /**< Image bytes staged by the running download */
+    uint16_t up_len;                          /**< Image size announced to the running upload */
+    uint16_t up_start;                        /**< Upload cursor: image offset of up_rec */
+    uint8_t up_rec;                           /**< Upload cursor: current record */
+    uint8_t up_rec_len;                       /**< Upload cursor: bytes in up_buf */
+    uint16_t up_sum1;                         /**< Upload cursor: running checksum */
+    uint16_t up_sum2;                         /**< Upload cursor: running checksum */
+    uint8_t up_buf[4U + IOLINK_DS_VALUE_MAX]; /**< Upload cursor: current record */
+    void* isdu_ctx;                           /**< ISDU request waiting for the commit */
+    uint32_t isdu_token;                      /**< Transfer token of that request */
+    iolink_ds_stats_t stats;                  /**< Transfer statistics */
+    /** Per-record checksum contributions, merged by position */
+    iolink_ds_record_sum_t rec_sum[IOLINK_DS_PARAM_COUNT];
 } iolink_ds_ctx_t;
 
 /**
  * @brief Initialize the Data Storage engine
  *
+ * With storage, the newest committed image is located and, if power was lost
+ * before it was applied, applied to the parameters. Call after
+ * iolink_params_init() (e.g. after iolink_init()); downloads need storage with
+ * room for two IOLINK_DS_SLOT_SIZE slots from address 0.
+ *
  * @param ctx DS context to initialize
  * @param storage Optional storage implementation hooks (can be NULL for RAM-only)
  */
@@ -107,7 +188,10 @@ uint16_t iolink_ds_calc_checksum(const uint8_t* data, size_t len);
 /**
  * @brief Process Data Storage engine logic
  *
- * Handles state transitions and background synchronization tasks.
+ * Handles state transitions and the storage work: erasing the staging slot
+ * after ParamDownloadStart, and verifying, committing and applying the image
+ * after ParamDownloadEnd (the pending ISDU request is completed here). Call
+ * from a low-priority task, e.g. next to iolink_params_process().
  *
  * @param ctx DS context to process
  */
@@ -117,6 +201,7 @@ void iolink_ds_process(iolink_ds_ctx_t* ctx);
  * @brief Trigger a DS consistency check with the Master
  *
  * typically triggered by the ISDU engine upon Master comparison requests.
+ * Recomputes the checksum of the current parameters.
  *
  * @param ctx DS context
  * @param master_checksum The 16-bit checksum provided by the IO-Link Master
@@ -151,8 +236,62 @@ int iolink_ds_abort(iolink_ds_ctx_t* ctx);
  * @param ctx DS context
  * @param cmd System Command (0x05-0x08)
  * @param access_locks Current Access Lock state (Index 0x000C)
- * @return int 0: Success, -1: Busy, -2: Access Denied, -3: Unknown
+ * @return int 0: Success, 1: Accepted, completed by iolink_ds_process()
+ *         (ParamDownloadEnd with a staged image), -1: Busy, -2: Access Denied,
+ *         -3: Unknown
  */
 int iolink_ds_handle_command(iolink_ds_ctx_t* ctx, uint8_t cmd, uint16_t access_locks);
 
+/**
+ * @brief DS-relevant parameter indices (all at subindex 0), in image order
+ *
+ * @param count [out] Number of indices
+ * @return const uint16_t* Index list
+ */
+const uint16_t* iolink_ds_get_indices(size_t* count);
+
+/**
+ * @brief Start streaming the image of the current parameters
+ *
+ * Resets the upload cursor and refreshes current_checksum. The bytes are then
+ * produced by iolink_ds_image_byte().
+ *
+ * @param ctx DS context
+ * @return size_t Image size in bytes
+ */
+size_t iolink_ds_image_open(iolink_ds_ctx_t* ctx);
+
+/**
+ * @brief Image byte generator for iolink_isdu_respond_pull()
+ *
+ * Offsets must increase; each parameter is fetched once when its record
+ * starts and the trailer is the checksum of the bytes actually produced.
+ *
+ * @param arg DS context
+ * @param offset Image offset
+ * @return uint8_t Image byte
+ */
+uint8_t iolink_ds_image_byte(void* arg, size_t offset);
+
+/**
+ * @brief Append a downloaded image chunk to the staging slot
+ *
+ * Chunks are appended in order; restart with ParamDownloadStart after an error.
+ *
+ * @param ctx DS context
+ * @param data Chunk
+ * @param len Chunk length
+ * @return int 0 on success, -1 busy (staging slot not erased yet), -2 image
+ *         too large, -3 no download running or storage error
+ */
+int iolink_ds_write_image(iolink_ds_ctx_t* ctx, const uint8_t* data, size_t len);
+
+/**
+ * @brief Get transfer statistics
+ *
+ * @param ctx DS context
+ * @param stats [out] Statistics
+ */
+void iolink_ds_get_stats(const iolink_ds_ctx_t* ctx, iolink_ds_stats_t* stats);
+
 #endif  // IOLINK_DATA_STORAGE_H
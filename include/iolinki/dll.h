@@ -11,8 +11,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "iolinki/phy.h"
 #include "iolinki/config.h"
+#include "iolinki/pd_buffer.h"
+#include "iolinki/latency.h"
+#include "iolinki/trace.h"
+#include "iolinki/time_utils.h"
 
 /**
  * @file dll.h
@@ -36,85 +41,126 @@ typedef enum
 #include "iolinki/isdu.h"
 #include "iolinki/data_storage.h"
 
+/**
+ * @brief Deadlines kept by the DLL (at most one pending per kind)
+ */
+typedef enum
+{
+    IOLINK_DLL_TIMER_T_BYTE = 0U,   /**< Inter-byte gap limit of a partial frame */
+    IOLINK_DLL_TIMER_WAKEUP = 1U,   /**< End of the wake-up hold (t_DWU) */
+    IOLINK_DLL_TIMER_T_PD = 2U,     /**< End of the power-on delay (t_pd) */
+    IOLINK_DLL_TIMER_ACTIVITY = 3U, /**< Master silence timeout (back to STARTUP) */
+    IOLINK_DLL_TIMER_COUNT = 4U
+} iolink_dll_timer_t;
+
+/** @brief Largest device reply: Status + PD_In + OD + CK */
+#define IOLINK_DLL_TX_BUF_SIZE (IOLINK_PD_IN_MAX_SIZE + IOLINK_OD_MAX_SIZE + 2U)
+
 /**
  * @brief Data Link Layer Context
  *
  * Internal state and data storage for the DLL engine.
+ *
+ * Layout: the hot cycle block comes first and holds everything a process pass and
+ * the byte/frame path read or write; the per-byte fields share its first cache
+ * line. The PD buffers and latency histograms follow (one slot or bucket touched
+ * per cycle), then the sub-modules: every pass or frame reads the event queue head,
+ * the ISDU state and response cursor and the DS state, but not the ISDU buffers or
+ * DS record sums behind them. Configuration and counters come last and are only
+ * touched on errors or statistics reads. dll.c checks the layout with static
+ * asserts; keep new per-cycle fields inside the hot block.
  */
 typedef struct
 {
+    /* Hot: per received byte (first cache line) */
     iolink_dll_state_t state;    /**< Current DLL state */
-    const iolink_phy_api_t* phy; /**< Bound PHY API implementation */
-    uint32_t last_activity_ms;   /**< Timestamp of last valid frame */
-    bool wakeup_seen;            /**< Wake-up detected (if PHY supports it) */
-
-    /* Configuration */
-    uint8_t m_seq_type;         /**< Supported M-sequence type */
-    uint8_t pd_in_len;          /**< Input Process Data length */
-    uint8_t pd_out_len;         /**< Output Process Data length */
-    uint8_t od_len;             /**< On-request Data length (1 or 2 bytes) */
-    bool pd_valid;              /**< Current PD_In validity status */
-    bool pd_in_toggle;          /**< Toggle bit for PD_In consistency */
-    uint32_t min_cycle_time_us; /**< Minimum cycle time in microseconds */
-    bool enforce_timing;        /**< Enable timing checks (t_ren / t_cycle) */
-    uint32_t t_ren_limit_us;    /**< Current t_ren limit in microseconds */
-    bool t_ren_override;        /**< Use overridden t_ren limit if true */
-    uint32_t t_pd_delay_us;     /**< Power-on delay (t_pd) in microseconds */
-
-    /* Variable PD Support (for Type 1_V and 2_V) */
-    uint8_t pd_in_len_current;  /**< Current runtime PD_In length */
-    uint8_t pd_out_len_current; /**< Current runtime PD_Out length */
-    uint8_t pd_in_len_max;      /**< Maximum allowed PD_In length */
-    uint8_t pd_out_len_max;     /**< Maximum allowed PD_Out length */
-
-    /* SIO Mode */
-    iolink_phy_mode_t phy_mode; /**< Current operating mode (SDCI vs SIO) */
-
-    /* Baudrate Support */
-    iolink_baudrate_t baudrate; /**< Negotiated baudrate (COM1-COM3) */
-
-    /* Unified Frame Assembly */
-    uint8_t frame_buf[48];        /**< Raw frame assembly buffer */
-    uint8_t frame_index;          /**< Current byte index in assembly */
-    uint8_t req_len;              /**< Expected length of current frame type */
-    uint64_t last_frame_us;       /**< Microsecond timestamp of last frame start */
-    uint64_t last_byte_us;        /**< Microsecond timestamp of last received byte */
-    uint64_t last_cycle_start_us; /**< Microsecond timestamp of last cycle start */
-    uint32_t t_byte_limit_us;     /**< Inter-byte timeout limit in microseconds */
-    uint64_t wakeup_deadline_us;  /**< Earliest time to accept frames after wake-up */
-    uint64_t t_pd_deadline_us;    /**< Earliest time to accept frames after power-on */
-
-    /* Process Data Buffers */
-    uint8_t pd_in[IOLINK_PD_IN_MAX_SIZE];   /**< Input PD buffer (Device -> Master) */
-    uint8_t pd_out[IOLINK_PD_OUT_MAX_SIZE]; /**< Output PD buffer (Master -> Device) */
-
-    /* Error Counters & Statistics */
-    uint32_t crc_errors;            /**< Cumulative CRC error count */
-    uint32_t timeout_errors;        /**< Cumulative timeout count */
-    uint32_t framing_errors;        /**< Cumulative framing error count */
-    uint32_t timing_errors;         /**< Cumulative timing violations */
-    uint32_t t_ren_violations;      /**< t_ren violations */
-    uint32_t t_cycle_violations;    /**< t_cycle violations */
-    uint32_t t_byte_violations;     /**< Inter-byte timing violations */
-    uint32_t t_pd_violations;       /**< t_pd violations */
-    uint8_t retry_count;            /**< Retry counter for current exchange */
-    uint32_t total_retries;         /**< Cumulative retry count */
-    uint8_t max_retries;            /**< Configured max retries (default 3) */
-    uint32_t voltage_faults;        /**< Cumulative voltage fault count */
-    uint32_t short_circuits;        /**< Cumulative short circuit count */
-    uint8_t fallback_count;         /**< Consecutive fallback count for SIO transition */
-    uint8_t sio_fallback_threshold; /**< Fallback threshold to enter SIO mode (default 3) */
-
-    /* Timing Statistics */
-    uint64_t last_response_us; /**< Microsecond timestamp of last response */
-    uint32_t response_time_us; /**< Measured stack response time (t2) */
-
-    /* Sub-modules */
+    uint8_t frame_index;         /**< Current byte index in assembly */
+    uint8_t req_len;             /**< Expected length of current frame type */
+    uint8_t rx_crc;              /**< Running CRC6 register over received frame bytes */
+    bool enforce_timing;         /**< Enable timing checks (t_ren / t_cycle) */
+    uint32_t t_byte_limit_us;    /**< Inter-byte timeout limit in microseconds */
+    uint8_t timers_armed;        /**< Bit (1 << iolink_dll_timer_t) per armed deadline */
+    iolink_usec_t last_byte_us;  /**< Timestamp of last received byte (valid if frame_index > 0) */
+    iolink_usec_t pass_us;       /**< Time snapshot of the current process pass */
+    iolink_usec_t timer_due_us[IOLINK_DLL_TIMER_COUNT]; /**< Due time per armed deadline */
+
+    /* Hot: per frame and per pass */
+    const iolink_phy_api_t* phy;            /**< Bound PHY API implementation */
+    iolink_usec_t last_frame_us;            /**< Microsecond timestamp of last frame start */
+    iolink_usec_t last_cycle_start_us;      /**< Timestamp of last cycle start, see below */
+    iolink_phy_mode_t phy_mode;             /**< Current operating mode (SDCI vs SIO) */
+    iolink_baudrate_t baudrate;             /**< Negotiated baudrate (COM1-COM3) */
+    uint32_t min_cycle_time_us;             /**< Minimum cycle time in microseconds */
+    uint32_t t_ren_limit_us;                /**< Current t_ren limit in microseconds */
+    uint32_t response_time_us;              /**< Measured stack response time (t2) */
+    iolink_usec_t last_response_us;         /**< Microsecond timestamp of last response */
+    iolink_trace_ring_t* trace;             /**< Frame trace (NULL = off) */
+    uint8_t m_seq_type;                     /**< Supported M-sequence type */
+    uint8_t od_len;                         /**< On-request Data length (1 or 2 bytes) */
+    uint8_t pd_in_len_current;              /**< Current runtime PD_In length (Type 1_V/2_V) */
+    uint8_t pd_out_len_current;             /**< Current runtime PD_Out length (Type 1_V/2_V) */
+    bool pd_valid;                          /**< Validity of the PD_In sample being sent */
+    bool pd_in_toggle;                      /**< Toggle bit, flips with every new PD_In sample */
+    bool cycle_start_valid;                 /**< last_cycle_start_us holds a cycle start */
+    uint8_t fallback_count;                 /**< Consecutive fallback count for SIO transition */
+    uint8_t tx_crc;                         /**< CRC6 register over Status and PD_In */
+    uint8_t tx_pd_len;                      /**< PD_In length the armed frame was built for */
+    bool tx_armed;                          /**< Status/PD_In part of tx_buf is current */
+    uint8_t frame_buf[48];                  /**< Raw frame assembly buffer */
+    uint8_t tx_buf[IOLINK_DLL_TX_BUF_SIZE]; /**< Reply frame (Status | PD_In | OD | CK) */
+#if IOLINK_DLL_RX_ISR
+    volatile uint32_t rx_q_head; /**< ISR queue write position (free-running) */
+    volatile uint32_t rx_q_tail; /**< ISR queue read position (free-running) */
+    bool rx_in_isr;              /**< iolink_dll_rx_isr() is assembling a frame */
+    bool fallback_pending;       /**< SIO fallback due from the ISR, applied by the thread */
+#endif
+
+    /* Warm: one slot / bucket per cycle */
+    iolink_pd_buffer_t pd_in;  /**< Input PD (Device -> Master), application produces */
+    iolink_pd_buffer_t pd_out; /**< Output PD (Master -> Device), DLL produces */
+    iolink_latency_hist_t latency[IOLINK_LATENCY_KIND_COUNT]; /**< Latency distributions */
+
+    /* Warm: sub-modules, state and cursors read every pass or frame, bulk data behind */
     iolink_events_ctx_t events; /**< Diagnostic Events engine */
     iolink_isdu_ctx_t isdu;     /**< ISDU Service engine */
     iolink_ds_ctx_t ds;         /**< Data Storage engine */
+
+    /* Cold: configuration */
+    uint8_t pd_in_len;                /**< Input Process Data length */
+    uint8_t pd_out_len;               /**< Output Process Data length */
+    uint8_t pd_in_len_max;            /**< Maximum allowed PD_In length */
+    uint8_t pd_out_len_max;           /**< Maximum allowed PD_Out length */
+    bool t_ren_override;              /**< Use overridden t_ren limit if true */
+    bool wakeup_seen;                 /**< Wake-up detected (if PHY supports it) */
+    uint8_t retry_count;              /**< Retry counter for current exchange */
+    uint8_t max_retries;              /**< Configured max retries (default 3) */
+    uint8_t sio_fallback_threshold;   /**< Fallback threshold to enter SIO mode (default 3) */
+    uint32_t t_pd_delay_us;           /**< Power-on delay (t_pd) in microseconds */
+
+    /* Cold: error counters */
+    uint32_t crc_errors;         /**< Cumulative CRC error count */
+    uint32_t timeout_errors;     /**< Cumulative timeout count */
+    uint32_t framing_errors;     /**< Cumulative framing error count */
+    uint32_t timing_errors;      /**< Cumulative timing violations */
+    uint32_t t_ren_violations;   /**< t_ren violations */
+    uint32_t t_cycle_violations; /**< t_cycle violations */
+    uint32_t t_byte_violations;  /**< Inter-byte timing violations */
+    uint32_t t_pd_violations;    /**< t_pd violations */
+    uint32_t total_retries;      /**< Cumulative retry count */
+    uint32_t voltage_faults;     /**< Cumulative voltage fault count */
+    uint32_t short_circuits;     /**< Cumulative short circuit count */
+#if IOLINK_DLL_RX_ISR
+    volatile uint32_t rx_q_drops; /**< Bytes lost because the ISR queue was full */
+
+    /* Cold: ISR queue storage (traffic outside OPERATE) */
+    uint8_t rx_q_byte[IOLINK_DLL_RX_QUEUE_SIZE];        /**< Queued bytes */
+    iolink_usec_t rx_q_ts_us[IOLINK_DLL_RX_QUEUE_SIZE]; /**< Their receive timestamps */
+#endif
 } iolink_dll_ctx_t;
 
+/** @brief Size of the hot cycle block at the start of iolink_dll_ctx_t */
+#define IOLINK_DLL_HOT_BYTES (offsetof(iolink_dll_ctx_t, pd_in))
+
 /**
  * @brief DLL statistics snapshot
  */
@@ -131,6 +177,9 @@ typedef struct
     uint32_t total_retries;      /**< Cumulative retry count */
     uint32_t voltage_faults;     /**< Cumulative voltage fault count */
     uint32_t short_circuits;     /**< Cumulative short circuit count */
+    uint32_t event_drops;        /**< Events lost because the event queue was full */
+    uint32_t events_coalesced;   /**< Events merged into an already queued entry */
+    uint32_t rx_queue_drops;     /**< Bytes lost because the ISR queue was full */
 } iolink_dll_stats_t;
 
 /**
@@ -152,13 +201,27 @@ void iolink_dll_init(iolink_dll_ctx_t* ctx, const iolink_phy_api_t* phy);
  */
 void iolink_dll_process(iolink_dll_ctx_t* ctx);
 
+/**
+ * @brief Check a link configuration against the limits of this build
+ *
+ * Fails for lengths above the PD maximums and, when the IOLINK_FIXED_* options
+ * pin them, for any other M-sequence type or PD length.
+ *
+ * @param m_seq_type M-sequence type (iolink_m_seq_type_t)
+ * @param pd_in_len PD_In length
+ * @param pd_out_len PD_Out length
+ * @return true if the DLL of this build can run the configuration
+ */
+bool iolink_dll_link_supported(uint8_t m_seq_type, uint8_t pd_in_len, uint8_t pd_out_len);
+
 /**
  * @brief Set current PD lengths for variable types (1_V, 2_V)
  *
  * @param ctx DLL context
  * @param pd_in_len New PD_In length
  * @param pd_out_len New PD_Out length
- * @return int 0 on success, negative on range error
+ * @return int 0 on success, negative on range error or a length pinned by
+ *         IOLINK_FIXED_PD_IN_LEN / IOLINK_FIXED_PD_OUT_LEN
  */
 int iolink_dll_set_pd_length(iolink_dll_ctx_t* ctx, uint8_t pd_in_len, uint8_t pd_out_len);
 
@@ -220,6 +283,76 @@ iolink_baudrate_t iolink_dll_get_baudrate(const iolink_dll_ctx_t* ctx);
  */
 void iolink_dll_get_stats(const iolink_dll_ctx_t* ctx, iolink_dll_stats_t* out_stats);
 
+/**
+ * @brief Get a latency histogram snapshot
+ *
+ * @param ctx DLL context
+ * @param kind Which quantity (response time, cycle interval, inter-byte gap)
+ * @param out_hist Output histogram
+ * @return int 0 on success, negative on invalid arguments
+ */
+int iolink_dll_get_latency_histogram(const iolink_dll_ctx_t* ctx, iolink_latency_kind_t kind,
+                                     iolink_latency_hist_t* out_hist);
+
+/**
+ * @brief Clear all latency histograms
+ *
+ * @param ctx DLL context
+ */
+void iolink_dll_reset_latency_histograms(iolink_dll_ctx_t* ctx);
+
+/**
+ * @brief Attach (or detach with NULL) a frame trace ring
+ *
+ * When attached, every received master frame and every sent reply is appended to
+ * the ring from the cycle path. The caller owns the ring and drains it.
+ *
+ * @param ctx DLL context
+ * @param ring Initialized trace ring, or NULL to disable tracing
+ */
+void iolink_dll_trace_attach(iolink_dll_ctx_t* ctx, iolink_trace_ring_t* ring);
+
+/**
+ * @brief Earliest time at which iolink_dll_process() has timed work to do
+ *
+ * Returns the earliest armed iolink_dll_timer_t deadline (t_byte gap of a partial
+ * frame, wake-up hold, end of t_pd, master activity timeout), or the current pass
+ * time while an ISDU service waits for dispatch. In SIO mode with a PHY that has
+ * detect_wakeup(), wake-up requests are only seen by polling, so the deadline is
+ * at most IOLINK_WAKEUP_POLL_US after the last pass. The minimum cycle time is
+ * checked when a frame arrives and needs no wake-up. Received bytes are not
+ * covered: a sleeping caller also wakes on the PHY (UART interrupt or readable
+ * descriptor).
+ *
+ * @param ctx DLL context
+ * @param deadline_us [out] Deadline on the iolink_time_get_us() timebase (may be
+ *                    in the past: call iolink_dll_process() now)
+ * @return true if a deadline is pending, false if only received bytes matter
+ */
+bool iolink_dll_next_deadline(const iolink_dll_ctx_t* ctx, iolink_usec_t* deadline_us);
+
+#if IOLINK_DLL_RX_ISR
+/**
+ * @brief Feed one received byte from the UART RX interrupt (IOLINK_DLL_RX_ISR)
+ *
+ * In OPERATE, while no bytes wait in the queue, the frame is assembled here and a
+ * complete PD/OD frame is answered from this call: OD bytes and CRC are patched
+ * into the pre-built Status/PD_In reply and it goes to phy->send(). Any other byte
+ * is put on a lock-free single-producer queue for iolink_dll_process(), which also
+ * keeps ISDU service execution, event handling and diagnostics. An SIO fallback
+ * reached here is only flagged; the thread switches the PHY, and until then bytes
+ * are queued. In this build the PHY recv hooks are never polled; this is the only
+ * receive path.
+ *
+ * @param ctx DLL context
+ * @param byte Received byte
+ * @param ts_us Receive timestamp on the iolink_time_get_us() timebase
+ * @return true if iolink_dll_process() has work (queued bytes, a pending fallback
+ *         or an ISDU request to execute), false if the byte was handled completely
+ */
+bool iolink_dll_rx_isr(iolink_dll_ctx_t* ctx, uint8_t byte, iolink_usec_t ts_us);
+#endif
+
 /**
  * @brief Enable/disable timing enforcement (t_ren / t_cycle)
  *
@@ -228,6 +361,16 @@ void iolink_dll_get_stats(const iolink_dll_ctx_t* ctx, iolink_dll_stats_t* out_s
  */
 void iolink_dll_set_timing_enforcement(iolink_dll_ctx_t* ctx, bool enable);
 
+/**
+ * @brief Set the power-on delay (t_pd) and start it now
+ *
+ * Frames received before the delay ends are dropped and counted as t_pd violations.
+ *
+ * @param ctx DLL context
+ * @param delay_us Delay in microseconds (0: accept frames at once)
+ */
+void iolink_dll_set_t_pd_delay(iolink_dll_ctx_t* ctx, uint32_t delay_us);
+
 /**
  * @brief Override t_ren limit (applies to all baudrates)
  *
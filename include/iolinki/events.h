@@ -52,6 +52,14 @@ typedef enum
 #define IOLINK_EVENT_HW_SENSOR_FAULT 0x6320U   /**< Sensor element fault */
 #define IOLINK_EVENT_HW_ACTUATOR_FAULT 0x6330U /**< Actuator element fault */
 
+#if (IOLINK_EVENT_QUEUE_SIZE == 0U) ||                                                             \
+    ((IOLINK_EVENT_QUEUE_SIZE & (IOLINK_EVENT_QUEUE_SIZE - 1U)) != 0U)
+#error "IOLINK_EVENT_QUEUE_SIZE must be a power of two"
+#endif
+
+/** @brief Largest occurrence count one queue entry can hold */
+#define IOLINK_EVENT_MAX_OCCURRENCES 0x3FFFU
+
 /**
  * @brief Event Descriptor
  *
@@ -61,19 +69,36 @@ typedef struct
 {
     uint16_t code;            /**< 16-bit IO-Link EventCode (per spec or device-specific) */
     iolink_event_type_t type; /**< Severity level */
+    uint16_t occurrences;     /**< Times this code/type was raised while queued (>= 1) */
 } iolink_event_t;
 
+/**
+ * @brief Event queue slot
+ *
+ * entry packs code (bits 31-16), type (bits 15-14) and occurrence count (bits 13-0)
+ * into one word so producers can coalesce with a single compare-and-swap.
+ * A zero entry is free.
+ */
+typedef struct
+{
+    volatile uint32_t seq;   /**< Slot sequence (bounded MPMC queue protocol) */
+    volatile uint32_t entry; /**< Packed event */
+} iolink_event_cell_t;
+
 /**
  * @brief Events Engine Context
  *
- * Manages the internal FIFO queue of pending events to be read by the Master.
+ * Bounded lock-free FIFO: any number of producers (threads, ISRs) may call
+ * iolink_event_trigger(); the stack is the single consumer. When the queue is
+ * full the new event is dropped and counted, so queued faults are never evicted.
  */
 typedef struct
 {
-    iolink_event_t queue[IOLINK_EVENT_QUEUE_SIZE]; /**< Event FIFO buffer */
-    uint8_t head;                                  /**< Queue head index */
-    uint8_t tail;                                  /**< Queue tail index */
-    uint8_t count;                                 /**< Number of events currently in queue */
+    iolink_event_cell_t cells[IOLINK_EVENT_QUEUE_SIZE]; /**< Event FIFO slots */
+    volatile uint32_t enqueue_pos;                      /**< Producer position (free-running) */
+    uint32_t dequeue_pos;                               /**< Consumer position (free-running) */
+    volatile uint32_t dropped;                          /**< Events lost to a full queue */
+    volatile uint32_t coalesced;                        /**< Events merged into a queued entry */
 } iolink_events_ctx_t;
 
 /**
@@ -88,8 +113,10 @@ void iolink_events_init(iolink_events_ctx_t* ctx);
 /**
  * @brief Trigger a new diagnostic event
  *
- * Adds an event to the internal queue. If the queue is full, the newest event
- * is typically dropped or the oldest overwritten (depending on implementation).
+ * Lock-free and safe to call from interrupts and other threads. If an entry with
+ * the same code and type is still queued, its occurrence count is incremented
+ * instead of adding a new entry. If the queue is full, the new event is dropped
+ * and counted.
  *
  * @param ctx Event context
  * @param code 16-bit IO-Link EventCode
@@ -97,6 +124,22 @@ void iolink_events_init(iolink_events_ctx_t* ctx);
  */
 void iolink_event_trigger(iolink_events_ctx_t* ctx, uint16_t code, iolink_event_type_t type);
 
+/**
+ * @brief Number of events lost because the queue was full
+ *
+ * @param ctx Event context
+ * @return uint32_t Drop count since init
+ */
+uint32_t iolink_events_dropped(const iolink_events_ctx_t* ctx);
+
+/**
+ * @brief Number of events merged into an already queued entry
+ *
+ * @param ctx Event context
+ * @return uint32_t Coalesce count since init
+ */
+uint32_t iolink_events_coalesced(const iolink_events_ctx_t* ctx);
+
 /**
  * @brief Check if any events are pending for Master retrieval
  *
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_FLASH_SIM_H
+#define IOLINK_FLASH_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iolinki/data_storage.h"
+
+/**
+ * @file flash_sim.h
+ * @brief File-backed NOR flash simulator with power-loss injection (Linux host only)
+ *
+ * Behaves like NOR flash: erase sets a sector to 0xFF, programming can only clear
+ * bits (new = old & data). The image lives in a file, so closing and reopening it
+ * models a reboot.
+ *
+ * Power loss: after iolink_flash_sim_fail_after(n), the operation that would
+ * touch byte n + 1 stops there (a prefix of a program, or part of an erase) and
+ * every later operation fails until the flash is reopened.
+ */
+
+/**
+ * @brief Open (or create blank) a simulated flash
+ *
+ * @param path Backing file
+ * @param sector_size Erase sector size in bytes
+ * @param sector_count Number of sectors
+ * @return int 0 on success, negative on error
+ */
+int iolink_flash_sim_open(const char* path, uint32_t sector_size, uint8_t sector_count);
+
+/**
+ * @brief Close the simulated flash (contents stay in the file)
+ */
+void iolink_flash_sim_close(void);
+
+/**
+ * @brief Storage hooks backed by the simulated flash
+ *
+ * @return const iolink_ds_storage_api_t* read/write/erase hooks
+ */
+const iolink_ds_storage_api_t* iolink_flash_sim_api(void);
+
+/**
+ * @brief Inject a power loss after a number of further bytes are programmed/erased
+ *
+ * @param bytes Bytes that still complete (an erase counts its whole sector);
+ *              negative disables injection
+ */
+void iolink_flash_sim_fail_after(int32_t bytes);
+
+/**
+ * @brief Check whether the injected power loss has happened
+ *
+ * @return true if operations are failing since the power loss
+ */
+bool iolink_flash_sim_power_lost(void);
+
+/**
+ * @brief Erase count of one sector since iolink_flash_sim_open()
+ *
+ * @param sector Sector number
+ * @return uint32_t Erase count (0 for an invalid sector)
+ */
+uint32_t iolink_flash_sim_erase_count(uint8_t sector);
+
+#endif  // IOLINK_FLASH_SIM_H
@@ -51,10 +51,84 @@ typedef struct
     uint32_t t_pd_us;               /**< Power-on delay (t_pd) in microseconds */
 } iolink_config_t;
 
+/**
+ * @brief IO-Link stack instance
+ *
+ * Holds the complete state of one device endpoint (DLL, ISDU, Events, DS).
+ * Storage is provided by the caller, so any number of instances can live in
+ * one address space (e.g. a gateway or simulation farm hosting many ports).
+ * Members are internal; use the iolink_instance_* API to access them.
+ */
+typedef struct
+{
+    iolink_dll_ctx_t dll;   /**< Data Link Layer context (owns all sub-modules) */
+    iolink_config_t config; /**< Stack configuration (copied at init) */
+} iolink_instance_t;
+
+/**
+ * @brief Initialize a caller-allocated stack instance
+ *
+ * Configures the state machine, ISDU engine, and PHY interface of one instance.
+ * Device identification and parameters (device_info, params) remain process-wide.
+ *
+ * @param inst Instance storage to initialize
+ * @param phy Pointer to the PHY implementation API
+ * @param config Pointer to stack configuration (copied), NULL for Type 0 defaults
+ * @return int 0 on success, negative error code (e.g. -1 for NULL instance/PHY, or
+ *         a type/PD length this build does not support, see iolink_dll_link_supported())
+ */
+int iolink_instance_init(iolink_instance_t* inst, const iolink_phy_api_t* phy,
+                         const iolink_config_t* config);
+
+/**
+ * @brief Process the logic of one stack instance
+ *
+ * @param inst Instance to process
+ */
+void iolink_instance_process(iolink_instance_t* inst);
+
+/**
+ * @brief Update Process Data Input (Device -> Master) of an instance
+ *
+ * @param inst Target instance
+ * @param data Pointer to input data
+ * @param len Length in bytes
+ * @param valid Data validity flag
+ * @return int 0 on success, negative on error
+ */
+int iolink_instance_pd_input_update(iolink_instance_t* inst, const uint8_t* data, size_t len,
+                                    bool valid);
+
+/**
+ * @brief Read Process Data Output (Master -> Device) of an instance
+ *
+ * @param inst Source instance
+ * @param data Pointer to buffer to store output data
+ * @param len Max length to read
+ * @return int Number of bytes read, negative on error
+ */
+int iolink_instance_pd_output_read(iolink_instance_t* inst, uint8_t* data, size_t len);
+
+/**
+ * @brief Get DLL statistics snapshot of an instance
+ *
+ * @param inst Source instance
+ * @param out_stats Output stats structure
+ */
+void iolink_instance_get_stats(const iolink_instance_t* inst, iolink_dll_stats_t* out_stats);
+
+/**
+ * @brief Get the default instance used by the global (handle-less) API
+ *
+ * @return iolink_instance_t* Pointer to the default instance
+ */
+iolink_instance_t* iolink_get_default_instance(void);
+
 /**
  * @brief Initialize the IO-Link stack
  *
  * Configures the internal state machine, ISDU engine, and PHY interface.
+ * Equivalent to iolink_instance_init() on the default instance.
  *
  * @param phy Pointer to the PHY implementation API
  * @param config Pointer to stack configuration (copied internally)
@@ -73,6 +147,49 @@ void iolink_process(void);
 #include "iolinki/events.h"
 #include "iolinki/data_storage.h"
 
+/**
+ * @brief Get the events context of an instance
+ *
+ * @param inst Source instance
+ * @return iolink_events_ctx_t* Pointer to the instance events context
+ */
+iolink_events_ctx_t* iolink_instance_get_events_ctx(iolink_instance_t* inst);
+
+/**
+ * @brief Get the data storage context of an instance
+ *
+ * @param inst Source instance
+ * @return iolink_ds_ctx_t* Pointer to the instance DS context
+ */
+iolink_ds_ctx_t* iolink_instance_get_ds_ctx(iolink_instance_t* inst);
+
+/**
+ * @brief Get the ISDU context of an instance
+ *
+ * @param inst Source instance
+ * @return iolink_isdu_ctx_t* Pointer to the instance ISDU context
+ */
+iolink_isdu_ctx_t* iolink_instance_get_isdu_ctx(iolink_instance_t* inst);
+
+/**
+ * @brief Get current DLL state of an instance
+ *
+ * @param inst Source instance
+ * @return iolink_dll_state_t Current state
+ */
+iolink_dll_state_t iolink_instance_get_state(const iolink_instance_t* inst);
+
+/**
+ * @brief Get the earliest pending protocol deadline of an instance
+ *
+ * See iolink_next_deadline_us().
+ *
+ * @param inst Source instance
+ * @param deadline_us [out] Deadline on the iolink_time_get_us() timebase
+ * @return true if a deadline is pending
+ */
+bool iolink_instance_next_deadline_us(const iolink_instance_t* inst, iolink_usec_t* deadline_us);
+
 /**
  * @brief Get the events context of the stack
  *
@@ -91,6 +208,15 @@ iolink_events_ctx_t* iolink_get_events_ctx(void);
  */
 iolink_ds_ctx_t* iolink_get_ds_ctx(void);
 
+/**
+ * @brief Get the ISDU context of the stack
+ *
+ * Used to register application index tables (iolink_isdu_register_table()).
+ *
+ * @return iolink_isdu_ctx_t* Pointer to the internal ISDU context
+ */
+iolink_isdu_ctx_t* iolink_get_isdu_ctx(void);
+
 /**
  * @brief Get current DLL state
  *
@@ -98,6 +224,22 @@ iolink_ds_ctx_t* iolink_get_ds_ctx(void);
  */
 iolink_dll_state_t iolink_get_state(void);
 
+/**
+ * @brief Get the earliest pending protocol deadline
+ *
+ * The next time iolink_process() must run even if no byte arrives: t_byte gap,
+ * wake-up hold, t_pd end, master activity timeout, or the next wake-up poll in SIO
+ * mode (IOLINK_WAKEUP_POLL_US; see iolink_dll_next_deadline()).
+ * A tickless port sleeps until this deadline or the next UART interrupt, whichever
+ * comes first, instead of polling at a fixed rate. Query it after each
+ * iolink_process() call; received bytes can move it.
+ *
+ * @param deadline_us [out] Deadline on the iolink_time_get_us() timebase; may already
+ *                    have passed, then call iolink_process() at once
+ * @return true if a deadline is pending, false to sleep until the next byte
+ */
+bool iolink_next_deadline_us(iolink_usec_t* deadline_us);
+
 /**
  * @brief Get current PHY mode
  *
@@ -56,23 +56,112 @@ typedef enum
     ISDU_STATE_SEGMENT_COLLECT = 7U,   /**< Waiting for next segment in multi-frame write */
     ISDU_STATE_SERVICE_EXECUTE = 8U,   /**< Dispatching to application layer */
     ISDU_STATE_RESPONSE_READY = 9U,    /**< Response buffer populated, awaiting retrieval */
-    ISDU_STATE_BUSY = 10U              /**< Internal command execution in progress */
+    ISDU_STATE_BUSY = 10U              /**< Deferred service execution in progress */
 } isdu_state_t;
 
+/** @brief Storage one ISDU transfer needs (request and response) */
+#if IOLINK_ISDU_SINGLE_BUFFER
+#define IOLINK_ISDU_STORAGE_SIZE (IOLINK_ISDU_BUFFER_SIZE)
+#else
+#define IOLINK_ISDU_STORAGE_SIZE (2U * IOLINK_ISDU_BUFFER_SIZE)
+#endif
+
+typedef struct iolink_isdu_ctx iolink_isdu_ctx_t;
+
+/* Index access rights (iolink_isdu_entry_t::access) */
+#define IOLINK_ISDU_ACCESS_READ 0x01U  /**< Index can be read */
+#define IOLINK_ISDU_ACCESS_WRITE 0x02U /**< Index can be written */
+#define IOLINK_ISDU_ACCESS_RW (IOLINK_ISDU_ACCESS_READ | IOLINK_ISDU_ACCESS_WRITE)
+
+/**
+ * @brief Handler result: request accepted, result follows via iolink_isdu_complete()
+ *
+ * The engine enters ISDU_STATE_BUSY and answers the master with empty OD until the
+ * application completes the request. Request data (ctx->buffer) stays valid only until
+ * the handler returns; copy what the deferred work needs, including the token from
+ * iolink_isdu_transfer_token().
+ */
+#define IOLINK_ISDU_PENDING (-0x100)
+
+/**
+ * @brief Index read handler
+ *
+ * @param ctx ISDU context serving the request
+ * @param index Requested Index
+ * @param subindex Requested Subindex (within the entry's range)
+ * @param buf [out] Response payload
+ * @param max_len Capacity of buf
+ * @return int Payload length, negative ISDU ErrorCode (e.g. -IOLINK_ISDU_ERROR_BUSY),
+ *             or IOLINK_ISDU_PENDING to finish later
+ */
+typedef int (*iolink_isdu_read_fn)(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                   uint8_t* buf, size_t max_len);
+
+/**
+ * @brief Index write handler
+ *
+ * @param ctx ISDU context serving the request
+ * @param index Requested Index
+ * @param subindex Requested Subindex (within the entry's range)
+ * @param data Request payload
+ * @param len Payload length
+ * @return int 0 on success, negative ISDU ErrorCode, or IOLINK_ISDU_PENDING
+ */
+typedef int (*iolink_isdu_write_fn)(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                    const uint8_t* data, size_t len);
+
+/**
+ * @brief Response byte generator for iolink_isdu_respond_pull()
+ *
+ * Called once per response byte, with offsets increasing from 0. Runs in the
+ * DLL context while the response is transmitted.
+ *
+ * @param arg Argument given to iolink_isdu_respond_pull()
+ * @param offset Offset of the requested byte within the response
+ * @return uint8_t Response byte at offset
+ */
+typedef uint8_t (*iolink_isdu_pull_fn)(void* arg, size_t offset);
+
+/**
+ * @brief One entry of an ISDU index table
+ *
+ * Tables are const (ROM) arrays sorted by ascending index, one entry per index.
+ * Without a callback the entry is served from data/size: reads return size bytes,
+ * writes must supply exactly size bytes. data may point to const storage if the
+ * entry is read-only.
+ */
+typedef struct
+{
+    uint16_t index;             /**< Index */
+    uint8_t subindex_min;       /**< Lowest accepted Subindex */
+    uint8_t subindex_max;       /**< Highest accepted Subindex */
+    uint8_t access;             /**< IOLINK_ISDU_ACCESS_* */
+    iolink_isdu_read_fn read;   /**< Read handler, NULL to read from data */
+    iolink_isdu_write_fn write; /**< Write handler, NULL to write to data */
+    void* data;                 /**< Direct storage (used when the callback is NULL) */
+    size_t size;                /**< Size of data in bytes */
+} iolink_isdu_entry_t;
+
 /**
  * @brief ISDU Service Context
  *
  * Holds buffers and state for the acyclic messaging engine.
  */
-typedef struct
+struct iolink_isdu_ctx
 {
-    isdu_state_t state;                            /**< Current state machine position */
-    uint8_t buffer[IOLINK_ISDU_BUFFER_SIZE];       /**< Request payload buffer */
-    size_t buffer_idx;                             /**< Bytes captured in current buffer */
-    iolink_isdu_header_t header;                   /**< Decoded request header */
-    uint8_t response_buf[IOLINK_ISDU_BUFFER_SIZE]; /**< Response payload buffer */
-    size_t response_idx;                           /**< Bytes sent from response buffer */
-    size_t response_len;                           /**< Total bytes in response buffer */
+    isdu_state_t state;          /**< Current state machine position */
+    uint8_t* buffer;             /**< Request payload (IOLINK_ISDU_BUFFER_SIZE bytes) */
+    size_t buffer_idx;           /**< Bytes captured in current buffer */
+    iolink_isdu_header_t header; /**< Decoded request header */
+    uint8_t* response_buf;       /**< Response payload, aliases buffer in single-buffer mode */
+    size_t response_idx;         /**< Response bytes already sent */
+    size_t response_len;         /**< Total response bytes */
+    uint8_t error_buf[2];        /**< Error response (0x80, code), needs no transfer buffer */
+
+    /* Response source (response_buf unless a handler streams from elsewhere) */
+    const uint8_t* response_src;       /**< Response bytes, used when response_pull is NULL */
+    iolink_isdu_pull_fn response_pull; /**< Response generator, NULL to read response_src */
+    void* response_arg;                /**< Argument passed to response_pull */
 
     /* Segmentation and Flow Control */
     isdu_state_t next_state;       /**< State to resume after sync/segmentation */
@@ -80,6 +169,7 @@ typedef struct
     bool is_segmented;             /**< Flag for multi-frame transfers */
     bool is_response_control_sent; /**< Flag for per-segment Control Byte status */
     uint8_t error_code;            /**< IO-Link ISDU Error Code (0x80XX) */
+    uint32_t transfer_token;       /**< Token of the last dispatched request (never 0) */
 
     /* Pointers to external dependencies */
     void* event_ctx; /**< Diagnostic host backlink */
@@ -89,7 +179,15 @@ typedef struct
     /* System Command Flags */
     bool reset_pending;     /**< Device reset requested (0x80) */
     bool app_reset_pending; /**< Application reset requested (0x81) */
-} iolink_isdu_ctx_t;
+
+    /* Application index table (searched before the built-in indices) */
+    const iolink_isdu_entry_t* user_table; /**< Sorted by index, NULL if none */
+    size_t user_table_len;                 /**< Number of entries in user_table */
+
+#if IOLINK_ISDU_POOL_BUFFERS == 0
+    uint8_t storage[IOLINK_ISDU_STORAGE_SIZE]; /**< Backing store of buffer/response_buf */
+#endif
+};
 
 /**
  * @brief Initialize the ISDU engine
@@ -98,6 +196,86 @@ typedef struct
  */
 void iolink_isdu_init(iolink_isdu_ctx_t* ctx);
 
+/**
+ * @brief Number of free buffers in the shared ISDU pool
+ *
+ * @return size_t Free pool buffers, 0 if IOLINK_ISDU_POOL_BUFFERS is 0
+ */
+size_t iolink_isdu_pool_free(void);
+
+/**
+ * @brief Answer the current read from caller-owned memory (zero copy)
+ *
+ * Only valid inside a read handler; return its result from the handler. The bytes
+ * are streamed straight from data while the response is transmitted, so data must
+ * stay valid and unchanged until then (const/flash data). len is not limited by
+ * IOLINK_ISDU_BUFFER_SIZE.
+ *
+ * @param ctx ISDU context passed to the handler
+ * @param data Response bytes
+ * @param len Response length
+ * @return int len on success, negative ISDU ErrorCode on invalid arguments
+ */
+int iolink_isdu_respond_ref(iolink_isdu_ctx_t* ctx, const void* data, size_t len);
+
+/**
+ * @brief Answer the current read from a byte generator
+ *
+ * Only valid inside a read handler; return its result from the handler. pull is
+ * called for each byte as it is transmitted, so generated data needs no buffer.
+ *
+ * @param ctx ISDU context passed to the handler
+ * @param pull Byte generator
+ * @param arg Argument passed to pull
+ * @param len Response length
+ * @return int len on success, negative ISDU ErrorCode on invalid arguments
+ */
+int iolink_isdu_respond_pull(iolink_isdu_ctx_t* ctx, iolink_isdu_pull_fn pull, void* arg,
+                             size_t len);
+
+/**
+ * @brief Register an application index table
+ *
+ * Entries take precedence over built-in indices with the same number. The table
+ * is referenced, not copied, and must stay valid. Register after iolink_init(),
+ * which resets the ISDU context. Lookup is a binary search.
+ *
+ * @param ctx ISDU context
+ * @param table Entries sorted by strictly ascending index (NULL to unregister)
+ * @param count Number of entries
+ * @return int 0 on success, -1 if the table is not sorted or arguments are invalid
+ */
+int iolink_isdu_register_table(iolink_isdu_ctx_t* ctx, const iolink_isdu_entry_t* table,
+                               size_t count);
+
+/**
+ * @brief Token of the request being dispatched
+ *
+ * Called by a handler that returns IOLINK_ISDU_PENDING. Every dispatched request
+ * gets a new token, so a completion for a request the master has since aborted
+ * cannot land on a later deferred request.
+ *
+ * @param ctx ISDU context
+ * @return uint32_t Token to pass to iolink_isdu_complete(), 0 if ctx is NULL
+ */
+uint32_t iolink_isdu_transfer_token(const iolink_isdu_ctx_t* ctx);
+
+/**
+ * @brief Deliver the result of a request whose handler returned IOLINK_ISDU_PENDING
+ *
+ * May be called from any task. The response is sent from the next OD exchange on.
+ *
+ * @param ctx ISDU context
+ * @param token Token the handler got from iolink_isdu_transfer_token()
+ * @param result 0 on success, or negative ISDU ErrorCode
+ * @param data Read payload (NULL for writes or errors)
+ * @param len Payload length
+ * @return int 0 on success, -1 if that request is no longer pending (e.g. aborted by
+ *             the master) or the payload does not fit
+ */
+int iolink_isdu_complete(iolink_isdu_ctx_t* ctx, uint32_t token, int result, const uint8_t* data,
+                         size_t len);
+
 /**
  * @brief Process ISDU engine logic
  *
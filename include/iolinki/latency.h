@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_LATENCY_H
+#define IOLINK_LATENCY_H
+
+#include <stdint.h>
+#include "iolinki/config.h"
+
+/**
+ * @file latency.h
+ * @brief Fixed-memory log-linear latency histograms
+ */
+
+/**
+ * @brief Latency quantities tracked per DLL context
+ */
+typedef enum
+{
+    IOLINK_LATENCY_RESPONSE = 0U, /**< Frame complete to reply sent (t_ren) */
+    IOLINK_LATENCY_CYCLE = 1U,    /**< Interval between consecutive master frames */
+    IOLINK_LATENCY_BYTE_GAP = 2U, /**< Gap between bytes inside a master frame */
+    IOLINK_LATENCY_KIND_COUNT = 3U
+} iolink_latency_kind_t;
+
+/**
+ * @brief Latency histogram
+ *
+ * With S = IOLINK_LATENCY_HIST_SUB_BITS, buckets 0 .. 2^(S+1)-1 count exact
+ * microsecond values. Above that each octave is split into 2^S linear buckets, so
+ * a sample is only known to within 1/2^S of its value (25% by default, a factor of
+ * two with S = 0). The last bucket also absorbs everything larger.
+ */
+typedef struct
+{
+    uint32_t buckets[IOLINK_LATENCY_HIST_BUCKETS]; /**< Sample counts per bucket */
+    uint32_t count;                                /**< Total samples recorded */
+    uint32_t max_us;                               /**< Largest sample seen */
+} iolink_latency_hist_t;
+
+/**
+ * @brief Clear all samples
+ *
+ * @param hist Histogram to reset
+ */
+void iolink_latency_hist_reset(iolink_latency_hist_t* hist);
+
+/**
+ * @brief Record one sample
+ *
+ * @param hist Histogram to update
+ * @param value_us Sample in microseconds
+ */
+void iolink_latency_hist_record(iolink_latency_hist_t* hist, uint32_t value_us);
+
+/**
+ * @brief Estimate a percentile from the histogram
+ *
+ * Returns the upper bound of the bucket holding the requested rank, clamped to
+ * the largest sample seen (so the result never under-reports, and over-reports by
+ * at most the bucket width, see iolink_latency_hist_t).
+ *
+ * @param hist Histogram to query
+ * @param per_10k Percentile in hundredths of a percent (5000 = p50, 9990 = p99.9)
+ * @return uint32_t Percentile in microseconds, 0 if the histogram is empty
+ */
+uint32_t iolink_latency_hist_percentile(const iolink_latency_hist_t* hist, uint16_t per_10k);
+
+#endif  // IOLINK_LATENCY_H
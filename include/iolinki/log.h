@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_LOG_H
+#define IOLINK_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "iolinki/config.h"
+
+/**
+ * @file log.h
+ * @brief Deferred binary logging with compile-time level stripping
+ *
+ * IOLINK_LOG_ERROR() .. IOLINK_LOG_DEBUG() compile to nothing above IOLINK_LOG_LEVEL.
+ * Enabled calls store a binary record (timestamp, level, format pointer, up to
+ * IOLINK_LOG_MAX_ARGS integer arguments) in a lock-free ring and return; no text is
+ * formatted on the calling path. A background context drains the ring with
+ * iolink_log_drain() or iolink_log_read() + iolink_log_format().
+ *
+ * The format string must be a literal. Supported conversions: %d %i %u %x %X %c %%
+ * with an optional '0' flag and width; arguments are integers of at most 32 bits.
+ */
+
+#define IOLINK_LOG_LEVEL_NONE 0U  /**< Logging compiled out */
+#define IOLINK_LOG_LEVEL_ERROR 1U /**< Failures */
+#define IOLINK_LOG_LEVEL_WARN 2U  /**< Recoverable protocol problems */
+#define IOLINK_LOG_LEVEL_INFO 3U  /**< State changes */
+#define IOLINK_LOG_LEVEL_DEBUG 4U /**< Per-frame / per-transfer detail */
+
+#define IOLINK_LOG_MAX_ARGS 4U /**< Arguments stored per record */
+
+/**
+ * @brief One log record as stored in the ring
+ */
+typedef struct
+{
+    uint32_t ts_us;                       /**< iolink_time_get_us() (low 32 bits) */
+    const char* fmt;                      /**< Format string, identifies the message */
+    uint32_t args[IOLINK_LOG_MAX_ARGS];   /**< Integer arguments */
+    uint8_t level;                        /**< IOLINK_LOG_LEVEL_* */
+} iolink_log_record_t;
+
+/**
+ * @brief Consumer callback for iolink_log_drain()
+ *
+ * @param arg Argument given to iolink_log_drain()
+ * @param rec Record (timestamp and level)
+ * @param text Formatted message
+ */
+typedef void (*iolink_log_sink_fn)(void* arg, const iolink_log_record_t* rec, const char* text);
+
+/**
+ * @brief Store a record (producer side, lock-free, never blocks)
+ *
+ * Use the IOLINK_LOG_* macros instead of calling this directly. Safe from several
+ * threads and ISRs at once. A full ring drops the record and counts it.
+ */
+void iolink_log_write(uint8_t level, const char* fmt, uint32_t a0, uint32_t a1, uint32_t a2,
+                      uint32_t a3);
+
+/**
+ * @brief Take the oldest record (single consumer)
+ *
+ * @param rec [out] Record
+ * @return true if a record was read, false if the ring is empty
+ */
+bool iolink_log_read(iolink_log_record_t* rec);
+
+/**
+ * @brief Format a record's message
+ *
+ * @param rec Record
+ * @param buf [out] Text, always NUL-terminated (truncated if needed)
+ * @param size Capacity of buf
+ * @return size_t Length of the text in buf
+ */
+size_t iolink_log_format(const iolink_log_record_t* rec, char* buf, size_t size);
+
+/**
+ * @brief Format and hand all queued records to a sink (single consumer)
+ *
+ * @param sink Callback receiving each message
+ * @param arg Passed to sink
+ * @return size_t Number of records drained
+ */
+size_t iolink_log_drain(iolink_log_sink_fn sink, void* arg);
+
+/**
+ * @brief Records dropped because the ring was full
+ *
+ * @return uint32_t Drop count
+ */
+uint32_t iolink_log_dropped(void);
+
+/* Pads the arguments so a call with only a format string still expands in C99 */
+#define IOLINK_LOG_EMIT_(level, fmt, a0, a1, a2, a3, ...)                                         \
+    iolink_log_write((level), (fmt), (uint32_t) (a0), (uint32_t) (a1), (uint32_t) (a2),            \
+                     (uint32_t) (a3))
+#define IOLINK_LOG_EMIT(level, ...) IOLINK_LOG_EMIT_((level), __VA_ARGS__, 0, 0, 0, 0, 0)
+
+#if IOLINK_LOG_LEVEL >= 1
+#define IOLINK_LOG_ERROR(...) IOLINK_LOG_EMIT(IOLINK_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define IOLINK_LOG_ERROR(...) ((void) 0)
+#endif
+
+#if IOLINK_LOG_LEVEL >= 2
+#define IOLINK_LOG_WARN(...) IOLINK_LOG_EMIT(IOLINK_LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define IOLINK_LOG_WARN(...) ((void) 0)
+#endif
+
+#if IOLINK_LOG_LEVEL >= 3
+#define IOLINK_LOG_INFO(...) IOLINK_LOG_EMIT(IOLINK_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define IOLINK_LOG_INFO(...) ((void) 0)
+#endif
+
+#if IOLINK_LOG_LEVEL >= 4
+#define IOLINK_LOG_DEBUG(...) IOLINK_LOG_EMIT(IOLINK_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define IOLINK_LOG_DEBUG(...) ((void) 0)
+#endif
+
+#endif  // IOLINK_LOG_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_NVM_LOG_H
+#define IOLINK_NVM_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "iolinki/config.h"
+#include "iolinki/data_storage.h"
+
+/**
+ * @file nvm_log.h
+ * @brief Log-structured, wear-leveled key/value store on flash
+ *
+ * Values are appended as records to a ring of erase sectors accessed through the
+ * iolink_ds_storage_api_t read/write/erase hooks; nothing is rewritten in place.
+ * A RAM index maps each key to its newest record, so reads are one flash read.
+ *
+ * Layout: every sector starts with an 8-byte header [seq:32][magic:32]; the
+ * magic is programmed last so a torn header is never taken as valid. A record is
+ * [len:16][key][~key] [value] [pad to 4] [crc16][commit:16]. The record
+ * including its CRC is programmed first; the commit word (0xFFFF -> 0x0000) is
+ * programmed last and is the atomic commit point. Mount ignores records without
+ * commit or with a bad CRC, so an interrupted write leaves the previous value.
+ *
+ * Sectors are filled in ring order, which spreads erases evenly. One sector is
+ * always kept erased. Reclaiming the oldest sector copies its live records to
+ * the head and erases it; iolink_nvm_log_process() does this in the background
+ * when it is cheap, so writes from the application rarely wait for an erase.
+ *
+ * The flash must allow programming erased (0xFF) bytes once and read back 0xFF
+ * after erase (NOR semantics). Not thread-safe: use one context per task.
+ */
+
+/**
+ * @brief RAM index entry
+ */
+typedef struct
+{
+    uint32_t addr; /**< Record address (0xFFFFFFFF: key not present) */
+    uint16_t len;  /**< Value length */
+} iolink_nvm_log_entry_t;
+
+/**
+ * @brief Engine statistics
+ */
+typedef struct
+{
+    uint32_t records_written;        /**< Committed value records */
+    uint32_t records_copied;         /**< Live records moved by compaction */
+    uint32_t sector_erases;          /**< Erase operations */
+    uint32_t torn_records;           /**< Uncommitted/corrupt records skipped at mount */
+    uint32_t background_compactions; /**< Reclaims done by iolink_nvm_log_process() */
+} iolink_nvm_log_stats_t;
+
+/**
+ * @brief NVM log context
+ */
+typedef struct
+{
+    const iolink_ds_storage_api_t* storage;                /**< Flash hooks */
+    uint32_t sector_size;                                  /**< Erase sector size in bytes */
+    uint8_t sector_count;                                  /**< Sectors used, from address 0 */
+    uint8_t head;                                          /**< Sector receiving new records */
+    uint32_t head_offset;                                  /**< Next free byte in head */
+    uint32_t head_seq;                                     /**< Sequence number of head */
+    uint32_t sector_live[IOLINK_NVM_LOG_MAX_SECTORS];      /**< Bytes of live records */
+    uint32_t erased_mask;                                  /**< Bit per erased sector */
+    iolink_nvm_log_entry_t index[IOLINK_NVM_LOG_MAX_KEYS]; /**< Key -> newest record */
+    iolink_nvm_log_stats_t stats;                          /**< Counters */
+} iolink_nvm_log_t;
+
+/**
+ * @brief Mount a log, rebuilding the RAM index from flash
+ *
+ * Blank or foreign flash is formatted. Sectors with a torn header are erased and
+ * a head sector sealed by an interrupted write is closed.
+ *
+ * @param log Context to initialize
+ * @param storage Flash hooks (read, write and erase are required)
+ * @param sector_size Erase sector size (multiple of 4, at least 64 bytes)
+ * @param sector_count Sectors to use (2 .. IOLINK_NVM_LOG_MAX_SECTORS)
+ * @return int 0 on success, negative on invalid arguments or flash error
+ */
+int iolink_nvm_log_mount(iolink_nvm_log_t* log, const iolink_ds_storage_api_t* storage,
+                         uint32_t sector_size, uint8_t sector_count);
+
+/**
+ * @brief Erase all sectors and start an empty log
+ *
+ * @param log Mounted context (or one whose geometry iolink_nvm_log_mount() set)
+ * @return int 0 on success, negative on flash error
+ */
+int iolink_nvm_log_format(iolink_nvm_log_t* log);
+
+/**
+ * @brief Read the newest value of a key
+ *
+ * @param log Mounted context
+ * @param key Key (< IOLINK_NVM_LOG_MAX_KEYS)
+ * @param buf [out] Value (truncated to max_len)
+ * @param max_len Capacity of buf
+ * @return int Bytes copied to buf, or negative if the key is absent or on flash error
+ */
+int iolink_nvm_log_read(iolink_nvm_log_t* log, uint8_t key, uint8_t* buf, size_t max_len);
+
+/**
+ * @brief Append a new value for a key
+ *
+ * Returns once the record is committed. May reclaim a sector (one erase) when
+ * the background has not kept up.
+ *
+ * @param log Mounted context
+ * @param key Key (< IOLINK_NVM_LOG_MAX_KEYS)
+ * @param data Value
+ * @param len Value length (may be 0)
+ * @return int 0 on success, negative if the value does not fit, the log is full
+ *         of live data, or on flash error (the previous value is kept)
+ */
+int iolink_nvm_log_write(iolink_nvm_log_t* log, uint8_t key, const uint8_t* data, size_t len);
+
+/**
+ * @brief Background compaction step
+ *
+ * Reclaims the oldest sector when fewer than two sectors are erased and its live
+ * records fit into the head without opening a new sector. Call from a low-priority
+ * task, e.g. next to iolink_params_process().
+ *
+ * @param log Mounted context
+ */
+void iolink_nvm_log_process(iolink_nvm_log_t* log);
+
+/**
+ * @brief Get engine statistics
+ *
+ * @param log Mounted context
+ * @param stats [out] Statistics
+ */
+void iolink_nvm_log_get_stats(const iolink_nvm_log_t* log, iolink_nvm_log_stats_t* stats);
+
+#endif  // IOLINK_NVM_LOG_H
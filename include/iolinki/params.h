@@ -12,20 +12,60 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "iolinki/nvm_log.h"
 
 /**
  * @file params.h
  * @brief IO-Link Parametrization Manager
+ *
+ * Persisted writes only update a RAM shadow and mark the changed fields dirty.
+ * iolink_params_process(), called from a background task, writes the dirty
+ * fields to NVM once IOLINK_PARAMS_FLUSH_DELAY_MS has passed since the first
+ * unsaved change, IOLINK_PARAMS_FLUSH_COUNT writes have accumulated, or a
+ * block parametrization ended (ParamDownloadEnd). Adjacent dirty fields go out
+ * in a single NVM write.
+ *
+ * With iolink_params_use_nvm_log(), each dirty field is appended to a
+ * log-structured store instead (keys 0 .. 2: application, function and location
+ * tag), so a tag change never rewrites a flash page in place.
+ */
+
+/**
+ * @brief Persistence statistics
  */
+typedef struct
+{
+    uint32_t persisted_sets; /**< iolink_params_set() calls with persist = true */
+    uint32_t nvm_writes;     /**< NVM writes (or log records) issued by flushes */
+    uint32_t nvm_errors;     /**< Failed NVM writes (fields stay dirty and are retried) */
+} iolink_params_stats_t;
 
 /**
  * @brief Initialize the parameter manager
  *
  * Sets up internal lookup tables and attempts to load persistent
- * configuration from Non-Volatile Memory (NVM).
+ * configuration from Non-Volatile Memory (NVM). This is a full reload: writes
+ * not yet flushed and a running block download are dropped.
  */
 void iolink_params_init(void);
 
+/**
+ * @brief Initialize the parameter manager on first use only
+ *
+ * Parameters are shared by all instances; iolink_instance_init() calls this so
+ * that bringing up another port keeps unsaved writes and a running download.
+ */
+void iolink_params_init_once(void);
+
+/**
+ * @brief Store parameters in a log-structured NVM store instead of iolink_nvm_write()
+ *
+ * Call before iolink_params_init() (i.e. before iolink_init()).
+ *
+ * @param log Mounted store, or NULL for the raw iolink_nvm_read()/write() image
+ */
+void iolink_params_use_nvm_log(iolink_nvm_log_t* log);
+
 /**
  * @brief Retrieve a parameter value by its IO-Link address
  *
@@ -44,7 +84,7 @@ int iolink_params_get(uint16_t index, uint8_t subindex, uint8_t* buffer, size_t
  * @param subindex ISDU Subindex
  * @param data Pointer to the new data to write
  * @param len Length of the new data in bytes
- * @param persist If true, synchronously commit the change to NVM
+ * @param persist If true, schedule the change for NVM (see iolink_params_process())
  * @return int 0 on success, or negative IO-Link ErrorCode (e.g. 0x80XX)
  */
 int iolink_params_set(uint16_t index, uint8_t subindex, const uint8_t* data, size_t len,
@@ -53,8 +93,67 @@ int iolink_params_set(uint16_t index, uint8_t subindex, const uint8_t* data, siz
 /**
  * @brief Reset all parameters to factory defaults
  *
- * Clears NVM and resets all writable parameters to their default values.
+ * Resets all writable parameters to their default values and schedules an
+ * immediate flush of the cleared image.
  */
 void iolink_params_factory_reset(void);
 
+/**
+ * @brief Run pending NVM jobs
+ *
+ * Call periodically from a background task, not from the cycle path: this is
+ * where iolink_nvm_write() runs. Cheap when nothing is dirty.
+ */
+void iolink_params_process(void);
+
+/**
+ * @brief Write all dirty parameters to NVM now (e.g. before power-down)
+ *
+ * @return int 0 on success (or nothing dirty), negative if an NVM write failed
+ */
+int iolink_params_flush(void);
+
+/**
+ * @brief Block parametrization started (ParamDownloadStart)
+ *
+ * Time and count triggers are held back until iolink_params_download_end().
+ */
+void iolink_params_download_start(void);
+
+/**
+ * @brief Block parametrization finished (ParamDownloadEnd)
+ *
+ * @param commit true to flush on the next iolink_params_process() run,
+ *               false (ParamBreak) to fall back to the normal flush policy
+ */
+void iolink_params_download_end(bool commit);
+
+/**
+ * @brief Change counter of a parameter
+ *
+ * Takes a new value whenever the parameter is set, reloaded or reset, so caches
+ * derived from it (e.g. the Data Storage checksum) can tell whether they are
+ * stale without reading the value. Change the application tag through
+ * iolink_params_set(), not iolink_device_info_set_application_tag().
+ *
+ * @param index ISDU Index
+ * @param subindex ISDU Subindex
+ * @return uint32_t Revision (0 for unknown parameters)
+ */
+uint32_t iolink_params_revision(uint16_t index, uint8_t subindex);
+
+/**
+ * @brief Check for parameters not yet written to NVM
+ *
+ * @return true if a flush is pending
+ */
+bool iolink_params_dirty(void);
+
+/**
+ * @brief Read persistence statistics
+ *
+ * @param stats [out] Statistics
+ */
+void iolink_params_get_stats(iolink_params_stats_t* stats);
+
 #endif  // IOLINK_PARAMS_H
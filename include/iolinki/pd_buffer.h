@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_PD_BUFFER_H
+#define IOLINK_PD_BUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iolinki/config.h"
+
+/**
+ * @file pd_buffer.h
+ * @brief Wait-free triple buffer for Process Data exchange
+ *
+ * One producer and one consumer each own a slot. The third slot is shared and
+ * handed over with a single atomic exchange, so neither side ever blocks or
+ * sees a partially written image: the producer fills its private slot and
+ * publishes it, the consumer picks up the most recently published slot.
+ * Intermediate samples the consumer did not pick up are overwritten.
+ */
+
+/** @brief Slot payload size (fits both PD_In and PD_Out) */
+#define IOLINK_PD_BUFFER_SIZE                                                                      \
+    ((IOLINK_PD_IN_MAX_SIZE > IOLINK_PD_OUT_MAX_SIZE) ? IOLINK_PD_IN_MAX_SIZE                      \
+                                                      : IOLINK_PD_OUT_MAX_SIZE)
+
+/**
+ * @brief One Process Data image
+ */
+typedef struct
+{
+    uint8_t data[IOLINK_PD_BUFFER_SIZE]; /**< PD bytes */
+    uint8_t len;                         /**< Number of valid bytes in data */
+    bool valid;                          /**< PD validity flag supplied by the producer */
+} iolink_pd_slot_t;
+
+/**
+ * @brief Triple buffer state
+ *
+ * back is owned by the producer, front by the consumer. shared holds the index of
+ * the third slot plus IOLINK_PD_BUFFER_FRESH when it carries an unread sample.
+ */
+typedef struct
+{
+    iolink_pd_slot_t slots[3];
+    volatile uint32_t shared; /**< Handed-over slot index | fresh flag */
+    uint8_t back;             /**< Producer slot index */
+    uint8_t front;            /**< Consumer slot index */
+} iolink_pd_buffer_t;
+
+/** @brief Flag in iolink_pd_buffer_t::shared marking an unread sample */
+#define IOLINK_PD_BUFFER_FRESH 0x80U
+
+/**
+ * @brief Initialize a triple buffer (all slots zeroed, nothing published)
+ * @param buf Buffer to initialize
+ */
+void iolink_pd_buffer_init(iolink_pd_buffer_t* buf);
+
+/**
+ * @brief Producer: get the private slot to fill
+ * @param buf Buffer
+ * @return Slot owned by the producer until the next publish
+ */
+iolink_pd_slot_t* iolink_pd_buffer_write_slot(iolink_pd_buffer_t* buf);
+
+/**
+ * @brief Producer: make the filled slot the latest sample
+ * @param buf Buffer
+ */
+void iolink_pd_buffer_publish(iolink_pd_buffer_t* buf);
+
+/**
+ * @brief Consumer: switch to the latest published sample if there is one
+ * @param buf Buffer
+ * @return true if a new sample was picked up, false if the current one is still latest
+ */
+bool iolink_pd_buffer_acquire(iolink_pd_buffer_t* buf);
+
+/**
+ * @brief Consumer: get the slot picked up by the last acquire
+ * @param buf Buffer
+ * @return Slot owned by the consumer until the next acquire
+ */
+const iolink_pd_slot_t* iolink_pd_buffer_read_slot(const iolink_pd_buffer_t* buf);
+
+#endif  // IOLINK_PD_BUFFER_H
@@ -12,6 +12,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "iolinki/time_utils.h"
 
 /**
  * @file phy.h
@@ -104,6 +105,31 @@ typedef struct
      * @return true if short circuit or overtemperature detected
      */
     bool (*is_short_circuit)(void);
+
+    /**
+     * @brief Non-blocking burst receive
+     *
+     * Drains up to @p len already-received bytes in one call. When provided, the DLL
+     * prefers it over recv_byte() and assembles frames from whole bursts.
+     *
+     * @param buf Destination buffer
+     * @param len Capacity of @p buf in bytes
+     * @return Number of bytes read (0 if nothing received), negative on error
+     */
+    int (*recv_buf)(uint8_t* buf, size_t len);
+
+    /**
+     * @brief Non-blocking receive of one byte with its capture timestamp
+     *
+     * For PHYs that timestamp bytes in the UART ISR/DMA driver. When provided, the DLL
+     * prefers it over recv_buf() and recv_byte() and uses the timestamps for the
+     * inter-byte and cycle time checks.
+     *
+     * @param byte Pointer to store received byte
+     * @param ts_us Pointer to store arrival time, in the iolink_time_get_us() timebase
+     * @return 1 if byte available and read, 0 if nothing received, negative on error
+     */
+    int (*recv_byte_ts)(uint8_t* byte, iolink_usec_t* ts_us);
 } iolink_phy_api_t;
 
 #endif  // IOLINK_PHY_H
@@ -31,4 +31,13 @@ const iolink_phy_api_t* iolink_phy_virtual_get(void);
  */
 void iolink_phy_virtual_set_port(const char* port);
 
+/**
+ * @brief Get the file descriptor of the open port
+ *
+ * Readable when the master has sent bytes; used to block in a run loop.
+ *
+ * @return int File descriptor, or -1 before init()
+ */
+int iolink_phy_virtual_get_fd(void);
+
 #endif  // IOLINK_PHY_VIRTUAL_H
@@ -39,6 +39,7 @@
 #define IOLINK_IDX_DIRECT_PARAMETERS_1 0x0000U
 #define IOLINK_IDX_DIRECT_PARAMETERS_2 0x0001U
 #define IOLINK_IDX_SYSTEM_COMMAND 0x0002U
+#define IOLINK_IDX_DATA_STORAGE 0x0003U
 #define IOLINK_IDX_VENDOR_ID 0x000AU
 #define IOLINK_IDX_DEVICE_ID 0x000BU
 #define IOLINK_IDX_DEVICE_ACCESS_LOCKS 0x000CU
@@ -60,6 +61,7 @@
 #define IOLINK_IDX_REVISION_ID 0x001EU
 #define IOLINK_IDX_MIN_CYCLE_TIME 0x0024U
 #define IOLINK_IDX_ERROR_STATS 0x0025U /**< Vendor-specific error statistics */
+#define IOLINK_IDX_LATENCY_HIST 0x0026U /**< Vendor-specific latency histograms */
 
 /* System Commands (Index 0x0002) */
 #define IOLINK_CMD_PARAM_DOWNLOAD_START 0x05U
@@ -90,6 +92,7 @@
 #define IOLINK_ISDU_ERROR_SUBINDEX_NOT_AVAIL 0x12U
 #define IOLINK_ISDU_ERROR_BUSY 0x30U
 #define IOLINK_ISDU_ERROR_WRITE_PROTECTED 0x33U
+#define IOLINK_ISDU_ERROR_LENGTH_UNDERRUN 0x34U
 #define IOLINK_ISDU_ERROR_SEGMENTATION 0x81U
 
 /* Event Constants */
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_RUN_LOOP_H
+#define IOLINK_RUN_LOOP_H
+
+#include <stdint.h>
+#include "iolinki/iolink.h"
+
+/**
+ * @file run_loop.h
+ * @brief Blocking epoll run loop (Linux host only)
+ *
+ * Replaces a fixed-rate polling loop: iolink_run_loop_once() sleeps in
+ * epoll_wait() until the PHY file descriptor is readable or the next DLL
+ * deadline (t_byte, wake-up hold, t_pd, activity timeout) is due, then runs one
+ * iolink_instance_process() pass. The deadline is armed on a CLOCK_MONOTONIC
+ * timerfd with microsecond resolution, so the reply leaves right after the last
+ * byte is read and an idle device does not use CPU.
+ *
+ * The PHY must return from recv_*() without blocking (O_NONBLOCK).
+ */
+
+/** @brief iolink_run_loop_once() result bit: the PHY had data */
+#define IOLINK_RUN_LOOP_IO 0x01
+/** @brief iolink_run_loop_once() result bit: a DLL deadline was due */
+#define IOLINK_RUN_LOOP_TIMER 0x02
+
+/**
+ * @brief Run loop context
+ */
+typedef struct
+{
+    int epfd;                /**< epoll instance */
+    int timerfd;             /**< Deadline timer */
+    int phy_fd;              /**< PHY file descriptor */
+    iolink_instance_t* inst; /**< Stack instance processed on wake-up */
+    uint32_t io_wakeups;     /**< Passes started by PHY data */
+    uint32_t timer_wakeups;  /**< Passes started by a DLL deadline */
+    uint32_t idle_wakeups;   /**< Passes after max_wait_ms without an event */
+} iolink_run_loop_t;
+
+/**
+ * @brief Create the epoll instance and deadline timer
+ *
+ * @param loop Context to initialize
+ * @param inst Initialized stack instance
+ * @param phy_fd Readable descriptor of the PHY (e.g. iolink_phy_virtual_get_fd())
+ * @return int 0 on success, negative on invalid arguments or system error
+ */
+int iolink_run_loop_init(iolink_run_loop_t* loop, iolink_instance_t* inst, int phy_fd);
+
+/**
+ * @brief Wait for PHY data or the next deadline, then process the stack once
+ *
+ * Also returns after max_wait_ms so the caller can do background work (log
+ * drain, iolink_params_process(), PD updates). The stack is processed in every
+ * case, including the timeout.
+ *
+ * @param loop Initialized context
+ * @param max_wait_ms Upper bound on the sleep, negative to wait without bound
+ * @return int IOLINK_RUN_LOOP_IO / IOLINK_RUN_LOOP_TIMER bits, 0 after max_wait_ms
+ *         or a signal, negative on system error
+ */
+int iolink_run_loop_once(iolink_run_loop_t* loop, int max_wait_ms);
+
+/**
+ * @brief Close the descriptors owned by the loop (not the PHY)
+ *
+ * @param loop Context
+ */
+void iolink_run_loop_close(iolink_run_loop_t* loop);
+
+#endif  // IOLINK_RUN_LOOP_H
@@ -10,15 +10,46 @@
 #define IOLINK_TIME_UTILS_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "iolinki/config.h"
 
 /**
  * @file time_utils.h
  * @brief Time abstractions for IO-Link timing enforcement
+ *
+ * Microsecond timestamps use iolink_usec_t, 64 or 32 bits wide depending on
+ * IOLINK_TIMEBASE_32BIT. The 32-bit timebase wraps, so timestamps are only
+ * compared through iolink_usec_elapsed() and iolink_usec_before(), which are
+ * correct across a wrap for intervals below half the range.
+ */
+
+#if IOLINK_TIMEBASE_32BIT
+typedef uint32_t iolink_usec_t; /**< Free-running microsecond tick (wraps) */
+typedef int32_t iolink_usec_diff_t;
+#else
+typedef uint64_t iolink_usec_t; /**< Microsecond timestamp */
+typedef int64_t iolink_usec_diff_t;
+#endif
+
+static inline iolink_usec_t iolink_us_from_ms(uint32_t ms)
+{
+    return (iolink_usec_t) ((iolink_usec_t) ms * 1000U);
+}
+
+/**
+ * @brief Time from @p since to @p now (wrap-safe)
  */
+static inline iolink_usec_t iolink_usec_elapsed(iolink_usec_t now, iolink_usec_t since)
+{
+    return (iolink_usec_t) (now - since);
+}
 
-static inline uint64_t iolink_us_from_ms(uint32_t ms)
+/**
+ * @brief Check whether @p t lies before @p deadline (wrap-safe)
+ */
+static inline bool iolink_usec_before(iolink_usec_t t, iolink_usec_t deadline)
 {
-    return (uint64_t) ms * 1000ULL;
+    return (iolink_usec_diff_t) (t - deadline) < 0;
 }
 
 /**
@@ -29,8 +60,12 @@ uint32_t iolink_time_get_ms(void);
 
 /**
  * @brief Get system time in microseconds
- * @return uint64_t current time in us
+ *
+ * With IOLINK_TIMEBASE_32BIT a port may return any free-running 32-bit
+ * microsecond counter (e.g. a hardware timer); it need not start at zero.
+ *
+ * @return iolink_usec_t current time in us
  */
-uint64_t iolink_time_get_us(void);
+iolink_usec_t iolink_time_get_us(void);
 
 #endif  // IOLINK_TIME_UTILS_H
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_TRACE_H
+#define IOLINK_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iolinki/time_utils.h"
+
+/**
+ * @file trace.h
+ * @brief Binary frame trace ring (opt-in, lock-free, single producer / single consumer)
+ *
+ * The DLL appends one record per received master frame and per sent reply. Records
+ * are variable length: a header byte, a varint timestamp delta, a length byte and
+ * the raw frame bytes. When the ring is full, new records are dropped and counted.
+ */
+
+#define IOLINK_TRACE_DIR_RX 0U /**< Master -> Device frame */
+#define IOLINK_TRACE_DIR_TX 1U /**< Device -> Master reply */
+
+#define IOLINK_TRACE_FLAG_CRC_OK 0x01U /**< Frame checksum valid (RX) */
+
+/** @brief Largest frame payload stored per record (matches DLL frame buffer) */
+#define IOLINK_TRACE_MAX_DATA 48U
+
+/**
+ * @brief Trace ring state
+ *
+ * The producer owns head, last_ts_us and has_last, the consumer owns tail and read_ts_us.
+ * Storage is provided by the caller and must be a power of two in size.
+ */
+typedef struct
+{
+    uint8_t* buf;              /**< Caller-provided storage */
+    uint32_t mask;             /**< Storage size - 1 */
+    volatile uint32_t head;    /**< Write position (free-running) */
+    volatile uint32_t tail;    /**< Read position (free-running) */
+    volatile uint32_t dropped; /**< Records lost because the ring was full */
+    iolink_usec_t last_ts_us;  /**< Producer: timestamp of last written record */
+    bool has_last;             /**< Producer: last_ts_us holds a written record's stamp */
+    uint64_t read_ts_us;       /**< Consumer: timestamp of last read record */
+} iolink_trace_ring_t;
+
+/**
+ * @brief Decoded trace record
+ */
+typedef struct
+{
+    uint64_t ts_us;                      /**< Absolute timestamp in microseconds */
+    uint8_t dir;                         /**< IOLINK_TRACE_DIR_RX or IOLINK_TRACE_DIR_TX */
+    uint8_t state;                       /**< DLL state when recorded */
+    uint8_t flags;                       /**< IOLINK_TRACE_FLAG_* */
+    uint8_t len;                         /**< Frame length (req_len for RX) */
+    uint8_t data[IOLINK_TRACE_MAX_DATA]; /**< Raw frame bytes */
+} iolink_trace_record_t;
+
+/**
+ * @brief Initialize a trace ring over caller storage
+ *
+ * @param ring Ring to initialize
+ * @param storage Backing buffer
+ * @param size Size of @p storage in bytes (power of two, at least 64)
+ * @return int 0 on success, negative on invalid arguments
+ */
+int iolink_trace_init(iolink_trace_ring_t* ring, uint8_t* storage, uint32_t size);
+
+/**
+ * @brief Append a record (producer side, never blocks)
+ *
+ * @param ring Trace ring
+ * @param dir IOLINK_TRACE_DIR_RX or IOLINK_TRACE_DIR_TX
+ * @param state DLL state
+ * @param flags IOLINK_TRACE_FLAG_* bits
+ * @param ts_us Timestamp in the iolink_time_get_us() timebase (non-decreasing; a wrap
+ *              of the 32-bit timebase continues the decoded timeline)
+ * @param data Frame bytes
+ * @param len Frame length (truncated to IOLINK_TRACE_MAX_DATA)
+ * @return true if stored, false if dropped
+ */
+bool iolink_trace_write(iolink_trace_ring_t* ring, uint8_t dir, uint8_t state, uint8_t flags,
+                        iolink_usec_t ts_us, const uint8_t* data, uint8_t len);
+
+/**
+ * @brief Remove the oldest record (consumer side)
+ *
+ * @param ring Trace ring
+ * @param out Decoded record
+ * @return int 1 if a record was read, 0 if the ring is empty, negative on error
+ */
+int iolink_trace_read(iolink_trace_ring_t* ring, iolink_trace_record_t* out);
+
+/**
+ * @brief Number of records dropped because the ring was full
+ *
+ * @param ring Trace ring
+ * @return uint32_t Drop count
+ */
+uint32_t iolink_trace_dropped(const iolink_trace_ring_t* ring);
+
+#endif  // IOLINK_TRACE_H
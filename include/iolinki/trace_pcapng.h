@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+#ifndef IOLINK_TRACE_PCAPNG_H
+#define IOLINK_TRACE_PCAPNG_H
+
+#include <stdio.h>
+#include "iolinki/trace.h"
+
+/**
+ * @file trace_pcapng.h
+ * @brief pcapng export of trace rings (Linux host only)
+ *
+ * Packets use link type LINKTYPE_USER0 (147). Each packet starts with a 4-byte
+ * pseudo-header [dir][state][flags][len] followed by the raw IO-Link frame.
+ */
+
+/** @brief pcapng link type used for IO-Link frames */
+#define IOLINK_TRACE_PCAPNG_LINKTYPE 147U
+
+/**
+ * @brief Write the pcapng Section Header and Interface Description blocks
+ *
+ * @param fp Output stream opened in binary mode
+ * @return int 0 on success, negative on write error
+ */
+int iolink_trace_pcapng_begin(FILE* fp);
+
+/**
+ * @brief Drain all pending trace records into Enhanced Packet Blocks
+ *
+ * @param ring Trace ring (consumer side)
+ * @param fp Output stream previously passed to iolink_trace_pcapng_begin()
+ * @return int Number of packets written, negative on write error
+ */
+int iolink_trace_pcapng_drain(iolink_trace_ring_t* ring, FILE* fp);
+
+#endif  // IOLINK_TRACE_PCAPNG_H
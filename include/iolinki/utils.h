@@ -27,4 +27,11 @@ static inline bool iolink_ctx_zero(void* ctx, size_t len)
     return true;
 }
 
+/**
+ * @brief Compile-time assertion usable at file scope (C99)
+ *
+ * A false condition declares an array of negative size and fails the build.
+ */
+#define IOLINK_STATIC_ASSERT(cond, name) typedef char iolink_static_assert_##name[(cond) ? 1 : -1]
+
 #endif /* IOLINK_UTILS_H */
@@ -11,31 +11,48 @@
 #include <stddef.h>
 
 /*
- * IO-Link CRC6 lookup table or calculation logic.
- * Polynomial x^6 + x^4 + x^3 + x^2 + 1 (0x1D)
- * Seed: 0x15
+ * IO-Link CRC6 lookup table.
+ * Polynomial x^6 + x^4 + x^3 + x^2 + 1 (0x1D), processed in the upper six bits of an
+ * 8-bit register: entry i is register value i shifted through eight polynomial steps.
  */
+const uint8_t g_iolink_crc6_table[256] = {
+    0x00U, 0x74U, 0xE8U, 0x9CU, 0xA4U, 0xD0U, 0x4CU, 0x38U, 0x3CU, 0x48U, 0xD4U, 0xA0U,
+    0x98U, 0xECU, 0x70U, 0x04U, 0x78U, 0x0CU, 0x90U, 0xE4U, 0xDCU, 0xA8U, 0x34U, 0x40U,
+    0x44U, 0x30U, 0xACU, 0xD8U, 0xE0U, 0x94U, 0x08U, 0x7CU, 0xF0U, 0x84U, 0x18U, 0x6CU,
+    0x54U, 0x20U, 0xBCU, 0xC8U, 0xCCU, 0xB8U, 0x24U, 0x50U, 0x68U, 0x1CU, 0x80U, 0xF4U,
+    0x88U, 0xFCU, 0x60U, 0x14U, 0x2CU, 0x58U, 0xC4U, 0xB0U, 0xB4U, 0xC0U, 0x5CU, 0x28U,
+    0x10U, 0x64U, 0xF8U, 0x8CU, 0x94U, 0xE0U, 0x7CU, 0x08U, 0x30U, 0x44U, 0xD8U, 0xACU,
+    0xA8U, 0xDCU, 0x40U, 0x34U, 0x0CU, 0x78U, 0xE4U, 0x90U, 0xECU, 0x98U, 0x04U, 0x70U,
+    0x48U, 0x3CU, 0xA0U, 0xD4U, 0xD0U, 0xA4U, 0x38U, 0x4CU, 0x74U, 0x00U, 0x9CU, 0xE8U,
+    0x64U, 0x10U, 0x8CU, 0xF8U, 0xC0U, 0xB4U, 0x28U, 0x5CU, 0x58U, 0x2CU, 0xB0U, 0xC4U,
+    0xFCU, 0x88U, 0x14U, 0x60U, 0x1CU, 0x68U, 0xF4U, 0x80U, 0xB8U, 0xCCU, 0x50U, 0x24U,
+    0x20U, 0x54U, 0xC8U, 0xBCU, 0x84U, 0xF0U, 0x6CU, 0x18U, 0x5CU, 0x28U, 0xB4U, 0xC0U,
+    0xF8U, 0x8CU, 0x10U, 0x64U, 0x60U, 0x14U, 0x88U, 0xFCU, 0xC4U, 0xB0U, 0x2CU, 0x58U,
+    0x24U, 0x50U, 0xCCU, 0xB8U, 0x80U, 0xF4U, 0x68U, 0x1CU, 0x18U, 0x6CU, 0xF0U, 0x84U,
+    0xBCU, 0xC8U, 0x54U, 0x20U, 0xACU, 0xD8U, 0x44U, 0x30U, 0x08U, 0x7CU, 0xE0U, 0x94U,
+    0x90U, 0xE4U, 0x78U, 0x0CU, 0x34U, 0x40U, 0xDCU, 0xA8U, 0xD4U, 0xA0U, 0x3CU, 0x48U,
+    0x70U, 0x04U, 0x98U, 0xECU, 0xE8U, 0x9CU, 0x00U, 0x74U, 0x4CU, 0x38U, 0xA4U, 0xD0U,
+    0xC8U, 0xBCU, 0x20U, 0x54U, 0x6CU, 0x18U, 0x84U, 0xF0U, 0xF4U, 0x80U, 0x1CU, 0x68U,
+    0x50U, 0x24U, 0xB8U, 0xCCU, 0xB0U, 0xC4U, 0x58U, 0x2CU, 0x14U, 0x60U, 0xFCU, 0x88U,
+    0x8CU, 0xF8U, 0x64U, 0x10U, 0x28U, 0x5CU, 0xC0U, 0xB4U, 0x38U, 0x4CU, 0xD0U, 0xA4U,
+    0x9CU, 0xE8U, 0x74U, 0x00U, 0x04U, 0x70U, 0xECU, 0x98U, 0xA0U, 0xD4U, 0x48U, 0x3CU,
+    0x40U, 0x34U, 0xA8U, 0xDCU, 0xE4U, 0x90U, 0x0CU, 0x78U, 0x7CU, 0x08U, 0x94U, 0xE0U,
+    0xD8U, 0xACU, 0x30U, 0x44U
+};
+
 uint8_t iolink_crc6(const uint8_t* data, uint8_t len)
 {
-    uint8_t crc = 0x15U; /* Initial value for V1.1 */
+    uint8_t crc = IOLINK_CRC6_SEED; /* Initial value for V1.1 */
 
     if (!iolink_buf_is_valid(data, len)) {
         return 0U;
     }
 
     for (uint8_t i = 0U; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t j = 0U; j < 8U; j++) {
-            if ((crc & 0x80U) != 0U) {
-                crc = (uint8_t) ((crc << 1U) ^ (0x1DU << 2U)); /* Shifted polynomial */
-            }
-            else {
-                crc <<= 1U;
-            }
-        }
+        crc = iolink_crc6_update(crc, data[i]);
     }
 
-    return (uint8_t) ((crc >> 2U) & 0x3FU); /* 6-bit result */
+    return iolink_crc6_final(crc);
 }
 
 uint8_t iolink_checksum_ck(uint8_t mc, uint8_t ckt)
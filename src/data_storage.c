@@ -7,7 +7,323 @@
  */
 
 #include "iolinki/data_storage.h"
+#include "iolinki/isdu.h"
+#include "iolinki/params.h"
+#include "iolinki/time_utils.h"
 #include "iolinki/utils.h"
+#include <string.h>
+
+/*
+ * Storage slot: [seq:32 LE][len:16 LE][checksum:16 LE][magic:16 LE][applied][pad]
+ * followed by the image. The first 10 bytes are programmed in one write after
+ * the image (magic last), so a torn commit leaves the slot invalid. The applied
+ * byte goes 0xFF -> 0x00 once the values are in the parameters.
+ */
+#define DS_SLOT_COUNT 2U
+#define DS_NO_SLOT 0xFFU
+#define DS_HDR_SIZE 12U
+#define DS_HDR_COMMIT_LEN 10U
+#define DS_HDR_APPLIED 10U
+#define DS_MAGIC 0x5344U /* "DS" */
+#define DS_IMAGE_MAX (IOLINK_DS_SLOT_SIZE - DS_HDR_SIZE)
+#define DS_REC_HDR 4U
+#define DS_TRAILER 2U
+#define DS_FLETCHER_CHUNK 4096U /* Keeps the weighted sum below 2^31 */
+
+/** @brief DS-relevant parameters, in image order */
+static const uint16_t g_ds_indices[IOLINK_DS_PARAM_COUNT] = {
+    IOLINK_IDX_APPLICATION_TAG,
+    IOLINK_IDX_FUNCTION_TAG,
+    IOLINK_IDX_LOCATION_TAG,
+};
+
+#define DS_RECORD_COUNT IOLINK_DS_PARAM_COUNT
+
+typedef struct
+{
+    uint32_t seq;
+    uint16_t len;
+    uint16_t checksum;
+    bool applied;
+} ds_slot_hdr_t;
+
+/*
+ * Fletcher-16 (mod 255) is mergeable: the sums of A || B follow from those of
+ * A and B, because every byte of B adds A's sum1 to sum2 once more.
+ */
+static void ds_fletcher_append(uint16_t* sum1, uint16_t* sum2, uint32_t b_sum1, uint32_t b_sum2,
+                               size_t b_len)
+{
+    *sum2 = (uint16_t) ((*sum2 + ((uint32_t) (b_len % 255U) * *sum1) + b_sum2) % 255U);
+    *sum1 = (uint16_t) ((*sum1 + b_sum1) % 255U);
+}
+
+/*
+ * Per chunk, byte i of n adds data[i] to sum1 and (n - i) * data[i] to sum2.
+ * Both are plain reductions without a modulo or a carried dependency, which
+ * compilers vectorize; the modulo is taken once per chunk.
+ */
+static void ds_fletcher(uint16_t* sum1, uint16_t* sum2, const uint8_t* data, size_t len)
+{
+    while (len > 0U) {
+        size_t n = (len < DS_FLETCHER_CHUNK) ? len : DS_FLETCHER_CHUNK;
+        uint32_t plain = 0U;
+        uint32_t weighted = 0U;
+        for (size_t i = 0U; i < n; ++i) {
+            plain += data[i];
+            weighted += (uint32_t) (n - i) * data[i];
+        }
+        ds_fletcher_append(sum1, sum2, plain % 255U, weighted % 255U, n);
+        data += n;
+        len -= n;
+    }
+}
+
+static uint16_t ds_sum(uint16_t sum1, uint16_t sum2)
+{
+    return (uint16_t) ((sum2 << 8U) | sum1);
+}
+
+static bool ds_is_ds_index(uint16_t index)
+{
+    for (size_t i = 0U; i < DS_RECORD_COUNT; i++) {
+        if (g_ds_indices[i] == index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ds_has_storage(const iolink_ds_ctx_t* ctx)
+{
+    return (ctx->storage != NULL) && (ctx->storage->read != NULL) &&
+           (ctx->storage->write != NULL);
+}
+
+static uint32_t ds_slot_addr(uint8_t slot)
+{
+    return (uint32_t) slot * IOLINK_DS_SLOT_SIZE;
+}
+
+static uint8_t ds_staging_slot(const iolink_ds_ctx_t* ctx)
+{
+    return (ctx->active_slot == 0U) ? 1U : 0U;
+}
+
+/* Serialize one record of the current parameters (out: DS_REC_HDR + IOLINK_DS_VALUE_MAX) */
+static uint8_t ds_record_load(size_t rec, uint8_t* out)
+{
+    int len = iolink_params_get(g_ds_indices[rec], 0U, &out[DS_REC_HDR], IOLINK_DS_VALUE_MAX);
+    if (len < 0) {
+        len = 0;
+    }
+    out[0] = (uint8_t) (g_ds_indices[rec] >> 8U);
+    out[1] = (uint8_t) g_ds_indices[rec];
+    out[2] = 0U;
+    out[3] = (uint8_t) len;
+    return (uint8_t) (DS_REC_HDR + (size_t) len);
+}
+
+/*
+ * Bring the per-record checksum cache up to date and merge it into
+ * current_checksum. Only records whose parameter revision changed are
+ * serialized again, unless full is set (boot).
+ */
+static size_t ds_refresh(iolink_ds_ctx_t* ctx, bool full)
+{
+    uint8_t rec[DS_REC_HDR + IOLINK_DS_VALUE_MAX];
+    uint16_t sum1 = 0U;
+    uint16_t sum2 = 0U;
+    size_t size = DS_TRAILER;
+    for (size_t i = 0U; i < DS_RECORD_COUNT; i++) {
+        iolink_ds_record_sum_t* cached = &ctx->rec_sum[i];
+        uint32_t revision = iolink_params_revision(g_ds_indices[i], 0U);
+        if (full || (revision != cached->revision)) {
+            uint16_t rec_sum1 = 0U;
+            uint16_t rec_sum2 = 0U;
+            uint8_t n = ds_record_load(i, rec);
+            ds_fletcher(&rec_sum1, &rec_sum2, rec, n);
+            cached->revision = revision;
+            cached->len = n;
+            cached->sum1 = (uint8_t) rec_sum1;
+            cached->sum2 = (uint8_t) rec_sum2;
+            ctx->stats.records_serialized++;
+        }
+        ds_fletcher_append(&sum1, &sum2, cached->sum1, cached->sum2, cached->len);
+        size += cached->len;
+    }
+    ctx->current_checksum = ds_sum(sum1, sum2);
+    return size;
+}
+
+/*
+ * Walk the image in a slot record by record, checking its structure and
+ * checksum. With apply set, every record is also written to the parameters.
+ */
+static int ds_slot_walk(const iolink_ds_ctx_t* ctx, uint8_t slot, size_t len, uint16_t* checksum,
+                        bool apply)
+{
+    const iolink_ds_storage_api_t* storage = ctx->storage;
+    uint32_t base = ds_slot_addr(slot) + DS_HDR_SIZE;
+    uint8_t rec[DS_REC_HDR + IOLINK_DS_VALUE_MAX];
+    uint16_t sum1 = 0U;
+    uint16_t sum2 = 0U;
+    size_t pos = 0U;
+
+    if ((len < DS_TRAILER) || (len > DS_IMAGE_MAX)) {
+        return -1;
+    }
+    size_t body = len - DS_TRAILER;
+    while (pos < body) {
+        if (((body - pos) < DS_REC_HDR) || (storage->read(base + pos, rec, DS_REC_HDR) != 0)) {
+            return -1;
+        }
+        uint16_t index = (uint16_t) (((uint16_t) rec[0] << 8U) | rec[1]);
+        size_t vlen = rec[3];
+        if (!ds_is_ds_index(index) || (rec[2] != 0U) || (vlen > IOLINK_DS_VALUE_MAX) ||
+            (vlen > (body - pos - DS_REC_HDR))) {
+            return -1;
+        }
+        if ((vlen > 0U) &&
+            (storage->read(base + pos + DS_REC_HDR, &rec[DS_REC_HDR], vlen) != 0)) {
+            return -1;
+        }
+        ds_fletcher(&sum1, &sum2, rec, DS_REC_HDR + vlen);
+        if (apply && (iolink_params_set(index, 0U, &rec[DS_REC_HDR], vlen, true) != 0)) {
+            return -1;
+        }
+        pos += DS_REC_HDR + vlen;
+    }
+
+    uint8_t trailer[DS_TRAILER];
+    if (storage->read(base + pos, trailer, DS_TRAILER) != 0) {
+        return -1;
+    }
+    *checksum = ds_sum(sum1, sum2);
+    return (*checksum == (uint16_t) (((uint16_t) trailer[0] << 8U) | trailer[1])) ? 0 : -1;
+}
+
+/* Header of a slot holding a committed, intact image */
+static bool ds_slot_read_hdr(const iolink_ds_ctx_t* ctx, uint8_t slot, ds_slot_hdr_t* hdr)
+{
+    uint8_t raw[DS_HDR_SIZE];
+    uint16_t checksum = 0U;
+    if (ctx->storage->read(ds_slot_addr(slot), raw, sizeof(raw)) != 0) {
+        return false;
+    }
+    if ((uint16_t) (raw[8] | ((uint16_t) raw[9] << 8U)) != DS_MAGIC) {
+        return false;
+    }
+    hdr->seq = (uint32_t) raw[0] | ((uint32_t) raw[1] << 8U) | ((uint32_t) raw[2] << 16U) |
+               ((uint32_t) raw[3] << 24U);
+    hdr->len = (uint16_t) (raw[4] | ((uint16_t) raw[5] << 8U));
+    hdr->checksum = (uint16_t) (raw[6] | ((uint16_t) raw[7] << 8U));
+    hdr->applied = (raw[DS_HDR_APPLIED] == 0x00U);
+    return (ds_slot_walk(ctx, slot, hdr->len, &checksum, false) == 0) &&
+           (checksum == hdr->checksum);
+}
+
+/* Make a slot ready to receive an image: erase it, or clear the magic of erase-less storage */
+static int ds_slot_prepare(const iolink_ds_ctx_t* ctx, uint8_t slot)
+{
+    if (ctx->storage->erase != NULL) {
+        return ctx->storage->erase(ds_slot_addr(slot), IOLINK_DS_SLOT_SIZE);
+    }
+    uint8_t raw[DS_HDR_SIZE];
+    (void) memset(raw, 0xFF, sizeof(raw));
+    raw[8] = 0x00U;
+    raw[9] = 0x00U;
+    return ctx->storage->write(ds_slot_addr(slot), raw, sizeof(raw));
+}
+
+/* Commit point: program seq, len, checksum and magic of a verified image */
+static int ds_slot_commit(const iolink_ds_ctx_t* ctx, uint8_t slot, uint32_t seq, uint16_t len,
+                          uint16_t checksum)
+{
+    const uint8_t raw[DS_HDR_COMMIT_LEN] = {
+        (uint8_t) seq,
+        (uint8_t) (seq >> 8U),
+        (uint8_t) (seq >> 16U),
+        (uint8_t) (seq >> 24U),
+        (uint8_t) len,
+        (uint8_t) (len >> 8U),
+        (uint8_t) checksum,
+        (uint8_t) (checksum >> 8U),
+        (uint8_t) DS_MAGIC, /* Magic last: the commit point */
+        (uint8_t) (DS_MAGIC >> 8U),
+    };
+    return ctx->storage->write(ds_slot_addr(slot), raw, sizeof(raw));
+}
+
+/*
+ * Apply a committed image as one parameter block and mark the slot applied. The
+ * parameters are written back before the mark: with write-behind they would only
+ * reach NVM on a later iolink_params_process(), and a power loss in between would
+ * leave an applied slot over stale parameters that boot no longer rolls forward.
+ */
+static int ds_slot_apply(const iolink_ds_ctx_t* ctx, uint8_t slot, uint16_t len)
+{
+    static const uint8_t applied = 0x00U;
+    uint16_t checksum = 0U;
+
+    iolink_params_download_start();
+    int ret = ds_slot_walk(ctx, slot, len, &checksum, true);
+    iolink_params_download_end(true);
+    if (ret != 0) {
+        return ret;
+    }
+    ret = iolink_params_flush();
+    if (ret != 0) {
+        return ret;
+    }
+    return ctx->storage->write(ds_slot_addr(slot) + DS_HDR_APPLIED, &applied, 1U);
+}
+
+static void ds_finish_request(iolink_ds_ctx_t* ctx, int result)
+{
+    if (ctx->isdu_ctx != NULL) {
+        (void) iolink_isdu_complete((iolink_isdu_ctx_t*) ctx->isdu_ctx, ctx->isdu_token, result,
+                                    NULL, 0U);
+        ctx->isdu_ctx = NULL;
+    }
+}
+
+/* Verify the staged image, commit it and apply it */
+static void ds_commit(iolink_ds_ctx_t* ctx)
+{
+    uint8_t slot = ds_staging_slot(ctx);
+    uint16_t checksum = 0U;
+    int result = -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+
+    if (ds_has_storage(ctx) && (ds_slot_walk(ctx, slot, ctx->rx_len, &checksum, false) == 0) &&
+        (ds_slot_commit(ctx, slot, ctx->seq + 1U, ctx->rx_len, checksum) == 0)) {
+        ctx->active_slot = slot;
+        ctx->seq++;
+        /* Committed: a failed apply is retried by iolink_ds_init() */
+        (void) ds_slot_apply(ctx, slot, ctx->rx_len);
+        ctx->current_checksum = checksum;
+        ctx->stats.download_us =
+            (uint32_t) iolink_usec_elapsed(iolink_time_get_us(), ctx->transfer_start_us);
+        ctx->stats.download_bytes = ctx->rx_len;
+        ctx->stats.commits++;
+        result = 0;
+    }
+    else {
+        ctx->stats.rejects++;
+    }
+    ctx->state = IOLINK_DS_STATE_IDLE;
+    ds_finish_request(ctx, result);
+}
+
+static void ds_upload_rewind(iolink_ds_ctx_t* ctx)
+{
+    ctx->up_rec = 0U;
+    ctx->up_start = 0U;
+    ctx->up_sum1 = 0U;
+    ctx->up_sum2 = 0U;
+    ctx->up_rec_len = ds_record_load(0U, ctx->up_buf);
+    ds_fletcher(&ctx->up_sum1, &ctx->up_sum2, ctx->up_buf, ctx->up_rec_len);
+}
 
 void iolink_ds_init(iolink_ds_ctx_t* ctx, const iolink_ds_storage_api_t* storage)
 {
@@ -16,21 +332,38 @@ void iolink_ds_init(iolink_ds_ctx_t* ctx, const iolink_ds_storage_api_t* storage
     }
     ctx->storage = storage;
     ctx->state = IOLINK_DS_STATE_IDLE;
+    ctx->active_slot = DS_NO_SLOT;
+
+    if (ds_has_storage(ctx)) {
+        ds_slot_hdr_t hdr[DS_SLOT_COUNT];
+        for (uint8_t slot = 0U; slot < DS_SLOT_COUNT; slot++) {
+            if (ds_slot_read_hdr(ctx, slot, &hdr[slot]) &&
+                ((ctx->active_slot == DS_NO_SLOT) ||
+                 ((int32_t) (hdr[slot].seq - hdr[ctx->active_slot].seq) > 0))) {
+                ctx->active_slot = slot;
+            }
+        }
+        if (ctx->active_slot != DS_NO_SLOT) {
+            ctx->seq = hdr[ctx->active_slot].seq;
+            if (!hdr[ctx->active_slot].applied) {
+                /* Power was lost between commit and apply: roll forward */
+                (void) ds_slot_apply(ctx, ctx->active_slot, hdr[ctx->active_slot].len);
+            }
+        }
+    }
+    (void) ds_refresh(ctx, true);
 }
 
 uint16_t iolink_ds_calc_checksum(const uint8_t* data, size_t len)
 {
-    /* Fletcher-16 or simple sum for demo. IO-Link usually uses a specific CRC. */
+    /* Fletcher-16 (mod 255) */
     uint16_t sum1 = 0U;
     uint16_t sum2 = 0U;
     if (!iolink_buf_is_valid(data, len)) {
         return 0U;
     }
-    for (size_t i = 0U; i < len; ++i) {
-        sum1 = (uint16_t) ((sum1 + (uint16_t) data[i]) % 255U);
-        sum2 = (uint16_t) ((sum2 + sum1) % 255U);
-    }
-    return (uint16_t) ((sum2 << 8U) | sum1);
+    ds_fletcher(&sum1, &sum2, data, len);
+    return ds_sum(sum1, sum2);
 }
 
 void iolink_ds_check(iolink_ds_ctx_t* ctx, uint16_t master_checksum)
@@ -40,6 +373,7 @@ void iolink_ds_check(iolink_ds_ctx_t* ctx, uint16_t master_checksum)
     }
 
     ctx->master_checksum = master_checksum;
+    (void) ds_refresh(ctx, false); /* O(1) unless parameters changed */
 
     if (ctx->state != IOLINK_DS_STATE_IDLE) {
         return;
@@ -63,25 +397,27 @@ void iolink_ds_process(iolink_ds_ctx_t* ctx)
 
     switch (ctx->state) {
         case IOLINK_DS_STATE_UPLOAD_REQ:
-            /* Master indicated it has no data -> Device sends parameters */
-            /* Byte-by-byte transfer would happen here */
+            /* Master reads the image from index 0x0003 until ParamUploadEnd */
             ctx->state = IOLINK_DS_STATE_UPLOADING;
             break;
 
         case IOLINK_DS_STATE_UPLOADING:
-            /* Complete upload simulation */
-            ctx->state = IOLINK_DS_STATE_IDLE;
+        case IOLINK_DS_STATE_DOWNLOADING:
+            /* Transfer driven by the master */
             break;
 
         case IOLINK_DS_STATE_DOWNLOAD_REQ:
-            /* Master indicated a mismatch -> Device receives parameters */
+            /* Erase the staging slot before the first chunk arrives */
+            if (ds_has_storage(ctx) && (ds_slot_prepare(ctx, ds_staging_slot(ctx)) != 0)) {
+                ctx->stats.rejects++;
+                ctx->state = IOLINK_DS_STATE_IDLE;
+                break;
+            }
             ctx->state = IOLINK_DS_STATE_DOWNLOADING;
             break;
 
-        case IOLINK_DS_STATE_DOWNLOADING:
-            /* Update local parameters and storage */
-            ctx->current_checksum = ctx->master_checksum;
-            ctx->state = IOLINK_DS_STATE_IDLE;
+        case IOLINK_DS_STATE_COMMIT:
+            ds_commit(ctx);
             break;
 
         default:
@@ -101,6 +437,7 @@ int iolink_ds_start_upload(iolink_ds_ctx_t* ctx)
     }
 
     ctx->state = IOLINK_DS_STATE_UPLOAD_REQ;
+    ctx->transfer_start_us = iolink_time_get_us();
     return 0;
 }
 
@@ -115,6 +452,8 @@ int iolink_ds_start_download(iolink_ds_ctx_t* ctx)
     }
 
     ctx->state = IOLINK_DS_STATE_DOWNLOAD_REQ;
+    ctx->transfer_start_us = iolink_time_get_us();
+    ctx->rx_len = 0U;
     return 0;
 }
 
@@ -124,8 +463,9 @@ int iolink_ds_abort(iolink_ds_ctx_t* ctx)
         return -1;
     }
 
-    /* Abort any active DS operation */
+    /* Abort any active DS operation; a staged image is never committed */
     ctx->state = IOLINK_DS_STATE_IDLE;
+    ctx->isdu_ctx = NULL;
     return 0;
 }
 
@@ -146,27 +486,31 @@ int iolink_ds_handle_command(iolink_ds_ctx_t* ctx, uint8_t cmd, uint16_t access_
     switch (cmd) {
         case IOLINK_CMD_PARAM_UPLOAD_START: /* 0x07 */
             /* Master wants to read parameters (Upload) */
-            if (ctx->state != IOLINK_DS_STATE_IDLE) return -1; /* Busy */
-            ctx->state = IOLINK_DS_STATE_UPLOAD_REQ;
-            break;
+            return iolink_ds_start_upload(ctx);
 
         case IOLINK_CMD_PARAM_UPLOAD_END: /* 0x08 */
             /* Finish upload */
-            if (ctx->state == IOLINK_DS_STATE_UPLOADING) {
+            if ((ctx->state == IOLINK_DS_STATE_UPLOAD_REQ) ||
+                (ctx->state == IOLINK_DS_STATE_UPLOADING)) {
+                ctx->stats.upload_us =
+                    (uint32_t) iolink_usec_elapsed(iolink_time_get_us(), ctx->transfer_start_us);
+                ctx->stats.upload_bytes = ctx->up_len;
                 ctx->state = IOLINK_DS_STATE_IDLE;
             }
             break;
 
         case IOLINK_CMD_PARAM_DOWNLOAD_START: /* 0x05 */
             /* Master wants to write parameters (Download) */
-            if (ctx->state != IOLINK_DS_STATE_IDLE) return -1; /* Busy */
-            ctx->state = IOLINK_DS_STATE_DOWNLOAD_REQ;
-            break;
+            return iolink_ds_start_download(ctx);
 
         case IOLINK_CMD_PARAM_DOWNLOAD_END: /* 0x06 */
-            /* Finish download */
-            if (ctx->state == IOLINK_DS_STATE_DOWNLOADING) {
-                ctx->current_checksum = ctx->master_checksum;
+            /* Finish download: a staged image is committed by iolink_ds_process() */
+            if ((ctx->state == IOLINK_DS_STATE_DOWNLOADING) && (ctx->rx_len > 0U)) {
+                ctx->state = IOLINK_DS_STATE_COMMIT;
+                return 1;
+            }
+            if ((ctx->state == IOLINK_DS_STATE_DOWNLOAD_REQ) ||
+                (ctx->state == IOLINK_DS_STATE_DOWNLOADING)) {
                 ctx->state = IOLINK_DS_STATE_IDLE;
             }
             break;
@@ -180,3 +524,79 @@ int iolink_ds_handle_command(iolink_ds_ctx_t* ctx, uint8_t cmd, uint16_t access_
 
     return 0;
 }
+
+const uint16_t* iolink_ds_get_indices(size_t* count)
+{
+    if (count != NULL) {
+        *count = DS_RECORD_COUNT;
+    }
+    return g_ds_indices;
+}
+
+size_t iolink_ds_image_open(iolink_ds_ctx_t* ctx)
+{
+    if (ctx == NULL) {
+        return 0U;
+    }
+    size_t size = ds_refresh(ctx, false);
+    ctx->up_len = (uint16_t) size;
+    ds_upload_rewind(ctx);
+    return size;
+}
+
+uint8_t iolink_ds_image_byte(void* arg, size_t offset)
+{
+    iolink_ds_ctx_t* ctx = (iolink_ds_ctx_t*) arg;
+    if (ctx == NULL) {
+        return 0U;
+    }
+    if (offset < ctx->up_start) {
+        ds_upload_rewind(ctx); /* Read restarted */
+    }
+    while (offset >= ((size_t) ctx->up_start + ctx->up_rec_len)) {
+        if ((size_t) ctx->up_rec + 1U >= DS_RECORD_COUNT) {
+            /* Trailer: checksum of the records produced so far */
+            size_t pos = offset - ((size_t) ctx->up_start + ctx->up_rec_len);
+            uint16_t checksum = ds_sum(ctx->up_sum1, ctx->up_sum2);
+            if (pos == 0U) {
+                return (uint8_t) (checksum >> 8U);
+            }
+            return (pos == 1U) ? (uint8_t) checksum : 0U;
+        }
+        ctx->up_start = (uint16_t) (ctx->up_start + ctx->up_rec_len);
+        ctx->up_rec++;
+        ctx->up_rec_len = ds_record_load(ctx->up_rec, ctx->up_buf);
+        ds_fletcher(&ctx->up_sum1, &ctx->up_sum2, ctx->up_buf, ctx->up_rec_len);
+    }
+    return ctx->up_buf[offset - ctx->up_start];
+}
+
+int iolink_ds_write_image(iolink_ds_ctx_t* ctx, const uint8_t* data, size_t len)
+{
+    if ((ctx == NULL) || !iolink_buf_is_valid(data, len)) {
+        return -3;
+    }
+    if (ctx->state == IOLINK_DS_STATE_DOWNLOAD_REQ) {
+        return -1; /* Staging slot not erased yet */
+    }
+    if ((ctx->state != IOLINK_DS_STATE_DOWNLOADING) || !ds_has_storage(ctx)) {
+        return -3;
+    }
+    if (len > (DS_IMAGE_MAX - (size_t) ctx->rx_len)) {
+        return -2;
+    }
+    uint32_t addr = ds_slot_addr(ds_staging_slot(ctx)) + DS_HDR_SIZE + ctx->rx_len;
+    if ((len > 0U) && (ctx->storage->write(addr, data, len) != 0)) {
+        return -3;
+    }
+    ctx->rx_len = (uint16_t) (ctx->rx_len + len);
+    return 0;
+}
+
+void iolink_ds_get_stats(const iolink_ds_ctx_t* ctx, iolink_ds_stats_t* stats)
+{
+    if ((ctx == NULL) || (stats == NULL)) {
+        return;
+    }
+    *stats = ctx->stats;
+}
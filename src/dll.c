@@ -12,10 +12,72 @@
 #include "iolinki/protocol.h"
 #include "iolinki/time_utils.h"
 #include "iolinki/utils.h"
+#include "iolinki/log.h"
+#include "iolinki/platform.h"
+#include "iolinki/atomic.h"
 #include <string.h>
-#include <stdio.h>
 
-#define DLL_LOG(...)
+/*
+ * Link parameters as seen by the frame path. With the IOLINK_FIXED_* options
+ * (config.h) they are constants, so the compiler specializes the receive and
+ * reply path for the configured M-sequence type and PD lengths.
+ */
+#ifdef IOLINK_FIXED_M_SEQ_TYPE
+#define DLL_M_SEQ_TYPE(ctx) ((uint8_t) (IOLINK_FIXED_M_SEQ_TYPE))
+#define DLL_OD_LEN(ctx) (((IOLINK_FIXED_M_SEQ_TYPE) >= IOLINK_M_SEQ_TYPE_2_1) ? 2U : 1U)
+#else
+#define DLL_M_SEQ_TYPE(ctx) ((ctx)->m_seq_type)
+#define DLL_OD_LEN(ctx) ((ctx)->od_len)
+#endif
+
+#ifdef IOLINK_FIXED_PD_IN_LEN
+#define DLL_PD_IN_LEN(ctx) ((uint8_t) (IOLINK_FIXED_PD_IN_LEN))
+#else
+#define DLL_PD_IN_LEN(ctx) ((ctx)->pd_in_len_current)
+#endif
+
+#ifdef IOLINK_FIXED_PD_OUT_LEN
+#define DLL_PD_OUT_LEN(ctx) ((uint8_t) (IOLINK_FIXED_PD_OUT_LEN))
+#else
+#define DLL_PD_OUT_LEN(ctx) ((ctx)->pd_out_len_current)
+#endif
+
+/*
+ * Context layout (see iolink_dll_ctx_t): the fields read for every received byte
+ * share the first 64-byte cache line, the whole hot block fits in four, and the
+ * configuration and counters start behind the PD buffers, histograms and sub-modules.
+ */
+#define DLL_CACHE_LINE 64U
+IOLINK_STATIC_ASSERT(offsetof(iolink_dll_ctx_t, state) == 0U, dll_state_first);
+IOLINK_STATIC_ASSERT(offsetof(iolink_dll_ctx_t, timer_due_us) +
+                             (IOLINK_DLL_TIMER_COUNT * sizeof(iolink_usec_t)) <=
+                         DLL_CACHE_LINE,
+                     dll_byte_path_one_line);
+IOLINK_STATIC_ASSERT(IOLINK_DLL_HOT_BYTES <= (4U * DLL_CACHE_LINE), dll_hot_block_size);
+IOLINK_STATIC_ASSERT(offsetof(iolink_dll_ctx_t, tx_buf) + IOLINK_DLL_TX_BUF_SIZE <=
+                         IOLINK_DLL_HOT_BYTES,
+                     dll_tx_buf_hot);
+IOLINK_STATIC_ASSERT(offsetof(iolink_dll_ctx_t, pd_in_len) > offsetof(iolink_dll_ctx_t, ds),
+                     dll_config_cold);
+IOLINK_STATIC_ASSERT(offsetof(iolink_dll_ctx_t, crc_errors) > IOLINK_DLL_HOT_BYTES,
+                     dll_counters_cold);
+
+/* Without master traffic for this long the DLL returns to STARTUP */
+#define DLL_ACTIVITY_TIMEOUT_US 1000000U
+
+#if IOLINK_DLL_RX_ISR
+/* The receive ISR shares frame state and deadlines; thread-side changes mask it */
+#define DLL_ISR_LOCK() iolink_critical_enter()
+#define DLL_ISR_UNLOCK() iolink_critical_exit()
+#define DLL_RX_QUEUE_MASK (IOLINK_DLL_RX_QUEUE_SIZE - 1U)
+#else
+#define DLL_ISR_LOCK()
+#define DLL_ISR_UNLOCK()
+#endif
+
+/* Type 1/2 request length: MC | CKT | PD_Out | OD | CK */
+#define DLL_TYPE1_2_REQ_LEN(ctx) \
+    ((uint8_t) (IOLINK_M_SEQ_HEADER_LEN + DLL_PD_OUT_LEN(ctx) + DLL_OD_LEN(ctx) + 1U))
 
 static uint32_t dll_get_t_ren_limit_us(const iolink_dll_ctx_t* ctx)
 {
@@ -61,25 +123,111 @@ static uint32_t dll_get_t_byte_limit_us(const iolink_dll_ctx_t* ctx)
     return t_bit_us * 16U;
 }
 
-static bool dll_t_pd_active(const iolink_dll_ctx_t* ctx)
+/*
+ * Deadline table: one slot per iolink_dll_timer_t and a bit mask of the armed
+ * ones. Polled receive arms them once per process pass, not per byte; with
+ * IOLINK_DLL_RX_ISR each byte taken by the ISR re-arms the t_byte and activity
+ * slots (two stores each). The earliest deadline is found by scanning the few
+ * armed slots when asked for. The mask update is masked against the ISR.
+ */
+static void dll_timer_arm(iolink_dll_ctx_t* ctx, iolink_dll_timer_t timer, iolink_usec_t due_us)
+{
+    DLL_ISR_LOCK();
+    ctx->timer_due_us[timer] = due_us;
+    ctx->timers_armed |= (uint8_t) (1U << timer);
+    DLL_ISR_UNLOCK();
+}
+
+static void dll_timer_disarm(iolink_dll_ctx_t* ctx, iolink_dll_timer_t timer)
+{
+    DLL_ISR_LOCK();
+    ctx->timers_armed &= (uint8_t) ~(1U << timer);
+    DLL_ISR_UNLOCK();
+}
+
+static bool dll_timer_armed(const iolink_dll_ctx_t* ctx, iolink_dll_timer_t timer)
+{
+    return (ctx->timers_armed & (1U << timer)) != 0U;
+}
+
+/* Armed and reached at now_us; the caller disarms it */
+static bool dll_timer_due(const iolink_dll_ctx_t* ctx, iolink_dll_timer_t timer,
+                          iolink_usec_t now_us)
+{
+    return dll_timer_armed(ctx, timer) && !iolink_usec_before(now_us, ctx->timer_due_us[timer]);
+}
+
+/* The checks fire once a limit is exceeded, one microsecond after it */
+static void dll_arm_t_byte(iolink_dll_ctx_t* ctx)
 {
-    if ((ctx == NULL) || (ctx->t_pd_deadline_us == 0U)) {
+    if ((ctx->frame_index > 0U) && ctx->enforce_timing && (ctx->t_byte_limit_us > 0U)) {
+        dll_timer_arm(ctx, IOLINK_DLL_TIMER_T_BYTE, ctx->last_byte_us + ctx->t_byte_limit_us + 1U);
+    }
+    else {
+        dll_timer_disarm(ctx, IOLINK_DLL_TIMER_T_BYTE);
+    }
+}
+
+static void dll_arm_activity(iolink_dll_ctx_t* ctx, iolink_usec_t now_us)
+{
+    dll_timer_arm(ctx, IOLINK_DLL_TIMER_ACTIVITY, now_us + DLL_ACTIVITY_TIMEOUT_US + 1U);
+}
+
+static bool dll_t_pd_active(iolink_dll_ctx_t* ctx)
+{
+    if (!dll_timer_armed(ctx, IOLINK_DLL_TIMER_T_PD)) {
+        return false;
+    }
+    if (dll_timer_due(ctx, IOLINK_DLL_TIMER_T_PD, ctx->pass_us)) {
+        dll_timer_disarm(ctx, IOLINK_DLL_TIMER_T_PD);
         return false;
     }
-    return iolink_time_get_us() < ctx->t_pd_deadline_us;
+    return true;
 }
 
 static bool dll_drain_rx(iolink_dll_ctx_t* ctx)
 {
-    if ((ctx == NULL) || (ctx->phy == NULL) || (ctx->phy->recv_byte == NULL)) {
+    if ((ctx == NULL) || (ctx->phy == NULL)) {
+        return false;
+    }
+#if IOLINK_DLL_RX_ISR
+    uint32_t head = iolink_atomic_load_u32(&ctx->rx_q_head);
+    if (ctx->rx_q_tail == head) {
         return false;
     }
+    iolink_atomic_store_u32(&ctx->rx_q_tail, head);
+    return true;
+#else
     bool saw_byte = false;
+    if (ctx->phy->recv_buf != NULL) {
+        uint8_t burst[sizeof(ctx->frame_buf)];
+        while (ctx->phy->recv_buf(burst, sizeof(burst)) > 0) {
+            saw_byte = true;
+        }
+        return saw_byte;
+    }
+    if (ctx->phy->recv_byte == NULL) {
+        return false;
+    }
     uint8_t byte = 0U;
     while (ctx->phy->recv_byte(&byte) > 0) {
         saw_byte = true;
     }
     return saw_byte;
+#endif
+}
+
+/* Retry limit reached: back to SIO at COM1 until the next wake-up */
+static void dll_sio_fallback(iolink_dll_ctx_t* ctx)
+{
+    IOLINK_LOG_WARN("DLL: SIO fallback after %u retries", ctx->total_retries);
+    iolink_dll_set_sio_mode(ctx);
+    iolink_dll_set_baudrate(ctx, IOLINK_BAUDRATE_COM1);
+    ctx->state = IOLINK_DLL_STATE_STARTUP;
+    ctx->fallback_count = 0U;
+    ctx->frame_index = 0U;
+    iolink_event_trigger(&ctx->events, IOLINK_EVENT_CODE_COMM_ERR_FRAMING,
+                         IOLINK_EVENT_TYPE_WARNING);
 }
 
 static void dll_enter_fallback(iolink_dll_ctx_t* ctx)
@@ -92,13 +240,14 @@ static void dll_enter_fallback(iolink_dll_ctx_t* ctx)
     ctx->total_retries++;
 
     if (ctx->fallback_count >= ctx->sio_fallback_threshold) {
-        iolink_dll_set_sio_mode(ctx);
-        iolink_dll_set_baudrate(ctx, IOLINK_BAUDRATE_COM1);
-        ctx->state = IOLINK_DLL_STATE_STARTUP;
-        ctx->fallback_count = 0U;
-        ctx->frame_index = 0U;
-        iolink_event_trigger(&ctx->events, IOLINK_EVENT_CODE_COMM_ERR_FRAMING,
-                             IOLINK_EVENT_TYPE_WARNING);
+#if IOLINK_DLL_RX_ISR
+        if (ctx->rx_in_isr) {
+            /* No PHY reconfiguration from interrupt context */
+            ctx->fallback_pending = true;
+            return;
+        }
+#endif
+        dll_sio_fallback(ctx);
     }
     else if (ctx->state != IOLINK_DLL_STATE_OPERATE && ctx->state != IOLINK_DLL_STATE_ESTAB_COM) {
         iolink_dll_set_baudrate(ctx, IOLINK_BAUDRATE_COM1);
@@ -106,6 +255,15 @@ static void dll_enter_fallback(iolink_dll_ctx_t* ctx)
     }
 }
 
+static void dll_trace_tx(iolink_dll_ctx_t* ctx, const uint8_t* data, uint8_t len,
+                         iolink_usec_t ts_us)
+{
+    if (ctx->trace != NULL) {
+        (void) iolink_trace_write(ctx->trace, IOLINK_TRACE_DIR_TX, (uint8_t) ctx->state, 0U, ts_us,
+                                  data, len);
+    }
+}
+
 static void dll_handle_preoperate(iolink_dll_ctx_t* ctx, uint8_t mc, uint8_t ck)
 {
     (void) ck;
@@ -130,6 +288,55 @@ static void dll_handle_operate_type0(iolink_dll_ctx_t* ctx, uint8_t mc, uint8_t
     resp[1] = iolink_checksum_ck(resp[0], 0U);
     if (ctx->phy->send != NULL) {
         ctx->phy->send(resp, 2);
+        if (ctx->trace != NULL) {
+            dll_trace_tx(ctx, resp, 2U, iolink_time_get_us());
+        }
+    }
+}
+
+static uint8_t dll_od_status(iolink_dll_ctx_t* ctx)
+{
+    uint8_t status = 0x00;
+    if (iolink_events_pending(&ctx->events)) status |= IOLINK_OD_STATUS_EVENT;
+    if (ctx->pd_in_toggle) status |= IOLINK_OD_STATUS_PD_TOGGLE;
+    if (ctx->pd_valid) status |= IOLINK_OD_STATUS_PD_VALID;
+    return status;
+}
+
+/**
+ * @brief Build the request-independent part of the next response
+ *
+ * Fills Status and PD_In into tx_buf and runs the CRC over them, so frame
+ * completion only has to append OD bytes, finish the CRC and send.
+ */
+static void dll_arm_response(iolink_dll_ctx_t* ctx, uint8_t status)
+{
+    const iolink_pd_slot_t* sample = iolink_pd_buffer_read_slot(&ctx->pd_in);
+    uint8_t crc = iolink_crc6_update(IOLINK_CRC6_SEED, status);
+    ctx->tx_buf[0] = status;
+    for (uint8_t i = 0U; i < DLL_PD_IN_LEN(ctx); i++) {
+        uint8_t b = (i < sample->len) ? sample->data[i] : 0U;
+        ctx->tx_buf[1U + i] = b;
+        crc = iolink_crc6_update(crc, b);
+    }
+    ctx->tx_crc = crc;
+    ctx->tx_pd_len = DLL_PD_IN_LEN(ctx);
+    ctx->tx_armed = true;
+}
+
+static void dll_prearm_response(iolink_dll_ctx_t* ctx)
+{
+    /* Pick up the latest complete PD_In sample; the slot stays ours until the next one */
+    if (iolink_pd_buffer_acquire(&ctx->pd_in)) {
+        ctx->pd_valid = iolink_pd_buffer_read_slot(&ctx->pd_in)->valid;
+        ctx->pd_in_toggle = !ctx->pd_in_toggle;
+        ctx->tx_armed = false;
+    }
+
+    uint8_t status = dll_od_status(ctx);
+    if (!ctx->tx_armed || (ctx->tx_buf[0] != status) ||
+        (ctx->tx_pd_len != DLL_PD_IN_LEN(ctx))) {
+        dll_arm_response(ctx, status);
     }
 }
 
@@ -137,46 +344,48 @@ static void dll_handle_operate_type1_2(iolink_dll_ctx_t* ctx)
 {
     /* IO-Link V1.1 M-sequence structure: MC | CKT | PD | OD | CK */
     uint16_t pd_offset = IOLINK_M_SEQ_HEADER_LEN;
-    uint16_t od_offset = (uint16_t) (pd_offset + ctx->pd_out_len_current);
+    uint16_t od_offset = (uint16_t) (pd_offset + DLL_PD_OUT_LEN(ctx));
 
-    if (ctx->pd_out_len_current > 0U) {
-        memcpy(ctx->pd_out, &ctx->frame_buf[pd_offset], ctx->pd_out_len_current);
+    if (DLL_PD_OUT_LEN(ctx) > 0U) {
+        iolink_pd_slot_t* out = iolink_pd_buffer_write_slot(&ctx->pd_out);
+        memcpy(out->data, &ctx->frame_buf[pd_offset], DLL_PD_OUT_LEN(ctx));
+        out->len = DLL_PD_OUT_LEN(ctx);
+        out->valid = true;
+        iolink_pd_buffer_publish(&ctx->pd_out);
     }
 
-    uint8_t od_in[2] = {0, 0};
-    uint8_t od_out[2] = {0, 0};
-    memcpy(od_in, &ctx->frame_buf[od_offset], ctx->od_len);
-
-    for (uint16_t i = 0; i < ctx->od_len; i++) {
-        iolink_isdu_collect_byte(&ctx->isdu, od_in[i]);
+    uint8_t od_out[IOLINK_OD_MAX_SIZE] = {0};
+    uint8_t od_len =
+        (DLL_OD_LEN(ctx) <= IOLINK_OD_MAX_SIZE) ? DLL_OD_LEN(ctx) : IOLINK_OD_MAX_SIZE;
+    for (uint16_t i = 0; i < od_len; i++) {
+        iolink_isdu_collect_byte(&ctx->isdu, ctx->frame_buf[od_offset + i]);
         if (iolink_isdu_get_response_byte(&ctx->isdu, &od_out[i]) == 0) {
             od_out[i] = 0U;
         }
     }
 
-    uint8_t resp[IOLINK_PD_IN_MAX_SIZE + 5];
-    uint8_t status = 0x00;
-    if (iolink_events_pending(&ctx->events)) status |= IOLINK_OD_STATUS_EVENT;
-    if (ctx->pd_in_toggle) status |= IOLINK_OD_STATUS_PD_TOGGLE;
-    if (ctx->pd_valid) status |= IOLINK_OD_STATUS_PD_VALID;
+    /* Status may have changed since arming (e.g. event raised during this pass) */
+    dll_prearm_response(ctx);
 
-    resp[0] = status;
-    uint16_t pos = 1U;
-    if (ctx->pd_in_len_current > 0U) {
-        memcpy(&resp[pos], ctx->pd_in, ctx->pd_in_len_current);
-        pos += ctx->pd_in_len_current;
+    /* Patch OD slots into the armed frame and finish the CRC */
+    uint16_t pos = (uint16_t) (1U + ctx->tx_pd_len);
+    uint8_t crc = ctx->tx_crc;
+    for (uint16_t i = 0; i < od_len; i++) {
+        ctx->tx_buf[pos++] = od_out[i];
+        crc = iolink_crc6_update(crc, od_out[i]);
     }
-    memcpy(&resp[pos], od_out, ctx->od_len);
-    pos += ctx->od_len;
-
-    resp[pos] = iolink_crc6(resp, (uint8_t) pos);
-    pos++;
+    ctx->tx_buf[pos++] = iolink_crc6_final(crc);
 
     if (ctx->phy->send != NULL) {
-        ctx->phy->send(resp, pos);
+        ctx->phy->send(ctx->tx_buf, pos);
         ctx->fallback_count = 0U;
-        uint32_t end_tx_us = (uint32_t) iolink_time_get_us();
-        ctx->response_time_us = end_tx_us - (uint32_t) ctx->last_cycle_start_us;
+        /* The only real clock read on the reply path; refreshes the pass snapshot */
+        iolink_usec_t end_tx_us = iolink_time_get_us();
+        ctx->pass_us = end_tx_us;
+        ctx->response_time_us =
+            (uint32_t) iolink_usec_elapsed(end_tx_us, ctx->last_cycle_start_us);
+        iolink_latency_hist_record(&ctx->latency[IOLINK_LATENCY_RESPONSE], ctx->response_time_us);
+        dll_trace_tx(ctx, ctx->tx_buf, (uint8_t) pos, end_tx_us);
 
         if (ctx->enforce_timing) {
             uint32_t limit = dll_get_t_ren_limit_us(ctx);
@@ -188,7 +397,7 @@ static void dll_handle_operate_type1_2(iolink_dll_ctx_t* ctx)
             }
         }
     }
-    ctx->last_response_us = iolink_time_get_us();
+    ctx->last_response_us = ctx->pass_us;
 }
 
 static void dll_poll_diagnostics(iolink_dll_ctx_t* ctx)
@@ -215,6 +424,214 @@ static void dll_poll_diagnostics(iolink_dll_ctx_t* ctx)
     }
 }
 
+static void dll_rx_byte(iolink_dll_ctx_t* ctx, uint8_t byte, iolink_usec_t now_us)
+{
+    /* last_byte_us belongs to the current frame whenever frame_index > 0; any value,
+     * including 0 after a 32-bit wrap, is a real timestamp */
+    if (ctx->frame_index > 0U) {
+        iolink_usec_t gap_us = iolink_usec_elapsed(now_us, ctx->last_byte_us);
+        iolink_latency_hist_record(&ctx->latency[IOLINK_LATENCY_BYTE_GAP], (uint32_t) gap_us);
+        if ((ctx->enforce_timing) && (ctx->t_byte_limit_us > 0U) &&
+            (gap_us > ctx->t_byte_limit_us)) {
+            ctx->timing_errors++;
+            ctx->t_byte_violations++;
+            ctx->framing_errors++;
+            iolink_event_trigger(&ctx->events, IOLINK_EVENT_COMM_TIMING,
+                                 IOLINK_EVENT_TYPE_WARNING);
+            ctx->frame_index = 0U;
+        }
+    }
+    ctx->last_byte_us = now_us;
+
+    if (ctx->frame_index == 0U) {
+        ctx->frame_buf[0] = byte;
+        ctx->frame_index = 1U;
+        ctx->rx_crc = iolink_crc6_update(IOLINK_CRC6_SEED, byte);
+        ctx->last_frame_us = now_us;
+
+        if (ctx->baudrate == IOLINK_BAUDRATE_COM1) {
+            ctx->req_len = 2U;
+        }
+        else {
+            bool can_be_multi = (DLL_M_SEQ_TYPE(ctx) != IOLINK_M_SEQ_TYPE_0);
+            if (can_be_multi && (ctx->state == IOLINK_DLL_STATE_OPERATE)) {
+                ctx->req_len = DLL_TYPE1_2_REQ_LEN(ctx);
+            }
+            else if (can_be_multi && (ctx->state == IOLINK_DLL_STATE_ESTAB_COM) &&
+                     (byte != IOLINK_MC_TRANSITION_COMMAND)) {
+                /* Initial Type 1/2 frame to move from ESTAB_COM to OPERATE.
+                 * Any non-Type0 command (MC starting with 00) is a Type 1/2 frame. */
+                ctx->req_len = DLL_TYPE1_2_REQ_LEN(ctx);
+            }
+            else {
+                ctx->req_len = 2U;
+            }
+        }
+    }
+    else {
+        if (ctx->frame_index < sizeof(ctx->frame_buf)) {
+            ctx->frame_buf[ctx->frame_index++] = byte;
+            if (ctx->frame_index < ctx->req_len) {
+                /* Everything but the trailing CK byte is covered by the CRC */
+                ctx->rx_crc = iolink_crc6_update(ctx->rx_crc, byte);
+            }
+        }
+        else {
+            ctx->frame_index = 0U;
+            ctx->framing_errors++;
+        }
+    }
+
+    if ((ctx->frame_index > 0U) && (ctx->frame_index >= ctx->req_len)) {
+        /* Cycle start = arrival of the frame's last byte */
+        if (ctx->cycle_start_valid) {
+            iolink_usec_t cycle_us = iolink_usec_elapsed(now_us, ctx->last_cycle_start_us);
+            iolink_latency_hist_record(&ctx->latency[IOLINK_LATENCY_CYCLE], (uint32_t) cycle_us);
+            if ((ctx->enforce_timing) && (ctx->min_cycle_time_us > 0U) &&
+                (cycle_us < ctx->min_cycle_time_us)) {
+                ctx->timing_errors++;
+                ctx->t_cycle_violations++;
+                iolink_event_trigger(&ctx->events, IOLINK_EVENT_COMM_TIMING,
+                                     IOLINK_EVENT_TYPE_WARNING);
+            }
+        }
+        ctx->last_cycle_start_us = now_us;
+        ctx->cycle_start_valid = true;
+
+        bool crc_ok;
+        if (ctx->req_len == 2U) {
+            /* Type 0 CK covers MC plus a zero CKT placeholder */
+            crc_ok = (iolink_crc6_final(iolink_crc6_update(ctx->rx_crc, 0U)) == ctx->frame_buf[1]);
+        }
+        else {
+            crc_ok = (iolink_crc6_final(ctx->rx_crc) == ctx->frame_buf[ctx->req_len - 1]);
+        }
+
+        if (ctx->trace != NULL) {
+            (void) iolink_trace_write(ctx->trace, IOLINK_TRACE_DIR_RX, (uint8_t) ctx->state,
+                                      crc_ok ? IOLINK_TRACE_FLAG_CRC_OK : 0U, now_us,
+                                      ctx->frame_buf, ctx->req_len);
+        }
+
+        if (crc_ok) {
+            if ((ctx->state == IOLINK_DLL_STATE_AWAITING_COMM) ||
+                (ctx->state == IOLINK_DLL_STATE_STARTUP)) {
+                ctx->state = IOLINK_DLL_STATE_PREOPERATE;
+            }
+
+            if (ctx->state == IOLINK_DLL_STATE_PREOPERATE) {
+                if (ctx->req_len == 2U) {
+                    if (ctx->frame_buf[0] == IOLINK_MC_TRANSITION_COMMAND)
+                        dll_handle_preoperate(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
+                    else
+                        dll_handle_operate_type0(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
+                }
+            }
+            else if (ctx->state == IOLINK_DLL_STATE_ESTAB_COM) {
+                if (ctx->req_len > 2U) {
+                    uint8_t channel = ctx->frame_buf[0] & 0x60U;
+                    if (channel == 0x20U || channel == 0x60U) {
+                        ctx->framing_errors++;
+                        dll_enter_fallback(ctx);
+                    }
+                    else {
+                        ctx->state = IOLINK_DLL_STATE_OPERATE;
+                        dll_handle_operate_type1_2(ctx);
+                    }
+                }
+                else if (ctx->frame_buf[0] == IOLINK_MC_TRANSITION_COMMAND) {
+                    dll_handle_preoperate(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
+                }
+                else {
+                    dll_handle_operate_type0(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
+                }
+            }
+            else if (ctx->state == IOLINK_DLL_STATE_OPERATE) {
+                uint8_t channel = ctx->frame_buf[0] & 0x60U;
+                /* Transitions forbidden. Page Address (0x20) and Reserved (0x60) channels
+                 * rejected. */
+                if (ctx->frame_buf[0] == IOLINK_MC_TRANSITION_COMMAND || channel == 0x20U ||
+                    channel == 0x60U) {
+                    ctx->framing_errors++;
+                    dll_enter_fallback(ctx);
+                }
+                else if (ctx->req_len == 2U) {
+                    dll_handle_operate_type0(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
+                }
+                else {
+                    dll_handle_operate_type1_2(ctx);
+                }
+            }
+        }
+        else {
+            IOLINK_LOG_DEBUG("DLL: checksum error, MC 0x%02X len %u", ctx->frame_buf[0],
+                             ctx->req_len);
+            ctx->crc_errors++;
+            ctx->framing_errors++;
+            dll_enter_fallback(ctx);
+        }
+        ctx->frame_index = 0U;
+    }
+}
+
+#if IOLINK_DLL_RX_ISR
+/*
+ * Frame state and the error counters it updates belong to whichever side runs
+ * dll_rx_byte(): the ISR in OPERATE while the queue is empty and no fallback is
+ * pending, the thread otherwise. Other thread-side writes to them take the lock.
+ *
+ * Bytes the ISR queued, in order. The tail is released only after a byte and its
+ * deadlines are applied, so the ISR does not take over assembly before that.
+ */
+static void dll_rx_queue_process(iolink_dll_ctx_t* ctx)
+{
+    uint32_t tail = ctx->rx_q_tail;
+    while (tail != iolink_atomic_load_u32(&ctx->rx_q_head)) {
+        uint32_t slot = tail & DLL_RX_QUEUE_MASK;
+        iolink_usec_t ts_us = ctx->rx_q_ts_us[slot];
+        dll_rx_byte(ctx, ctx->rx_q_byte[slot], ts_us);
+        dll_arm_activity(ctx, ts_us);
+        dll_arm_t_byte(ctx);
+        tail++;
+        iolink_atomic_store_u32(&ctx->rx_q_tail, tail);
+    }
+}
+
+bool iolink_dll_rx_isr(iolink_dll_ctx_t* ctx, uint8_t byte, iolink_usec_t ts_us)
+{
+    if ((ctx == NULL) || (ctx->phy == NULL)) {
+        return false;
+    }
+
+    uint32_t head = ctx->rx_q_head;
+    if ((ctx->state == IOLINK_DLL_STATE_OPERATE) && !ctx->fallback_pending &&
+        (head == iolink_atomic_load_u32(&ctx->rx_q_tail))) {
+        /* Cyclic fast path; the reply pass refreshes pass_us, the thread keeps its own */
+        iolink_usec_t pass_us = ctx->pass_us;
+        ctx->rx_in_isr = true;
+        dll_rx_byte(ctx, byte, ts_us);
+        ctx->rx_in_isr = false;
+        ctx->pass_us = pass_us;
+        dll_arm_activity(ctx, ts_us);
+        dll_arm_t_byte(ctx);
+        if ((ctx->frame_index == 1U) && (ctx->state == IOLINK_DLL_STATE_OPERATE)) {
+            /* Build the reply while the rest of the request arrives */
+            dll_prearm_response(ctx);
+        }
+        return ctx->fallback_pending || (ctx->isdu.state == ISDU_STATE_SERVICE_EXECUTE);
+    }
+
+    if ((head - iolink_atomic_load_u32(&ctx->rx_q_tail)) >= IOLINK_DLL_RX_QUEUE_SIZE) {
+        iolink_atomic_store_u32(&ctx->rx_q_drops, ctx->rx_q_drops + 1U);
+        return true;
+    }
+    ctx->rx_q_byte[head & DLL_RX_QUEUE_MASK] = byte;
+    ctx->rx_q_ts_us[head & DLL_RX_QUEUE_MASK] = ts_us;
+    iolink_atomic_store_u32(&ctx->rx_q_head, head + 1U);
+    return true;
+}
+#endif
+
 void iolink_dll_init(iolink_dll_ctx_t* ctx, const iolink_phy_api_t* phy)
 {
     if ((phy == NULL) || (!iolink_ctx_zero(ctx, sizeof(iolink_dll_ctx_t)))) {
@@ -222,6 +639,7 @@ void iolink_dll_init(iolink_dll_ctx_t* ctx, const iolink_phy_api_t* phy)
     }
     ctx->state = IOLINK_DLL_STATE_STARTUP;
     ctx->phy = phy;
+    ctx->pass_us = iolink_time_get_us(); /* Reference for deadlines before the first pass */
     ctx->enforce_timing = (IOLINK_TIMING_ENFORCE_DEFAULT != 0U);
     ctx->sio_fallback_threshold = 3U;
 
@@ -238,6 +656,8 @@ void iolink_dll_init(iolink_dll_ctx_t* ctx, const iolink_phy_api_t* phy)
     ctx->pd_in_len_max = ctx->pd_in_len;
     ctx->pd_out_len_max = ctx->pd_out_len;
     ctx->pd_valid = true;
+    iolink_pd_buffer_init(&ctx->pd_in);
+    iolink_pd_buffer_init(&ctx->pd_out);
 
     ctx->baudrate = IOLINK_BAUDRATE_COM2;
     if (ctx->phy->set_baudrate != NULL) {
@@ -248,6 +668,7 @@ void iolink_dll_init(iolink_dll_ctx_t* ctx, const iolink_phy_api_t* phy)
     iolink_isdu_init(&ctx->isdu);
     iolink_ds_init(&ctx->ds, NULL);
     ctx->isdu.event_ctx = &ctx->events;
+    ctx->isdu.ds_ctx = &ctx->ds;
     ctx->isdu.dll_ctx = ctx;
 
     ctx->t_ren_limit_us = dll_get_t_ren_limit_us(ctx);
@@ -267,193 +688,122 @@ void iolink_dll_process(iolink_dll_ctx_t* ctx)
 
     dll_poll_diagnostics(ctx);
 
-    uint32_t now_ms = iolink_time_get_ms();
-    if ((ctx->last_activity_ms != 0U) && (now_ms - ctx->last_activity_ms > 1000U)) {
-        ctx->last_activity_ms = 0U; /* Prevent repeated resets */
+    /* One clock read per pass; bytes without a PHY timestamp inherit it */
+    ctx->pass_us = iolink_time_get_us();
+    DLL_ISR_LOCK();
+    if (dll_timer_due(ctx, IOLINK_DLL_TIMER_ACTIVITY, ctx->pass_us)) {
+        dll_timer_disarm(ctx, IOLINK_DLL_TIMER_ACTIVITY); /* Prevent repeated resets */
+        IOLINK_LOG_INFO("DLL: no master activity, back to STARTUP");
         if (ctx->phy_mode != IOLINK_PHY_MODE_SIO) {
             iolink_dll_set_baudrate(ctx, IOLINK_BAUDRATE_COM1);
             iolink_dll_set_sio_mode(ctx);
         }
         ctx->state = IOLINK_DLL_STATE_STARTUP;
         ctx->frame_index = 0U;
+        ctx->cycle_start_valid = false; /* A restart is not a cycle */
     }
+#if IOLINK_DLL_RX_ISR
+    if (ctx->fallback_pending) {
+        ctx->fallback_pending = false;
+        dll_sio_fallback(ctx);
+    }
+#endif
+    DLL_ISR_UNLOCK();
 
     if (dll_t_pd_active(ctx)) {
         if (dll_drain_rx(ctx)) {
+            DLL_ISR_LOCK();
             ctx->timing_errors++;
             ctx->t_pd_violations++;
+            DLL_ISR_UNLOCK();
             iolink_event_trigger(&ctx->events, IOLINK_EVENT_COMM_TIMING, IOLINK_EVENT_TYPE_WARNING);
         }
         return;
     }
 
     if (ctx->phy_mode == IOLINK_PHY_MODE_SIO) {
+#if IOLINK_DLL_RX_ISR
+        /* No framing in SIO mode; drop what the ISR queued */
+        iolink_atomic_store_u32(&ctx->rx_q_tail, iolink_atomic_load_u32(&ctx->rx_q_head));
+#endif
         if ((ctx->frame_index == 0U) && (ctx->phy->detect_wakeup != NULL)) {
             if (ctx->phy->detect_wakeup() > 0) {
                 ctx->wakeup_seen = true;
                 ctx->state = IOLINK_DLL_STATE_AWAITING_COMM;
-                ctx->wakeup_deadline_us = iolink_time_get_us() + IOLINK_T_DWU_US;
+                dll_timer_arm(ctx, IOLINK_DLL_TIMER_WAKEUP, ctx->pass_us + IOLINK_T_DWU_US);
                 iolink_dll_set_sdci_mode(ctx);
             }
         }
         return;
     }
 
-    if ((ctx->frame_index > 0U) && (ctx->enforce_timing) && (ctx->t_byte_limit_us > 0U)) {
-        if (ctx->last_byte_us != 0U) {
-            uint64_t now_us = iolink_time_get_us();
-            if (now_us - ctx->last_byte_us > (uint64_t) ctx->t_byte_limit_us) {
-                ctx->timing_errors++;
-                ctx->t_byte_violations++;
-                ctx->framing_errors++;
-                iolink_event_trigger(&ctx->events, IOLINK_EVENT_COMM_TIMING,
-                                     IOLINK_EVENT_TYPE_WARNING);
-                ctx->frame_index = 0U;
-                dll_enter_fallback(ctx);
-            }
+    DLL_ISR_LOCK();
+    if (dll_timer_due(ctx, IOLINK_DLL_TIMER_T_BYTE, ctx->pass_us)) {
+        dll_timer_disarm(ctx, IOLINK_DLL_TIMER_T_BYTE);
+        if ((ctx->frame_index > 0U) && ctx->enforce_timing) {
+            ctx->timing_errors++;
+            ctx->t_byte_violations++;
+            ctx->framing_errors++;
+            iolink_event_trigger(&ctx->events, IOLINK_EVENT_COMM_TIMING, IOLINK_EVENT_TYPE_WARNING);
+            ctx->frame_index = 0U;
+            dll_enter_fallback(ctx);
         }
     }
+    DLL_ISR_UNLOCK();
 
-    if ((ctx->state == IOLINK_DLL_STATE_AWAITING_COMM) && (ctx->enforce_timing)) {
-        if ((ctx->wakeup_deadline_us != 0U) && (iolink_time_get_us() < ctx->wakeup_deadline_us)) {
-            return;
-        }
+    if (dll_timer_due(ctx, IOLINK_DLL_TIMER_WAKEUP, ctx->pass_us)) {
+        dll_timer_disarm(ctx, IOLINK_DLL_TIMER_WAKEUP);
+    }
+    if ((ctx->state == IOLINK_DLL_STATE_AWAITING_COMM) && (ctx->enforce_timing) &&
+        dll_timer_armed(ctx, IOLINK_DLL_TIMER_WAKEUP)) {
+        return;
     }
 
-    uint8_t byte;
-    while ((ctx->phy->recv_byte != NULL) && (ctx->phy->recv_byte(&byte) > 0)) {
-        uint64_t now_us = iolink_time_get_us();
-        ctx->last_activity_ms = iolink_time_get_ms();
-        if ((ctx->frame_index > 0U) && (ctx->enforce_timing) && (ctx->t_byte_limit_us > 0U)) {
-            if (ctx->last_byte_us != 0U) {
-                if (now_us - ctx->last_byte_us > (uint64_t) ctx->t_byte_limit_us) {
-                    ctx->timing_errors++;
-                    ctx->t_byte_violations++;
-                    ctx->framing_errors++;
-                    iolink_event_trigger(&ctx->events, IOLINK_EVENT_COMM_TIMING,
-                                         IOLINK_EVENT_TYPE_WARNING);
-                    ctx->frame_index = 0U;
-                }
-            }
+#if IOLINK_DLL_RX_ISR
+    /* Bytes only come from iolink_dll_rx_isr(); the PHY recv hooks are not used.
+     * The ISR owns the reply frame and prearms it on the first request byte. */
+    dll_rx_queue_process(ctx);
+#else
+    /* Build the reply ahead of the next request while the line is idle */
+    if ((ctx->state == IOLINK_DLL_STATE_OPERATE) || (ctx->state == IOLINK_DLL_STATE_ESTAB_COM)) {
+        dll_prearm_response(ctx);
+    }
+
+    bool received = false;
+    if (ctx->phy->recv_byte_ts != NULL) {
+        /* Timestamped path: PHY reports each byte's capture time */
+        uint8_t byte;
+        iolink_usec_t ts_us;
+        while (ctx->phy->recv_byte_ts(&byte, &ts_us) > 0) {
+            received = true;
+            dll_rx_byte(ctx, byte, ts_us);
         }
-        ctx->last_byte_us = now_us;
-
-        if (ctx->frame_index == 0U) {
-            ctx->frame_buf[0] = byte;
-            ctx->frame_index = 1U;
-            ctx->last_frame_us = now_us;
-
-            if (ctx->baudrate == IOLINK_BAUDRATE_COM1) {
-                ctx->req_len = 2U;
-            }
-            else {
-                bool can_be_multi = (ctx->m_seq_type != IOLINK_M_SEQ_TYPE_0);
-                if (can_be_multi && (ctx->state == IOLINK_DLL_STATE_OPERATE)) {
-                    ctx->req_len = (uint8_t) (IOLINK_M_SEQ_HEADER_LEN + ctx->pd_out_len_current +
-                                              ctx->od_len + 1U);
-                }
-                else if (can_be_multi && (ctx->state == IOLINK_DLL_STATE_ESTAB_COM) &&
-                         (byte != IOLINK_MC_TRANSITION_COMMAND)) {
-                    /* Initial Type 1/2 frame to move from ESTAB_COM to OPERATE.
-                     * Any non-Type0 command (MC starting with 00) is a Type 1/2 frame. */
-                    ctx->req_len = (uint8_t) (IOLINK_M_SEQ_HEADER_LEN + ctx->pd_out_len_current +
-                                              ctx->od_len + 1U);
-                }
-                else {
-                    ctx->req_len = 2U;
-                }
+    }
+    else if (ctx->phy->recv_buf != NULL) {
+        /* Burst path: one PHY call per burst */
+        uint8_t burst[sizeof(ctx->frame_buf)];
+        int n;
+        while ((n = ctx->phy->recv_buf(burst, sizeof(burst))) > 0) {
+            received = true;
+            for (int i = 0; i < n; i++) {
+                dll_rx_byte(ctx, burst[i], ctx->pass_us);
             }
         }
-        else {
-            if (ctx->frame_index < sizeof(ctx->frame_buf)) {
-                ctx->frame_buf[ctx->frame_index++] = byte;
-            }
-            else {
-                ctx->frame_index = 0U;
-                ctx->framing_errors++;
-            }
+    }
+    else {
+        uint8_t byte;
+        while ((ctx->phy->recv_byte != NULL) && (ctx->phy->recv_byte(&byte) > 0)) {
+            received = true;
+            dll_rx_byte(ctx, byte, ctx->pass_us);
         }
+    }
 
-        if ((ctx->frame_index > 0U) && (ctx->frame_index >= ctx->req_len)) {
-            uint64_t now_us_proc = iolink_time_get_us();
-            if ((ctx->enforce_timing) && (ctx->min_cycle_time_us > 0U) &&
-                (ctx->last_cycle_start_us != 0U)) {
-                if (now_us_proc - ctx->last_cycle_start_us < (uint64_t) ctx->min_cycle_time_us) {
-                    ctx->timing_errors++;
-                    ctx->t_cycle_violations++;
-                    iolink_event_trigger(&ctx->events, IOLINK_EVENT_COMM_TIMING,
-                                         IOLINK_EVENT_TYPE_WARNING);
-                }
-            }
-            ctx->last_cycle_start_us = now_us_proc;
-
-            bool crc_ok;
-            if (ctx->req_len == 2U) {
-                crc_ok = (iolink_checksum_ck(ctx->frame_buf[0], 0U) == ctx->frame_buf[1]);
-            }
-            else {
-                crc_ok = (iolink_crc6(ctx->frame_buf, (uint8_t) (ctx->req_len - 1)) ==
-                          ctx->frame_buf[ctx->req_len - 1]);
-            }
-
-            if (crc_ok) {
-                if ((ctx->state == IOLINK_DLL_STATE_AWAITING_COMM) ||
-                    (ctx->state == IOLINK_DLL_STATE_STARTUP)) {
-                    ctx->state = IOLINK_DLL_STATE_PREOPERATE;
-                }
-
-                if (ctx->state == IOLINK_DLL_STATE_PREOPERATE) {
-                    if (ctx->req_len == 2U) {
-                        if (ctx->frame_buf[0] == IOLINK_MC_TRANSITION_COMMAND)
-                            dll_handle_preoperate(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
-                        else
-                            dll_handle_operate_type0(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
-                    }
-                }
-                else if (ctx->state == IOLINK_DLL_STATE_ESTAB_COM) {
-                    if (ctx->req_len > 2U) {
-                        uint8_t channel = ctx->frame_buf[0] & 0x60U;
-                        if (channel == 0x20U || channel == 0x60U) {
-                            ctx->framing_errors++;
-                            dll_enter_fallback(ctx);
-                        }
-                        else {
-                            ctx->state = IOLINK_DLL_STATE_OPERATE;
-                            dll_handle_operate_type1_2(ctx);
-                        }
-                    }
-                    else if (ctx->frame_buf[0] == IOLINK_MC_TRANSITION_COMMAND) {
-                        dll_handle_preoperate(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
-                    }
-                    else {
-                        dll_handle_operate_type0(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
-                    }
-                }
-                else if (ctx->state == IOLINK_DLL_STATE_OPERATE) {
-                    uint8_t channel = ctx->frame_buf[0] & 0x60U;
-                    /* Transitions forbidden. Page Address (0x20) and Reserved (0x60) channels
-                     * rejected. */
-                    if (ctx->frame_buf[0] == IOLINK_MC_TRANSITION_COMMAND || channel == 0x20U ||
-                        channel == 0x60U) {
-                        ctx->framing_errors++;
-                        dll_enter_fallback(ctx);
-                    }
-                    else if (ctx->req_len == 2U) {
-                        dll_handle_operate_type0(ctx, ctx->frame_buf[0], ctx->frame_buf[1]);
-                    }
-                    else {
-                        dll_handle_operate_type1_2(ctx);
-                    }
-                }
-            }
-            else {
-                ctx->crc_errors++;
-                ctx->framing_errors++;
-                dll_enter_fallback(ctx);
-            }
-            ctx->frame_index = 0U;
-        }
+    /* Deadlines follow the pass, not every byte */
+    if (received) {
+        dll_arm_activity(ctx, ctx->pass_us);
+        dll_arm_t_byte(ctx);
     }
+#endif
 }
 
 iolink_dll_state_t iolink_dll_get_state(const iolink_dll_ctx_t* ctx)
@@ -481,13 +831,39 @@ int iolink_dll_set_baudrate(iolink_dll_ctx_t* ctx, iolink_baudrate_t baudrate)
     return 0;
 }
 
+bool iolink_dll_link_supported(uint8_t m_seq_type, uint8_t pd_in_len, uint8_t pd_out_len)
+{
+    if ((m_seq_type > (uint8_t) IOLINK_M_SEQ_TYPE_2_V) || (pd_in_len > IOLINK_PD_IN_MAX_SIZE) ||
+        (pd_out_len > IOLINK_PD_OUT_MAX_SIZE)) {
+        return false;
+    }
+#ifdef IOLINK_FIXED_M_SEQ_TYPE
+    if (m_seq_type != DLL_M_SEQ_TYPE(NULL)) {
+        return false;
+    }
+#endif
+#ifdef IOLINK_FIXED_PD_IN_LEN
+    if (pd_in_len != DLL_PD_IN_LEN(NULL)) {
+        return false;
+    }
+#endif
+#ifdef IOLINK_FIXED_PD_OUT_LEN
+    if (pd_out_len != DLL_PD_OUT_LEN(NULL)) {
+        return false;
+    }
+#endif
+    return true;
+}
+
 int iolink_dll_set_pd_length(iolink_dll_ctx_t* ctx, uint8_t pd_in_len, uint8_t pd_out_len)
 {
-    if ((ctx == NULL) || (pd_in_len > IOLINK_PD_IN_MAX_SIZE) ||
-        (pd_out_len > IOLINK_PD_OUT_MAX_SIZE))
+    if ((ctx == NULL) || !iolink_dll_link_supported(ctx->m_seq_type, pd_in_len, pd_out_len))
         return -1;
+    DLL_ISR_LOCK(); /* The ISR may be building a reply from them */
     ctx->pd_in_len_current = pd_in_len;
     ctx->pd_out_len_current = pd_out_len;
+    ctx->tx_armed = false;
+    DLL_ISR_UNLOCK();
     return 0;
 }
 
@@ -528,6 +904,13 @@ void iolink_dll_get_stats(const iolink_dll_ctx_t* ctx, iolink_dll_stats_t* out_s
     out_stats->total_retries = ctx->total_retries;
     out_stats->voltage_faults = ctx->voltage_faults;
     out_stats->short_circuits = ctx->short_circuits;
+    out_stats->event_drops = iolink_events_dropped(&ctx->events);
+    out_stats->events_coalesced = iolink_events_coalesced(&ctx->events);
+#if IOLINK_DLL_RX_ISR
+    out_stats->rx_queue_drops = iolink_atomic_load_u32(&ctx->rx_q_drops);
+#else
+    out_stats->rx_queue_drops = 0U;
+#endif
 }
 
 void iolink_dll_set_timing_enforcement(iolink_dll_ctx_t* ctx, bool enable)
@@ -535,9 +918,83 @@ void iolink_dll_set_timing_enforcement(iolink_dll_ctx_t* ctx, bool enable)
     if (ctx != NULL) ctx->enforce_timing = enable;
 }
 
+void iolink_dll_set_t_pd_delay(iolink_dll_ctx_t* ctx, uint32_t delay_us)
+{
+    if (ctx == NULL) return;
+    ctx->t_pd_delay_us = delay_us;
+    if (delay_us > 0U) {
+        dll_timer_arm(ctx, IOLINK_DLL_TIMER_T_PD, iolink_time_get_us() + (iolink_usec_t) delay_us);
+    }
+    else {
+        dll_timer_disarm(ctx, IOLINK_DLL_TIMER_T_PD);
+    }
+}
+
 void iolink_dll_set_t_ren_limit_us(iolink_dll_ctx_t* ctx, uint32_t limit_us)
 {
     if (ctx == NULL) return;
     ctx->t_ren_limit_us = limit_us;
     ctx->t_ren_override = (limit_us != 0U);
 }
+
+int iolink_dll_get_latency_histogram(const iolink_dll_ctx_t* ctx, iolink_latency_kind_t kind,
+                                     iolink_latency_hist_t* out_hist)
+{
+    if ((ctx == NULL) || (out_hist == NULL) || (kind >= IOLINK_LATENCY_KIND_COUNT)) {
+        return -1;
+    }
+    *out_hist = ctx->latency[kind];
+    return 0;
+}
+
+void iolink_dll_reset_latency_histograms(iolink_dll_ctx_t* ctx)
+{
+    if (ctx == NULL) return;
+    for (uint8_t i = 0U; i < IOLINK_LATENCY_KIND_COUNT; i++) {
+        iolink_latency_hist_reset(&ctx->latency[i]);
+    }
+}
+
+void iolink_dll_trace_attach(iolink_dll_ctx_t* ctx, iolink_trace_ring_t* ring)
+{
+    if (ctx != NULL) ctx->trace = ring;
+}
+
+bool iolink_dll_next_deadline(const iolink_dll_ctx_t* ctx, iolink_usec_t* deadline_us)
+{
+    if ((ctx == NULL) || (deadline_us == NULL)) {
+        return false;
+    }
+
+    bool have = false;
+    iolink_usec_t best = 0U;
+    DLL_ISR_LOCK();
+    if ((ctx->phy_mode == IOLINK_PHY_MODE_SIO) && (ctx->phy != NULL) &&
+        (ctx->phy->detect_wakeup != NULL)) {
+        best = ctx->pass_us + IOLINK_WAKEUP_POLL_US; /* Wake-up is only seen by polling */
+        have = true;
+    }
+    if (ctx->isdu.state == ISDU_STATE_SERVICE_EXECUTE) {
+        best = ctx->pass_us; /* Dispatched on the next pass */
+        have = true;
+    }
+#if IOLINK_DLL_RX_ISR
+    if ((ctx->rx_q_head != ctx->rx_q_tail) || ctx->fallback_pending) {
+        best = ctx->pass_us; /* Queued bytes or a fallback wait for the next pass */
+        have = true;
+    }
+#endif
+    for (uint8_t timer = 0U; timer < IOLINK_DLL_TIMER_COUNT; timer++) {
+        if (dll_timer_armed(ctx, (iolink_dll_timer_t) timer) &&
+            (!have || iolink_usec_before(ctx->timer_due_us[timer], best))) {
+            best = ctx->timer_due_us[timer];
+            have = true;
+        }
+    }
+    DLL_ISR_UNLOCK();
+
+    if (have) {
+        *deadline_us = best;
+    }
+    return have;
+}
@@ -9,17 +9,75 @@
 /**
  * @file events.c
  * @brief IO-Link Event Handling
+ *
+ * Bounded MPMC ring (Vyukov) used with a single consumer. Each cell carries a
+ * sequence number: seq == pos means free for the producer claiming pos,
+ * seq == pos + 1 means published for the consumer at pos.
  */
 
 #include "iolinki/events.h"
-#include "iolinki/platform.h"
+#include "iolinki/atomic.h"
 #include "iolinki/utils.h"
 
+#define EVENT_MASK ((uint32_t) IOLINK_EVENT_QUEUE_SIZE - 1U)
+
+#define EVENT_COUNT_MASK 0x3FFFU
+#define EVENT_TYPE_SHIFT 14U
+#define EVENT_CODE_SHIFT 16U
+#define EVENT_KEY_MASK (~(uint32_t) EVENT_COUNT_MASK)
+
+static inline uint32_t event_pack(uint16_t code, iolink_event_type_t type, uint32_t count)
+{
+    return ((uint32_t) code << EVENT_CODE_SHIFT) |
+           (((uint32_t) type & 0x03U) << EVENT_TYPE_SHIFT) | (count & EVENT_COUNT_MASK);
+}
+
+static inline void event_unpack(uint32_t entry, iolink_event_t* event)
+{
+    event->code = (uint16_t) (entry >> EVENT_CODE_SHIFT);
+    event->type = (iolink_event_type_t) ((entry >> EVENT_TYPE_SHIFT) & 0x03U);
+    event->occurrences = (uint16_t) (entry & EVENT_COUNT_MASK);
+}
+
+/**
+ * @brief Merge into a queued entry with the same code and type
+ *
+ * A cell is only matched while its count is non-zero; the consumer swaps the entry
+ * to zero when it takes it, so a late increment fails its CAS instead of being lost.
+ */
+static bool event_coalesce(iolink_events_ctx_t* ctx, uint32_t key)
+{
+    for (uint32_t i = 0U; i < IOLINK_EVENT_QUEUE_SIZE; i++) {
+        volatile uint32_t* entry = &ctx->cells[i].entry;
+        uint32_t cur = iolink_atomic_load_u32(entry);
+        while (((cur & EVENT_KEY_MASK) == key) && ((cur & EVENT_COUNT_MASK) != 0U) &&
+               ((cur & EVENT_COUNT_MASK) < IOLINK_EVENT_MAX_OCCURRENCES)) {
+            if (iolink_atomic_cas_u32(entry, &cur, cur + 1U)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool event_head(const iolink_events_ctx_t* ctx, uint32_t pos, uint32_t* entry)
+{
+    const iolink_event_cell_t* cell = &ctx->cells[pos & EVENT_MASK];
+    if (iolink_atomic_load_u32(&cell->seq) != (pos + 1U)) {
+        return false;
+    }
+    *entry = iolink_atomic_load_u32(&cell->entry);
+    return true;
+}
+
 void iolink_events_init(iolink_events_ctx_t* ctx)
 {
     if (!iolink_ctx_zero(ctx, sizeof(iolink_events_ctx_t))) {
         return;
     }
+    for (uint32_t i = 0U; i < IOLINK_EVENT_QUEUE_SIZE; i++) {
+        ctx->cells[i].seq = i;
+    }
 }
 
 void iolink_event_trigger(iolink_events_ctx_t* ctx, uint16_t code, iolink_event_type_t type)
@@ -28,26 +86,50 @@ void iolink_event_trigger(iolink_events_ctx_t* ctx, uint16_t code, iolink_event_
         return;
     }
 
-    iolink_critical_enter();
+    uint32_t key = event_pack(code, type, 0U);
+    if (event_coalesce(ctx, key)) {
+        (void) iolink_atomic_add_u32(&ctx->coalesced, 1U);
+        return;
+    }
 
-    if (ctx->count >= IOLINK_EVENT_QUEUE_SIZE) {
-        /* Drop oldest (inline to avoid recursive lock) */
-        ctx->head = (uint8_t) ((ctx->head + 1U) % IOLINK_EVENT_QUEUE_SIZE);
-        ctx->count--;
+    uint32_t pos = iolink_atomic_load_u32(&ctx->enqueue_pos);
+    iolink_event_cell_t* cell;
+    for (;;) {
+        cell = &ctx->cells[pos & EVENT_MASK];
+        int32_t diff = (int32_t) (iolink_atomic_load_u32(&cell->seq) - pos);
+        if (diff == 0) {
+            if (iolink_atomic_cas_u32(&ctx->enqueue_pos, &pos, pos + 1U)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            /* Full: keep what is queued, count the loss */
+            (void) iolink_atomic_add_u32(&ctx->dropped, 1U);
+            return;
+        }
+        else {
+            pos = iolink_atomic_load_u32(&ctx->enqueue_pos);
+        }
     }
 
-    ctx->queue[ctx->tail].code = code;
-    ctx->queue[ctx->tail].type = type;
-    ctx->tail = (uint8_t) ((ctx->tail + 1U) % IOLINK_EVENT_QUEUE_SIZE);
-    ctx->count++;
+    iolink_atomic_store_u32(&cell->entry, key | 1U);
+    iolink_atomic_store_u32(&cell->seq, pos + 1U);
+}
+
+uint32_t iolink_events_dropped(const iolink_events_ctx_t* ctx)
+{
+    return (ctx != NULL) ? iolink_atomic_load_u32(&ctx->dropped) : 0U;
+}
 
-    iolink_critical_exit();
+uint32_t iolink_events_coalesced(const iolink_events_ctx_t* ctx)
+{
+    return (ctx != NULL) ? iolink_atomic_load_u32(&ctx->coalesced) : 0U;
 }
 
 bool iolink_events_pending(const iolink_events_ctx_t* ctx)
 {
-    /* Single byte read is typically atomic, avoiding lock for perf */
-    return ((ctx != NULL) && (ctx->count > 0U));
+    uint32_t entry;
+    return ((ctx != NULL) && event_head(ctx, ctx->dequeue_pos, &entry));
 }
 
 bool iolink_events_pop(iolink_events_ctx_t* ctx, iolink_event_t* event)
@@ -56,18 +138,17 @@ bool iolink_events_pop(iolink_events_ctx_t* ctx, iolink_event_t* event)
         return false;
     }
 
-    bool ret = false;
-    iolink_critical_enter();
-
-    if (ctx->count > 0U) {
-        *event = ctx->queue[ctx->head];
-        ctx->head = (uint8_t) ((ctx->head + 1U) % IOLINK_EVENT_QUEUE_SIZE);
-        ctx->count--;
-        ret = true;
+    uint32_t pos = ctx->dequeue_pos;
+    iolink_event_cell_t* cell = &ctx->cells[pos & EVENT_MASK];
+    if (iolink_atomic_load_u32(&cell->seq) != (pos + 1U)) {
+        return false;
     }
 
-    iolink_critical_exit();
-    return ret;
+    /* Swap to zero so concurrent coalescers stop matching this cell */
+    event_unpack(iolink_atomic_exchange_u32(&cell->entry, 0U), event);
+    iolink_atomic_store_u32(&cell->seq, pos + IOLINK_EVENT_QUEUE_SIZE);
+    ctx->dequeue_pos = pos + 1U;
+    return true;
 }
 
 bool iolink_events_peek(const iolink_events_ctx_t* ctx, iolink_event_t* event)
@@ -76,33 +157,28 @@ bool iolink_events_peek(const iolink_events_ctx_t* ctx, iolink_event_t* event)
         return false;
     }
 
-    /* Single read is atomic for small structs, but use critical section for safety */
-    iolink_critical_enter();
-
-    bool ret = false;
-    if (ctx->count > 0U) {
-        *event = ctx->queue[ctx->head];
-        ret = true;
+    uint32_t entry;
+    if (!event_head(ctx, ctx->dequeue_pos, &entry)) {
+        return false;
     }
-
-    iolink_critical_exit();
-    return ret;
+    event_unpack(entry, event);
+    return true;
 }
 
 uint8_t iolink_events_get_highest_severity(iolink_events_ctx_t* ctx)
 {
-    if ((ctx == NULL) || (ctx->count == 0U)) {
+    if (ctx == NULL) {
         return 0U; /* OK */
     }
 
     uint8_t highest_msp = 0U;
-    iolink_critical_enter();
-    for (uint8_t i = 0U; i < ctx->count; i++) {
-        uint8_t idx = (uint8_t) ((ctx->head + i) % IOLINK_EVENT_QUEUE_SIZE);
-        iolink_event_type_t type = ctx->queue[idx].type;
+    uint32_t entry;
+    for (uint32_t pos = ctx->dequeue_pos; event_head(ctx, pos, &entry); pos++) {
+        iolink_event_t ev;
+        event_unpack(entry, &ev);
 
         uint8_t severity = 0U;
-        switch (type) {
+        switch (ev.type) {
             case IOLINK_EVENT_TYPE_NOTIFICATION:
                 severity = 1U;
                 break; /* Maintenance */
@@ -121,7 +197,6 @@ uint8_t iolink_events_get_highest_severity(iolink_events_ctx_t* ctx)
             highest_msp = severity;
         }
     }
-    iolink_critical_exit();
     return highest_msp;
 }
 
@@ -133,15 +208,12 @@ uint8_t iolink_events_get_all(iolink_events_ctx_t* ctx, iolink_event_t* out_even
     }
 
     uint8_t copied = 0U;
-    iolink_critical_enter();
-    uint8_t count = ctx->count;
-    uint8_t to_copy = (count < max_count) ? count : max_count;
-
-    for (uint8_t i = 0U; i < to_copy; i++) {
-        uint8_t idx = (uint8_t) ((ctx->head + i) % IOLINK_EVENT_QUEUE_SIZE);
-        out_events[i] = ctx->queue[idx];
+    uint32_t entry;
+    uint32_t pos = ctx->dequeue_pos;
+    while ((copied < max_count) && event_head(ctx, pos, &entry)) {
+        event_unpack(entry, &out_events[copied]);
         copied++;
+        pos++;
     }
-    iolink_critical_exit();
     return copied;
 }
@@ -15,23 +15,29 @@
 #include "iolinki/time_utils.h"
 #include <string.h>
 
-static iolink_dll_ctx_t g_dll_ctx;
-static iolink_config_t g_config;
+static iolink_instance_t g_instance;
 
-int iolink_init(const iolink_phy_api_t* phy, const iolink_config_t* config)
+int iolink_instance_init(iolink_instance_t* inst, const iolink_phy_api_t* phy,
+                         const iolink_config_t* config)
 {
-    if (phy == NULL) {
+    if ((inst == NULL) || (phy == NULL)) {
         return -1;
     }
 
+    iolink_config_t* cfg = &inst->config;
+    iolink_dll_ctx_t* dll = &inst->dll;
+
     if (config != NULL) {
-        (void) memcpy(&g_config, config, sizeof(iolink_config_t));
+        (void) memcpy(cfg, config, sizeof(iolink_config_t));
     }
     else {
         /* Default config */
-        (void) memset(&g_config, 0, sizeof(iolink_config_t));
-        g_config.m_seq_type = IOLINK_M_SEQ_TYPE_0;
-        g_config.min_cycle_time = 0U; /* Min */
+        (void) memset(cfg, 0, sizeof(iolink_config_t));
+        cfg->m_seq_type = IOLINK_M_SEQ_TYPE_0;
+        cfg->min_cycle_time = 0U; /* Min */
+    }
+    if (!iolink_dll_link_supported((uint8_t) cfg->m_seq_type, cfg->pd_in_len, cfg->pd_out_len)) {
+        return -1;
     }
 
     if (phy->init != NULL) {
@@ -41,136 +47,194 @@ int iolink_init(const iolink_phy_api_t* phy, const iolink_config_t* config)
         }
     }
 
-    iolink_dll_init(&g_dll_ctx, phy);
-    iolink_params_init();
-    g_dll_ctx.m_seq_type = (uint8_t) g_config.m_seq_type;
-    g_dll_ctx.pd_in_len = g_config.pd_in_len;
-    g_dll_ctx.pd_out_len = g_config.pd_out_len;
-    g_dll_ctx.min_cycle_time_us = (uint32_t) g_config.min_cycle_time * 100U; /* 0.1ms units */
-    g_dll_ctx.t_pd_delay_us = g_config.t_pd_us;
-    if (g_dll_ctx.t_pd_delay_us > 0U) {
-        g_dll_ctx.t_pd_deadline_us = iolink_time_get_us() + (uint64_t) g_dll_ctx.t_pd_delay_us;
-    }
-    else {
-        g_dll_ctx.t_pd_deadline_us = 0U;
-    }
+    iolink_dll_init(dll, phy);
+    iolink_params_init_once();
+    dll->m_seq_type = (uint8_t) cfg->m_seq_type;
+    dll->pd_in_len = cfg->pd_in_len;
+    dll->pd_out_len = cfg->pd_out_len;
+    dll->min_cycle_time_us = (uint32_t) cfg->min_cycle_time * 100U; /* 0.1ms units */
+    iolink_dll_set_t_pd_delay(dll, cfg->t_pd_us);
 
     /* Apply config-dependent DLL fields (must run after m_seq_type is set) */
-    if ((g_dll_ctx.m_seq_type == IOLINK_M_SEQ_TYPE_2_1) ||
-        g_dll_ctx.m_seq_type == IOLINK_M_SEQ_TYPE_2_2 ||
-        g_dll_ctx.m_seq_type == IOLINK_M_SEQ_TYPE_2_V) {
-        g_dll_ctx.od_len = 2U;
+    if ((dll->m_seq_type == IOLINK_M_SEQ_TYPE_2_1) || dll->m_seq_type == IOLINK_M_SEQ_TYPE_2_2 ||
+        dll->m_seq_type == IOLINK_M_SEQ_TYPE_2_V) {
+        dll->od_len = 2U;
     }
     else {
-        g_dll_ctx.od_len = 1U;
+        dll->od_len = 1U;
     }
 
-    if ((g_dll_ctx.m_seq_type == IOLINK_M_SEQ_TYPE_1_V) ||
-        g_dll_ctx.m_seq_type == IOLINK_M_SEQ_TYPE_2_V) {
-        g_dll_ctx.pd_in_len_current = g_dll_ctx.pd_in_len;
-        g_dll_ctx.pd_out_len_current = g_dll_ctx.pd_out_len;
-        g_dll_ctx.pd_in_len_max = g_dll_ctx.pd_in_len;
-        g_dll_ctx.pd_out_len_max = g_dll_ctx.pd_out_len;
-    }
-    else {
-        g_dll_ctx.pd_in_len_current = g_dll_ctx.pd_in_len;
-        g_dll_ctx.pd_out_len_current = g_dll_ctx.pd_out_len;
-        g_dll_ctx.pd_in_len_max = g_dll_ctx.pd_in_len;
-        g_dll_ctx.pd_out_len_max = g_dll_ctx.pd_out_len;
-    }
+    dll->pd_in_len_current = dll->pd_in_len;
+    dll->pd_out_len_current = dll->pd_out_len;
+    dll->pd_in_len_max = dll->pd_in_len;
+    dll->pd_out_len_max = dll->pd_out_len;
 
     return 0;
 }
 
-void iolink_process(void)
+void iolink_instance_process(iolink_instance_t* inst)
 {
-    iolink_dll_process(&g_dll_ctx);
+    if (inst == NULL) {
+        return;
+    }
+    iolink_dll_process(&inst->dll);
 }
 
-int iolink_pd_input_update(const uint8_t* data, size_t len, bool valid)
+int iolink_instance_pd_input_update(iolink_instance_t* inst, const uint8_t* data, size_t len,
+                                    bool valid)
 {
-    if (data == NULL) {
+    if ((inst == NULL) || (data == NULL)) {
         return -1;
     }
-    if (len > sizeof(g_dll_ctx.pd_in)) {
+    if (len > IOLINK_PD_IN_MAX_SIZE) {
         return -1;
     }
 
-    iolink_critical_enter();
-    (void) memcpy(g_dll_ctx.pd_in, data, len);
-    g_dll_ctx.pd_in_len = (uint8_t) len;
-    g_dll_ctx.pd_valid = valid;
-    g_dll_ctx.pd_in_toggle = !g_dll_ctx.pd_in_toggle;
-    iolink_critical_exit();
+    /* Single producer: fill the private slot, then hand it over in one atomic step */
+    iolink_pd_slot_t* slot = iolink_pd_buffer_write_slot(&inst->dll.pd_in);
+    (void) memcpy(slot->data, data, len);
+    slot->len = (uint8_t) len;
+    slot->valid = valid;
+    iolink_pd_buffer_publish(&inst->dll.pd_in);
 
     return 0;
 }
 
-int iolink_pd_output_read(uint8_t* data, size_t len)
+int iolink_instance_pd_output_read(iolink_instance_t* inst, uint8_t* data, size_t len)
 {
-    if (data == NULL) {
+    if ((inst == NULL) || (data == NULL)) {
         return -1;
     }
+    iolink_dll_ctx_t* dll = &inst->dll;
 
-    iolink_critical_enter();
-    uint8_t read_len = (len < g_dll_ctx.pd_out_len) ? (uint8_t) len : g_dll_ctx.pd_out_len;
-    (void) memcpy(data, g_dll_ctx.pd_out, read_len);
-    iolink_critical_exit();
+    (void) iolink_pd_buffer_acquire(&dll->pd_out);
+    uint8_t read_len = (len < dll->pd_out_len) ? (uint8_t) len : dll->pd_out_len;
+    (void) memcpy(data, iolink_pd_buffer_read_slot(&dll->pd_out)->data, read_len);
 
     return (int) read_len;
 }
 
+void iolink_instance_get_stats(const iolink_instance_t* inst, iolink_dll_stats_t* out_stats)
+{
+    if (inst == NULL) {
+        return;
+    }
+    iolink_dll_get_stats(&inst->dll, out_stats);
+}
+
+iolink_events_ctx_t* iolink_instance_get_events_ctx(iolink_instance_t* inst)
+{
+    return (inst != NULL) ? &inst->dll.events : NULL;
+}
+
+iolink_ds_ctx_t* iolink_instance_get_ds_ctx(iolink_instance_t* inst)
+{
+    return (inst != NULL) ? &inst->dll.ds : NULL;
+}
+
+iolink_isdu_ctx_t* iolink_instance_get_isdu_ctx(iolink_instance_t* inst)
+{
+    return (inst != NULL) ? &inst->dll.isdu : NULL;
+}
+
+iolink_dll_state_t iolink_instance_get_state(const iolink_instance_t* inst)
+{
+    return (inst != NULL) ? inst->dll.state : IOLINK_DLL_STATE_STARTUP;
+}
+
+bool iolink_instance_next_deadline_us(const iolink_instance_t* inst, iolink_usec_t* deadline_us)
+{
+    return (inst != NULL) && iolink_dll_next_deadline(&inst->dll, deadline_us);
+}
+
+iolink_instance_t* iolink_get_default_instance(void)
+{
+    return &g_instance;
+}
+
+/* Global API: thin wrappers over the default instance */
+
+int iolink_init(const iolink_phy_api_t* phy, const iolink_config_t* config)
+{
+    return iolink_instance_init(&g_instance, phy, config);
+}
+
+void iolink_process(void)
+{
+    iolink_instance_process(&g_instance);
+}
+
+int iolink_pd_input_update(const uint8_t* data, size_t len, bool valid)
+{
+    return iolink_instance_pd_input_update(&g_instance, data, len, valid);
+}
+
+int iolink_pd_output_read(uint8_t* data, size_t len)
+{
+    return iolink_instance_pd_output_read(&g_instance, data, len);
+}
+
 iolink_events_ctx_t* iolink_get_events_ctx(void)
 {
-    return &g_dll_ctx.events;
+    return iolink_instance_get_events_ctx(&g_instance);
 }
 
 iolink_ds_ctx_t* iolink_get_ds_ctx(void)
 {
-    return &g_dll_ctx.ds;
+    return iolink_instance_get_ds_ctx(&g_instance);
+}
+
+iolink_isdu_ctx_t* iolink_get_isdu_ctx(void)
+{
+    return iolink_instance_get_isdu_ctx(&g_instance);
 }
 
 iolink_dll_state_t iolink_get_state(void)
 {
-    return g_dll_ctx.state;
+    return iolink_instance_get_state(&g_instance);
+}
+
+bool iolink_next_deadline_us(iolink_usec_t* deadline_us)
+{
+    return iolink_instance_next_deadline_us(&g_instance, deadline_us);
 }
 
 iolink_phy_mode_t iolink_get_phy_mode(void)
 {
-    return g_dll_ctx.phy_mode;
+    return g_instance.dll.phy_mode;
 }
 
 iolink_baudrate_t iolink_get_baudrate(void)
 {
-    return g_dll_ctx.baudrate;
+    return g_instance.dll.baudrate;
 }
 
 void iolink_get_dll_stats(iolink_dll_stats_t* out_stats)
 {
-    iolink_dll_get_stats(&g_dll_ctx, out_stats);
+    iolink_instance_get_stats(&g_instance, out_stats);
 }
 
 void iolink_set_timing_enforcement(bool enable)
 {
-    iolink_dll_set_timing_enforcement(&g_dll_ctx, enable);
+    iolink_dll_set_timing_enforcement(&g_instance.dll, enable);
 }
 
 void iolink_set_t_ren_limit_us(uint32_t limit_us)
 {
-    iolink_dll_set_t_ren_limit_us(&g_dll_ctx, limit_us);
+    iolink_dll_set_t_ren_limit_us(&g_instance.dll, limit_us);
 }
 
 iolink_m_seq_type_t iolink_get_m_seq_type(void)
 {
-    return (iolink_m_seq_type_t) g_dll_ctx.m_seq_type;
+    return (iolink_m_seq_type_t) g_instance.dll.m_seq_type;
 }
 
 uint8_t iolink_get_pd_in_len(void)
 {
-    return g_dll_ctx.pd_in_len;
+    return g_instance.dll.pd_in_len;
 }
 
 uint8_t iolink_get_pd_out_len(void)
 {
-    return g_dll_ctx.pd_out_len;
+    return g_instance.dll.pd_out_len;
 }
@@ -16,9 +16,11 @@
 #include "iolinki/data_storage.h"
 #include "iolinki/platform.h"
 #include "iolinki/utils.h"
+#include "iolinki/atomic.h"
+#include "iolinki/log.h"
+#include <limits.h>
 #include <string.h>
 #include <stdint.h>
-#include <stdio.h>
 
 /*
  * IO-Link ISDU Segmentation Engine
@@ -34,13 +36,139 @@
 
 /* Structs moved to header iolink_isdu_ctx_t */
 
+#if IOLINK_ISDU_POOL_BUFFERS > 32
+#error "IOLINK_ISDU_POOL_BUFFERS must not exceed 32"
+#endif
+
+#if IOLINK_ISDU_POOL_BUFFERS > 0
+/* Transfer buffers lent to ISDU contexts, one bit per buffer in use */
+static uint8_t g_isdu_pool[IOLINK_ISDU_POOL_BUFFERS][IOLINK_ISDU_STORAGE_SIZE];
+static volatile uint32_t g_isdu_pool_used;
+static const iolink_isdu_ctx_t* g_isdu_pool_owner[IOLINK_ISDU_POOL_BUFFERS];
+
+static void isdu_pool_put(uint32_t slot)
+{
+    uint32_t bit = 1UL << slot;
+    uint32_t used = iolink_atomic_load_u32(&g_isdu_pool_used);
+    g_isdu_pool_owner[slot] = NULL;
+    while (!iolink_atomic_cas_u32(&g_isdu_pool_used, &used, used & ~bit)) {
+    }
+}
+#endif
+
+static void isdu_attach_storage(iolink_isdu_ctx_t* ctx, uint8_t* storage)
+{
+    ctx->buffer = storage;
+#if IOLINK_ISDU_SINGLE_BUFFER
+    ctx->response_buf = storage;
+#else
+    ctx->response_buf = (storage != NULL) ? &storage[IOLINK_ISDU_BUFFER_SIZE] : NULL;
+#endif
+}
+
+/* Make sure the context has a transfer buffer; only fails if the pool is empty */
+static bool isdu_storage_acquire(iolink_isdu_ctx_t* ctx)
+{
+#if IOLINK_ISDU_POOL_BUFFERS > 0
+    if (ctx->buffer != NULL) {
+        return true;
+    }
+    uint32_t used = iolink_atomic_load_u32(&g_isdu_pool_used);
+    for (;;) {
+        uint32_t slot = 0U;
+        while ((slot < IOLINK_ISDU_POOL_BUFFERS) && ((used & (1UL << slot)) != 0U)) {
+            slot++;
+        }
+        if (slot >= IOLINK_ISDU_POOL_BUFFERS) {
+            return false;
+        }
+        if (iolink_atomic_cas_u32(&g_isdu_pool_used, &used, used | (1UL << slot))) {
+            g_isdu_pool_owner[slot] = ctx;
+            isdu_attach_storage(ctx, g_isdu_pool[slot]);
+            return true;
+        }
+    }
+#else
+    (void) ctx;
+    return true;
+#endif
+}
+
+/* Return a borrowed transfer buffer to the pool (no-op with embedded storage) */
+static void isdu_storage_release(iolink_isdu_ctx_t* ctx)
+{
+#if IOLINK_ISDU_POOL_BUFFERS > 0
+    if (ctx->buffer == NULL) {
+        return;
+    }
+    isdu_pool_put((uint32_t) ((ctx->buffer - &g_isdu_pool[0][0]) /
+                              (ptrdiff_t) IOLINK_ISDU_STORAGE_SIZE));
+    isdu_attach_storage(ctx, NULL);
+#else
+    (void) ctx;
+#endif
+}
+
+size_t iolink_isdu_pool_free(void)
+{
+#if IOLINK_ISDU_POOL_BUFFERS > 0
+    uint32_t used = iolink_atomic_load_u32(&g_isdu_pool_used);
+    size_t free_count = 0U;
+    for (uint32_t slot = 0U; slot < IOLINK_ISDU_POOL_BUFFERS; slot++) {
+        if ((used & (1UL << slot)) == 0U) {
+            free_count++;
+        }
+    }
+    return free_count;
+#else
+    return 0U;
+#endif
+}
+
 void iolink_isdu_init(iolink_isdu_ctx_t* ctx)
 {
     if (!iolink_ctx_zero(ctx, sizeof(iolink_isdu_ctx_t))) {
         return;
     }
+#if IOLINK_ISDU_POOL_BUFFERS > 0
+    /* Re-init mid-transfer: the buffer pointer is gone, find the lent buffer by owner */
+    for (uint32_t slot = 0U; slot < IOLINK_ISDU_POOL_BUFFERS; slot++) {
+        if (g_isdu_pool_owner[slot] == ctx) {
+            isdu_pool_put(slot);
+        }
+    }
+#else
+    isdu_attach_storage(ctx, ctx->storage);
+#endif
     ctx->state = ISDU_STATE_IDLE;
     ctx->next_state = ISDU_STATE_IDLE;
+    ctx->response_src = ctx->response_buf;
+}
+
+/* End of a transfer: back to IDLE, a pooled buffer is returned */
+static void isdu_enter_idle(iolink_isdu_ctx_t* ctx)
+{
+    ctx->state = ISDU_STATE_IDLE;
+    isdu_storage_release(ctx);
+}
+
+/* Point the response back at response_buf and empty it */
+static void isdu_response_reset(iolink_isdu_ctx_t* ctx)
+{
+    ctx->response_src = ctx->response_buf;
+    ctx->response_pull = NULL;
+    ctx->response_arg = NULL;
+    ctx->response_len = 0U;
+    ctx->response_idx = 0U;
+}
+
+static void isdu_set_error(iolink_isdu_ctx_t* ctx, uint8_t code)
+{
+    isdu_response_reset(ctx);
+    ctx->error_buf[0] = 0x80U;
+    ctx->error_buf[1] = code;
+    ctx->response_src = ctx->error_buf;
+    ctx->response_len = 2U;
 }
 
 static int isdu_handle_idle(iolink_isdu_ctx_t* ctx, uint8_t byte)
@@ -53,13 +181,21 @@ static int isdu_handle_idle(iolink_isdu_ctx_t* ctx, uint8_t byte)
         return -1;
     }
 
+    if (!isdu_storage_acquire(ctx)) {
+        /* Shared pool exhausted: refuse the request, the master retries later */
+        isdu_set_error(ctx, IOLINK_ISDU_ERROR_BUSY);
+        ctx->segment_seq = 0U;
+        ctx->is_response_control_sent = false;
+        ctx->state = ISDU_STATE_RESPONSE_READY;
+        return 1;
+    }
+
     ctx->is_segmented = !last;
     ctx->segment_seq = seq;
     ctx->error_code = IOLINK_ISDU_ERROR_NONE;
     ctx->is_response_control_sent = false;
     ctx->buffer_idx = 0U;
-    ctx->response_len = 0U;
-    ctx->response_idx = 0U;
+    isdu_response_reset(ctx);
     ctx->state = ISDU_STATE_HEADER_INITIAL;
     return 0;
 }
@@ -76,18 +212,24 @@ int iolink_isdu_collect_byte(iolink_isdu_ctx_t* ctx, uint8_t byte)
      */
     bool is_control_phase =
         (ctx->state == ISDU_STATE_IDLE || ctx->state == ISDU_STATE_SEGMENT_COLLECT ||
-         ctx->state == ISDU_STATE_RESPONSE_READY);
+         ctx->state == ISDU_STATE_RESPONSE_READY || ctx->state == ISDU_STATE_BUSY);
 
     if (is_control_phase) {
         bool start = ((byte & 0x80U) != 0U);
         uint8_t seq = (uint8_t) (byte & 0x3FU);
 
+        if (start && (ctx->state == ISDU_STATE_BUSY)) {
+            /* Master abandoned the deferred request; a late completion is rejected */
+            iolink_critical_enter();
+            if (ctx->state == ISDU_STATE_BUSY) {
+                ctx->state = ISDU_STATE_IDLE;
+            }
+            iolink_critical_exit();
+        }
+
         if (start && (ctx->state != ISDU_STATE_IDLE) && (ctx->state != ISDU_STATE_RESPONSE_READY)) {
             /* Collision: New Request Start Bit detected during segmented transfer */
-            ctx->response_buf[0] = 0x80U;
-            ctx->response_buf[1] = IOLINK_ISDU_ERROR_BUSY;
-            ctx->response_len = 2U;
-            ctx->response_idx = 0U;
+            isdu_set_error(ctx, IOLINK_ISDU_ERROR_BUSY);
             ctx->is_response_control_sent = false;
             ctx->state = ISDU_STATE_RESPONSE_READY;
             return 1;
@@ -95,8 +237,7 @@ int iolink_isdu_collect_byte(iolink_isdu_ctx_t* ctx, uint8_t byte)
 
         if (start && (ctx->state == ISDU_STATE_RESPONSE_READY)) {
             /* Master started new request while previous response was pending */
-            ctx->response_idx = 0U;
-            ctx->response_len = 0U;
+            isdu_response_reset(ctx);
             ctx->state = ISDU_STATE_IDLE;
             /* Fall through to handle_idle */
         }
@@ -110,10 +251,7 @@ int iolink_isdu_collect_byte(iolink_isdu_ctx_t* ctx, uint8_t byte)
             /* Verify sequence number */
             if (seq != (uint8_t) ((ctx->segment_seq + 1) & 0x3F)) {
                 /* Sequence error: Abort and Send Error 0x8081 (Segmentation Error) */
-                ctx->response_buf[0] = 0x80U;
-                ctx->response_buf[1] = IOLINK_ISDU_ERROR_SEGMENTATION;
-                ctx->response_len = 2U;
-                ctx->response_idx = 0U;
+                isdu_set_error(ctx, IOLINK_ISDU_ERROR_SEGMENTATION);
                 ctx->state = ISDU_STATE_RESPONSE_READY;
                 ctx->segment_seq = 0U; /* Start response with Seq 0 */
                 ctx->is_response_control_sent = false;
@@ -148,10 +286,7 @@ int iolink_isdu_collect_byte(iolink_isdu_ctx_t* ctx, uint8_t byte)
                 }
             }
             else {
-                ctx->response_buf[0] = 0x80U;
-                ctx->response_buf[1] = IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
-                ctx->response_len = 2U;
-                ctx->response_idx = 0U;
+                isdu_set_error(ctx, IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL);
                 ctx->state = ISDU_STATE_RESPONSE_READY;
                 return -1;
             }
@@ -190,6 +325,13 @@ int iolink_isdu_collect_byte(iolink_isdu_ctx_t* ctx, uint8_t byte)
             break;
 
         case ISDU_STATE_DATA_COLLECT:
+            if (ctx->buffer_idx >= IOLINK_ISDU_BUFFER_SIZE) {
+                isdu_set_error(ctx, IOLINK_ISDU_ERROR_WRITE_PROTECTED); /* Length overrun */
+                ctx->segment_seq = 0U;
+                ctx->is_response_control_sent = false;
+                ctx->state = ISDU_STATE_RESPONSE_READY;
+                return -1;
+            }
             ctx->buffer[ctx->buffer_idx++] = byte;
             if (ctx->buffer_idx >= ctx->header.length) {
                 ctx->state = ISDU_STATE_SERVICE_EXECUTE;
@@ -217,255 +359,150 @@ int iolink_isdu_collect_byte(iolink_isdu_ctx_t* ctx, uint8_t byte)
             return 0;
 
         default:
-            ctx->state = ISDU_STATE_IDLE;
+            isdu_enter_idle(ctx);
             break;
     }
     return 0;
 }
 
-static void handle_mandatory_indices(iolink_isdu_ctx_t* ctx)
+static size_t isdu_put_be(uint8_t* buf, uint32_t value, size_t nbytes)
 {
-    const iolink_device_info_t* info = iolink_device_info_get();
-    const char* str_data = NULL;
+    for (size_t i = 0U; i < nbytes; i++) {
+        buf[i] = (uint8_t) (value >> (8U * (nbytes - 1U - i)));
+    }
+    return nbytes;
+}
+
+int iolink_isdu_respond_ref(iolink_isdu_ctx_t* ctx, const void* data, size_t len)
+{
+    if ((ctx == NULL) || !iolink_buf_is_valid(data, len) || (len > (size_t) INT_MAX)) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+    ctx->response_src = (const uint8_t*) data;
+    ctx->response_pull = NULL;
+    return (int) len;
+}
+
+int iolink_isdu_respond_pull(iolink_isdu_ctx_t* ctx, iolink_isdu_pull_fn pull, void* arg,
+                             size_t len)
+{
+    if ((ctx == NULL) || (pull == NULL) || (len > (size_t) INT_MAX)) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+    ctx->response_pull = pull;
+    ctx->response_arg = arg;
+    return (int) len;
+}
 
+/* Strings are streamed from the device info storage, not copied */
+static int isdu_put_string(iolink_isdu_ctx_t* ctx, const char* str)
+{
+    if (str == NULL) {
+        return 0;
+    }
+    return iolink_isdu_respond_ref(ctx, str, strlen(str));
+}
+
+/* Identification (0x000A-0x0017, 0x001E, 0x0024), served from iolink_device_info_t */
+static int isdu_read_device_info(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                 uint8_t* buf, size_t max_len)
+{
+    (void) subindex;
+    (void) max_len;
+    const iolink_device_info_t* info = iolink_device_info_get();
     if (info == NULL) {
-        ctx->response_buf[0] = 0x80U;
-        ctx->response_buf[1] = 0x11U;
-        ctx->response_len = 2U;
-        ctx->response_idx = 0U;
-        ctx->state = ISDU_STATE_RESPONSE_READY;
-        ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-        return;
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
     }
 
-    switch (ctx->header.index) {
+    switch (index) {
         case IOLINK_IDX_VENDOR_ID:
-            ctx->response_buf[0] = (uint8_t) (info->vendor_id >> 8);
-            ctx->response_buf[1] = (uint8_t) (info->vendor_id & 0xFF);
-            ctx->response_len = 2U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-            return;
-
+            return (int) isdu_put_be(buf, info->vendor_id, 2U);
         case IOLINK_IDX_DEVICE_ID:
-            ctx->response_buf[0] = (uint8_t) (info->device_id >> 24);
-            ctx->response_buf[1] = (uint8_t) (info->device_id >> 16);
-            ctx->response_buf[2] = (uint8_t) (info->device_id >> 8);
-            ctx->response_buf[3] = (uint8_t) (info->device_id & 0xFF);
-            ctx->response_len = 4U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-            return;
-
+            return (int) isdu_put_be(buf, info->device_id, 4U);
         case IOLINK_IDX_PROFILE_CHARACTERISTIC:
-            ctx->response_buf[0] = (uint8_t) (info->profile_characteristic >> 8);
-            ctx->response_buf[1] = (uint8_t) (info->profile_characteristic & 0xFF);
-            ctx->response_len = 2U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-            return;
-
+            return (int) isdu_put_be(buf, info->profile_characteristic, 2U);
         case IOLINK_IDX_VENDOR_NAME:
-            str_data = info->vendor_name;
-            break;
+            return isdu_put_string(ctx, info->vendor_name);
         case IOLINK_IDX_VENDOR_TEXT:
-            str_data = info->vendor_text;
-            break;
+            return isdu_put_string(ctx, info->vendor_text);
         case IOLINK_IDX_PRODUCT_NAME:
-            str_data = info->product_name;
-            break;
+            return isdu_put_string(ctx, info->product_name);
         case IOLINK_IDX_PRODUCT_ID:
-            str_data = info->product_id;
-            break;
+            return isdu_put_string(ctx, info->product_id);
         case IOLINK_IDX_PRODUCT_TEXT:
-            str_data = info->product_text;
-            break;
+            return isdu_put_string(ctx, info->product_text);
         case IOLINK_IDX_SERIAL_NUMBER:
-            str_data = info->serial_number;
-            break;
+            return isdu_put_string(ctx, info->serial_number);
         case IOLINK_IDX_HARDWARE_REVISION:
-            str_data = info->hardware_revision;
-            break;
+            return isdu_put_string(ctx, info->hardware_revision);
         case IOLINK_IDX_FIRMWARE_REVISION:
-            str_data = info->firmware_revision;
-            break;
-
-        case IOLINK_IDX_APPLICATION_TAG:
-            if (ctx->header.type == IOLINK_ISDU_SERVICE_TYPE_WRITE) {
-                if (iolink_params_set(IOLINK_IDX_APPLICATION_TAG, 0U, ctx->buffer, ctx->buffer_idx,
-                                      true) == 0) {
-                    ctx->response_len = 0U;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-                    return;
-                }
-            }
-            else {
-                int res = iolink_params_get(IOLINK_IDX_APPLICATION_TAG, 0U, ctx->response_buf,
-                                            (size_t) IOLINK_ISDU_BUFFER_SIZE);
-                if (res >= 0) {
-                    ctx->response_len = (uint8_t) res;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-                    return;
-                }
-            }
-            break;
+            return isdu_put_string(ctx, info->firmware_revision);
+        case IOLINK_IDX_REVISION_ID:
+            return (int) isdu_put_be(buf, info->revision_id, 2U);
+        case IOLINK_IDX_MIN_CYCLE_TIME:
+            return (int) isdu_put_be(buf, info->min_cycle_time, 1U);
+        default:
+            return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+}
 
-        case IOLINK_IDX_FUNCTION_TAG:
-            if (ctx->header.type == IOLINK_ISDU_SERVICE_TYPE_WRITE) {
-                if (iolink_params_set(IOLINK_IDX_FUNCTION_TAG, 0U, ctx->buffer, ctx->buffer_idx,
-                                      true) == 0) {
-                    ctx->response_len = 0U;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-                    return;
-                }
-            }
-            else {
-                int res = iolink_params_get(IOLINK_IDX_FUNCTION_TAG, 0U, ctx->response_buf,
-                                            (size_t) IOLINK_ISDU_BUFFER_SIZE);
-                if (res >= 0) {
-                    ctx->response_len = (uint8_t) res;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    ctx->segment_seq = 0U;  // Reset segment_seq when setting RESPONSE_READY
-                    return;
-                }
-            }
-            break;
+/* Application/Function/Location Tag (0x0018-0x001A), stored by the parameter manager */
+static int isdu_read_param(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                           uint8_t* buf, size_t max_len)
+{
+    (void) ctx;
+    int res = iolink_params_get(index, subindex, buf, max_len);
+    return (res >= 0) ? res : -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+}
 
-        case IOLINK_IDX_LOCATION_TAG:
-            if (ctx->header.type == IOLINK_ISDU_SERVICE_TYPE_WRITE) {
-                if (iolink_params_set(IOLINK_IDX_LOCATION_TAG, 0U, ctx->buffer, ctx->buffer_idx,
-                                      true) == 0) {
-                    ctx->response_len = 0U;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    return;
-                }
-            }
-            else {
-                int res = iolink_params_get(IOLINK_IDX_LOCATION_TAG, 0U, ctx->response_buf,
-                                            (size_t) IOLINK_ISDU_BUFFER_SIZE);
-                if (res >= 0) {
-                    ctx->response_len = (uint8_t) res;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    return;
-                }
-            }
-            break;
+static int isdu_write_param(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                            const uint8_t* data, size_t len)
+{
+    (void) ctx;
+    return (iolink_params_set(index, subindex, data, len, true) == 0)
+               ? 0
+               : -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+}
 
-        case IOLINK_IDX_PDIN_DESCRIPTOR:
-            /* Read-only: Returns PD Input descriptor (1 byte: PD length) */
-            if (ctx->header.type == IOLINK_ISDU_SERVICE_TYPE_WRITE) {
-                ctx->response_buf[0] = 0x80U;
-                ctx->response_buf[1] = IOLINK_ISDU_ERROR_WRITE_PROTECTED;
-                ctx->response_len = 2U;
-                ctx->response_idx = 0U;
-                ctx->state = ISDU_STATE_RESPONSE_READY;
-                return;
-            }
-            /* Return PD Input length (default: 2 bytes) */
-            ctx->response_buf[0] = 2U; /* Default PD length */
-            ctx->response_len = 1U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            return;
+/*
+ * Standard DS commands (0x05-0x08). ParamDownloadEnd with a staged image is
+ * answered by iolink_ds_process() once the image is committed.
+ */
+static int isdu_ds_command(iolink_isdu_ctx_t* ctx, uint8_t cmd)
+{
+    int ret = 0;
+    iolink_ds_ctx_t* ds = (iolink_ds_ctx_t*) ctx->ds_ctx;
 
-        case IOLINK_IDX_DEVICE_STATUS:
-            ctx->response_buf[0] =
-                iolink_events_get_highest_severity((iolink_events_ctx_t*) ctx->event_ctx);
-            ctx->response_len = 1U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            return;
-
-        case IOLINK_IDX_DETAILED_DEVICE_STATUS: {
-            iolink_event_t events[8];
-            uint8_t count =
-                iolink_events_get_all((iolink_events_ctx_t*) ctx->event_ctx, events, 8U);
-            if (count == 0U) {
-                /* Special case: No events -> return 3 bytes of 0 as per spec pattern?
-                   Actually, spec says it returns a list of active events. If none, length 0 or
-                   error? Most masters expect 3 bytes per event: [Qualifier] [Code(2)]. If no
-                   events, we'll return 0 length. */
-                ctx->response_len = 0U;
-            }
-            else {
-                for (uint8_t i = 0U; i < count; i++) {
-                    /* Qualifier: [Type(7-6)] [Instance(5-0)]
-                       IO-Link Spec: 00=Reserved, 01=Notification, 10=Warning, 11=Error */
-                    uint8_t qualifier = 0U;
-                    switch (events[i].type) {
-                        case IOLINK_EVENT_TYPE_NOTIFICATION:
-                            qualifier = 0x40U;
-                            break;
-                        case IOLINK_EVENT_TYPE_WARNING:
-                            qualifier = 0x80U;
-                            break;
-                        case IOLINK_EVENT_TYPE_ERROR:
-                            qualifier = 0xC0U;
-                            break;
-                        default:
-                            qualifier = 0x00U;
-                            break;
-                    }
-                    ctx->response_buf[i * 3] = qualifier;
-                    ctx->response_buf[i * 3 + 1] = (uint8_t) (events[i].code >> 8);
-                    ctx->response_buf[i * 3 + 2] = (uint8_t) (events[i].code & 0xFF);
-                }
-                ctx->response_len = (uint8_t) (count * 3U);
-            }
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
+    if (ds != NULL) {
+        uint16_t locks = iolink_device_info_get_access_locks();
+        ds->isdu_ctx = ctx;
+        ds->isdu_token = iolink_isdu_transfer_token(ctx);
+        ret = iolink_ds_handle_command(ds, cmd, locks);
+        if (ret != 1) {
+            ds->isdu_ctx = NULL;
         }
-            return;
-
-        case IOLINK_IDX_REVISION_ID:
-            ctx->response_buf[0] = (uint8_t) (info->revision_id >> 8);
-            ctx->response_buf[1] = (uint8_t) (info->revision_id & 0xFF);
-            ctx->response_len = 2U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            return;
-
-        case IOLINK_IDX_MIN_CYCLE_TIME:
-            ctx->response_buf[0] = info->min_cycle_time;
-            ctx->response_len = 1U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            return;
 
-        default:
-            ctx->response_buf[0] = 0x80U; /* Error: Service not available */
-            ctx->response_buf[1] = IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
-            ctx->response_len = 2U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            return;
-    }
-
-    if (str_data) {
-        size_t len_sz = strlen(str_data);
-        if (len_sz > sizeof(ctx->response_buf)) {
-            len_sz = sizeof(ctx->response_buf);
+        if (ret == -1) {
+            return -(int) IOLINK_ISDU_ERROR_BUSY; /* 0x30 */
         }
-        (void) memcpy(ctx->response_buf, str_data, len_sz);
-        ctx->response_len = (uint8_t) len_sz;
-        ctx->response_idx = 0U;
-        ctx->state = ISDU_STATE_RESPONSE_READY;
+        if (ret == -2) {
+            return -(int) IOLINK_ISDU_ERROR_WRITE_PROTECTED; /* 0x33 Access Denied */
+        }
+        if (ret < 0) {
+            return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+        }
+    }
+    /* Block parametrization: hold NVM flushes until ParamDownloadEnd */
+    if (cmd == IOLINK_CMD_PARAM_DOWNLOAD_START) {
+        iolink_params_download_start();
+    }
+    else if (cmd == IOLINK_CMD_PARAM_DOWNLOAD_END) {
+        iolink_params_download_end(true);
     }
+    return (ret == 1) ? IOLINK_ISDU_PENDING : 0;
 }
 
-static void handle_system_command(iolink_isdu_ctx_t* ctx, uint8_t cmd)
+static int handle_system_command(iolink_isdu_ctx_t* ctx, uint8_t cmd)
 {
     switch (cmd) {
         case IOLINK_CMD_DEVICE_RESET: /* 0x80 */
@@ -497,56 +534,22 @@ static void handle_system_command(iolink_isdu_ctx_t* ctx, uint8_t cmd)
         case IOLINK_CMD_PARAM_DOWNLOAD_END:
         case IOLINK_CMD_PARAM_UPLOAD_START:
         case IOLINK_CMD_PARAM_UPLOAD_END:
-            if (ctx->ds_ctx != NULL) {
-                uint16_t locks = iolink_device_info_get_access_locks();
-                int ret = iolink_ds_handle_command((iolink_ds_ctx_t*) ctx->ds_ctx, cmd, locks);
-
-                if (ret != 0) {
-                    ctx->response_buf[0] = 0x80U;
-                    if (ret == -1) {
-                        ctx->response_buf[1] = IOLINK_ISDU_ERROR_BUSY; /* 0x30 */
-                    }
-                    else if (ret == -2) {
-                        ctx->response_buf[1] =
-                            IOLINK_ISDU_ERROR_WRITE_PROTECTED; /* 0x33 Access Denied/Locked */
-                    }
-                    else {
-                        ctx->response_buf[1] = IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
-                    }
-                    ctx->response_len = 2U;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    return;
-                }
-            }
-            break;
+            return isdu_ds_command(ctx, cmd);
 
         /* Legacy/Custom DS Commands (0x95-0x97) - Mapped to standard flows if possible */
         case IOLINK_CMD_PARAM_UPLOAD: /* 0x95 -> 0x07 Start Upload */
-            if (ctx->ds_ctx != NULL) {
-                /* Legacy mapped to Upload Start */
-                if (iolink_ds_start_upload((iolink_ds_ctx_t*) ctx->ds_ctx) != 0) {
-                    ctx->response_buf[0] = 0x80U;
-                    ctx->response_buf[1] = IOLINK_ISDU_ERROR_BUSY;
-                    ctx->response_len = 2U;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    return;
-                }
+            if ((ctx->ds_ctx != NULL) &&
+                (iolink_ds_start_upload((iolink_ds_ctx_t*) ctx->ds_ctx) != 0)) {
+                return -(int) IOLINK_ISDU_ERROR_BUSY;
             }
             break;
 
         case IOLINK_CMD_PARAM_DOWNLOAD: /* 0x96 -> 0x05 Start Download */
-            if (ctx->ds_ctx != NULL) {
-                if (iolink_ds_start_download((iolink_ds_ctx_t*) ctx->ds_ctx) != 0) {
-                    ctx->response_buf[0] = 0x80U;
-                    ctx->response_buf[1] = IOLINK_ISDU_ERROR_BUSY;
-                    ctx->response_len = 2U;
-                    ctx->response_idx = 0U;
-                    ctx->state = ISDU_STATE_RESPONSE_READY;
-                    return;
-                }
+            if ((ctx->ds_ctx != NULL) &&
+                (iolink_ds_start_download((iolink_ds_ctx_t*) ctx->ds_ctx) != 0)) {
+                return -(int) IOLINK_ISDU_ERROR_BUSY;
             }
+            iolink_params_download_start();
             break;
 
         case IOLINK_CMD_PARAM_BREAK: /* 0x97 */
@@ -554,67 +557,183 @@ static void handle_system_command(iolink_isdu_ctx_t* ctx, uint8_t cmd)
             if (ctx->ds_ctx != NULL) {
                 (void) iolink_ds_abort((iolink_ds_ctx_t*) ctx->ds_ctx);
             }
+            iolink_params_download_end(false);
             break;
 
         default:
             /* Unknown command */
-            ctx->response_buf[0] = 0x80U;
-            ctx->response_buf[1] = IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
-            ctx->response_len = 2U;
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
-            return;
+            return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
     }
 
-    /* Success: empty response */
-    ctx->response_len = 0U;
-    ctx->response_idx = 0U;
-    ctx->state = ISDU_STATE_RESPONSE_READY;
+    return 0;
 }
 
-static void handle_access_locks(iolink_isdu_ctx_t* ctx)
+static int isdu_write_system_command(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                     const uint8_t* data, size_t len)
 {
-    if (ctx->header.type == IOLINK_ISDU_SERVICE_TYPE_READ) {
-        uint16_t locks = iolink_device_info_get_access_locks();
-        ctx->response_buf[0] = (uint8_t) (locks >> 8);
-        ctx->response_buf[1] = (uint8_t) (locks & 0xFF);
-        ctx->response_len = 2U;
+    (void) index;
+    (void) subindex;
+    if (len == 0U) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
     }
-    else {
-        /* Write: Update access locks */
-        if (ctx->buffer_idx >= 2U) {
-            uint16_t new_locks = ((uint16_t) ctx->buffer[0] << 8) | ctx->buffer[1];
-            iolink_device_info_set_access_locks(new_locks);
+    return handle_system_command(ctx, data[0]);
+}
+
+/* Data Storage index (0x0003); the image is streamed, never staged in the ISDU buffer */
+static int isdu_read_data_storage(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                  uint8_t* buf, size_t max_len)
+{
+    (void) index;
+    iolink_ds_ctx_t* ds = (iolink_ds_ctx_t*) ctx->ds_ctx;
+    if (ds == NULL) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+
+    switch (subindex) {
+        case IOLINK_DS_SUBIDX_STATE: {
+            /* State_Property bits 1-2: 0 inactive, 1 download, 2 upload, 3 locked */
+            uint8_t state = 0U;
+            if ((iolink_device_info_get_access_locks() & IOLINK_LOCK_DS) != 0U) {
+                state = 3U;
+            }
+            else if ((ds->state == IOLINK_DS_STATE_UPLOAD_REQ) ||
+                     (ds->state == IOLINK_DS_STATE_UPLOADING)) {
+                state = 2U;
+            }
+            else if (ds->state != IOLINK_DS_STATE_IDLE) {
+                state = 1U;
+            }
+            buf[0] = (uint8_t) (state << 1U);
+            return 1;
+        }
+        case IOLINK_DS_SUBIDX_SIZE:
+            return (int) isdu_put_be(buf, (uint32_t) iolink_ds_image_open(ds), 4U);
+        case IOLINK_DS_SUBIDX_CHECKSUM:
+            (void) iolink_ds_image_open(ds);
+            return (int) isdu_put_be(buf, ds->current_checksum, 4U);
+        case IOLINK_DS_SUBIDX_INDEX_LIST: {
+            /* [index:16][subindex] per parameter, terminated by index 0x0000 */
+            size_t count = 0U;
+            const uint16_t* indices = iolink_ds_get_indices(&count);
+            if (((count * 3U) + 2U) > max_len) {
+                return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+            }
+            size_t pos = 0U;
+            for (size_t i = 0U; i < count; i++) {
+                pos += isdu_put_be(&buf[pos], indices[i], 2U);
+                buf[pos++] = 0U;
+            }
+            pos += isdu_put_be(&buf[pos], 0U, 2U);
+            return (int) pos;
         }
-        ctx->response_len = 0U;
+        case IOLINK_DS_SUBIDX_IMAGE:
+            return iolink_isdu_respond_pull(ctx, iolink_ds_image_byte, ds,
+                                            iolink_ds_image_open(ds));
+        default:
+            return -(int) IOLINK_ISDU_ERROR_SUBINDEX_NOT_AVAIL;
     }
-    ctx->response_idx = 0U;
-    ctx->state = ISDU_STATE_RESPONSE_READY;
 }
 
-static void handle_detailed_device_status(iolink_isdu_ctx_t* ctx)
+static int isdu_write_data_storage(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                   const uint8_t* data, size_t len)
 {
-    if (ctx->header.type != IOLINK_ISDU_SERVICE_TYPE_READ) {
-        ctx->response_buf[0] = 0x80U;
-        ctx->response_buf[1] = IOLINK_ISDU_ERROR_WRITE_PROTECTED;
-        ctx->response_len = 2U;
-        return;
+    /* DS_Command 1..5 -> ParamUploadStart/End, ParamDownloadStart/End, ParamBreak */
+    static const uint8_t ds_commands[] = {
+        0U,
+        IOLINK_CMD_PARAM_UPLOAD_START,
+        IOLINK_CMD_PARAM_UPLOAD_END,
+        IOLINK_CMD_PARAM_DOWNLOAD_START,
+        IOLINK_CMD_PARAM_DOWNLOAD_END,
+        IOLINK_CMD_PARAM_BREAK,
+    };
+    (void) index;
+    iolink_ds_ctx_t* ds = (iolink_ds_ctx_t*) ctx->ds_ctx;
+    if (ds == NULL) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
     }
 
-    if (ctx->event_ctx == NULL) {
-        ctx->response_len = 0U;
-        return;
+    if (subindex == IOLINK_DS_SUBIDX_COMMAND) {
+        if ((len != 1U) || (data[0] == 0U) || (data[0] >= sizeof(ds_commands))) {
+            return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+        }
+        return handle_system_command(ctx, ds_commands[data[0]]);
+    }
+    if (subindex != IOLINK_DS_SUBIDX_IMAGE) {
+        return -(int) IOLINK_ISDU_ERROR_WRITE_PROTECTED;
     }
 
-    iolink_critical_enter();
+    int ret = iolink_ds_write_image(ds, data, len);
+    if (ret == -1) {
+        return -(int) IOLINK_ISDU_ERROR_BUSY;
+    }
+    return (ret == 0) ? 0 : -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+}
+
+/* Read of Index 2 - returns the oldest pending event code (2 bytes), 0x0000 if none */
+static int isdu_read_system_command(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                    uint8_t* buf, size_t max_len)
+{
+    (void) index;
+    (void) subindex;
+    (void) max_len;
+    iolink_event_t ev;
     iolink_events_ctx_t* event_ctx = (iolink_events_ctx_t*) ctx->event_ctx;
-    uint8_t count = event_ctx->count;
-    if (count > 8U) count = 8U; /* Limit to 8 events in response */
+    uint16_t code = 0U;
+    if ((event_ctx != NULL) && iolink_events_pop(event_ctx, &ev)) {
+        code = ev.code;
+    }
+    return (int) isdu_put_be(buf, code, 2U);
+}
+
+static int isdu_read_access_locks(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                  uint8_t* buf, size_t max_len)
+{
+    (void) ctx;
+    (void) index;
+    (void) subindex;
+    (void) max_len;
+    return (int) isdu_put_be(buf, iolink_device_info_get_access_locks(), 2U);
+}
+
+static int isdu_write_access_locks(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                   const uint8_t* data, size_t len)
+{
+    (void) ctx;
+    (void) index;
+    (void) subindex;
+    if (len >= 2U) {
+        uint16_t new_locks = (uint16_t) (((uint16_t) data[0] << 8) | data[1]);
+        iolink_device_info_set_access_locks(new_locks);
+    }
+    return 0;
+}
+
+static int isdu_read_device_status(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                   uint8_t* buf, size_t max_len)
+{
+    (void) index;
+    (void) subindex;
+    (void) max_len;
+    buf[0] = iolink_events_get_highest_severity((iolink_events_ctx_t*) ctx->event_ctx);
+    return 1;
+}
+
+static int isdu_read_detailed_device_status(iolink_isdu_ctx_t* ctx, uint16_t index,
+                                            uint8_t subindex, uint8_t* buf, size_t max_len)
+{
+    (void) index;
+    (void) subindex;
+    (void) max_len;
+    if (ctx->event_ctx == NULL) {
+        return 0;
+    }
+
+    iolink_event_t events[8];
+    uint8_t count = /* Limit to 8 events in response */
+        iolink_events_get_all((iolink_events_ctx_t*) ctx->event_ctx, events, 8U);
 
     for (uint8_t i = 0U; i < count; i++) {
-        /* Calculate index in FIFO */
-        uint8_t idx = (uint8_t) ((event_ctx->head + i) % IOLINK_EVENT_QUEUE_SIZE);
-        const iolink_event_t* ev = &event_ctx->queue[idx];
+        const iolink_event_t* ev = &events[i];
 
         /* EventQualifier:
          * Mode: Appeared (0b10 << 6 = 0x80)
@@ -637,111 +756,242 @@ static void handle_detailed_device_status(iolink_isdu_ctx_t* ctx)
         }
         qualifier |= 0x02U; /* DLL instance as default for these errors */
 
-        ctx->response_buf[i * 3U] = qualifier;
-        ctx->response_buf[i * 3U + 1U] = (uint8_t) (ev->code >> 8);
-        ctx->response_buf[i * 3U + 2U] = (uint8_t) (ev->code & 0xFF);
+        buf[i * 3U] = qualifier;
+        (void) isdu_put_be(&buf[i * 3U + 1U], ev->code, 2U);
     }
-    ctx->response_len = (uint8_t) (count * 3U);
-    ctx->response_idx = 0U;
-    ctx->state = ISDU_STATE_RESPONSE_READY;
-    iolink_critical_exit();
+    return (int) (count * 3U);
 }
 
-static void isdu_write_u32_be(uint8_t* buf, size_t* idx, uint32_t value)
+/* Read-only: Returns PD Input descriptor (1 byte: PD length) */
+static int isdu_read_pdin_descriptor(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                     uint8_t* buf, size_t max_len)
 {
-    buf[(*idx)++] = (uint8_t) ((value >> 24) & 0xFFU);
-    buf[(*idx)++] = (uint8_t) ((value >> 16) & 0xFFU);
-    buf[(*idx)++] = (uint8_t) ((value >> 8) & 0xFFU);
-    buf[(*idx)++] = (uint8_t) (value & 0xFFU);
+    (void) ctx;
+    (void) index;
+    (void) subindex;
+    (void) max_len;
+    buf[0] = 2U; /* Default PD length */
+    return 1;
 }
 
-static void handle_error_stats(iolink_isdu_ctx_t* ctx)
+static void isdu_write_u32_be(uint8_t* buf, size_t* idx, uint32_t value)
 {
-    if (ctx->header.type != IOLINK_ISDU_SERVICE_TYPE_READ) {
-        ctx->response_buf[0] = 0x80U;
-        ctx->response_buf[1] = IOLINK_ISDU_ERROR_WRITE_PROTECTED;
-        ctx->response_len = 2U;
-        return;
-    }
-
-    if (ctx->header.subindex != 0U) {
-        ctx->response_buf[0] = 0x80U;
-        ctx->response_buf[1] = IOLINK_ISDU_ERROR_SUBINDEX_NOT_AVAIL;
-        ctx->response_len = 2U;
-        return;
-    }
+    *idx += isdu_put_be(&buf[*idx], value, 4U);
+}
 
+static int isdu_read_error_stats(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                 uint8_t* buf, size_t max_len)
+{
+    (void) index;
+    (void) subindex;
+    (void) max_len;
     if (ctx->dll_ctx == NULL) {
-        ctx->response_buf[0] = 0x80U;
-        ctx->response_buf[1] = IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
-        ctx->response_len = 2U;
-        return;
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
     }
 
     iolink_dll_stats_t stats;
     iolink_dll_get_stats((const iolink_dll_ctx_t*) ctx->dll_ctx, &stats);
 
     size_t idx = 0U;
-    isdu_write_u32_be(ctx->response_buf, &idx, stats.crc_errors);
-    isdu_write_u32_be(ctx->response_buf, &idx, stats.timeout_errors);
-    isdu_write_u32_be(ctx->response_buf, &idx, stats.framing_errors);
-    isdu_write_u32_be(ctx->response_buf, &idx, stats.timing_errors);
-    ctx->response_len = (uint8_t) idx;
-    ctx->response_idx = 0U;
-    ctx->state = ISDU_STATE_RESPONSE_READY;
+    isdu_write_u32_be(buf, &idx, stats.crc_errors);
+    isdu_write_u32_be(buf, &idx, stats.timeout_errors);
+    isdu_write_u32_be(buf, &idx, stats.framing_errors);
+    isdu_write_u32_be(buf, &idx, stats.timing_errors);
+    return (int) idx;
 }
 
-static void handle_standard_commands(iolink_isdu_ctx_t* ctx)
+/**
+ * @brief Latency histograms (vendor index 0x0026)
+ *
+ * Subindex 0: per kind (response, cycle, byte gap) count, p50, p99, p99.9, max.
+ * Subindex 1..3: raw bucket counts of one kind. All values u32 big-endian, in us.
+ */
+static int isdu_read_latency_hist(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                                  uint8_t* buf, size_t max_len)
 {
-    if (ctx->header.index == IOLINK_IDX_SYSTEM_COMMAND) {
-        if (ctx->header.type == IOLINK_ISDU_SERVICE_TYPE_WRITE) {
-            /* Mandatory System Commands */
-            if (ctx->buffer_idx > 0U) {
-                handle_system_command(ctx, ctx->buffer[0]);
-            }
-            else {
-                ctx->response_buf[0] = 0x80U;
-                ctx->response_buf[1] = IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
-                ctx->response_len = 2U;
-                ctx->response_idx = 0U;
-                ctx->state = ISDU_STATE_RESPONSE_READY;
-            }
+    (void) index;
+    if (ctx->dll_ctx == NULL) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+
+    const iolink_dll_ctx_t* dll = (const iolink_dll_ctx_t*) ctx->dll_ctx;
+    iolink_latency_hist_t hist;
+    size_t idx = 0U;
+
+    if (subindex == 0U) {
+        for (uint8_t kind = 0U; kind < IOLINK_LATENCY_KIND_COUNT; kind++) {
+            (void) iolink_dll_get_latency_histogram(dll, (iolink_latency_kind_t) kind, &hist);
+            isdu_write_u32_be(buf, &idx, hist.count);
+            isdu_write_u32_be(buf, &idx, iolink_latency_hist_percentile(&hist, 5000U));
+            isdu_write_u32_be(buf, &idx, iolink_latency_hist_percentile(&hist, 9900U));
+            isdu_write_u32_be(buf, &idx, iolink_latency_hist_percentile(&hist, 9990U));
+            isdu_write_u32_be(buf, &idx, hist.max_us);
+        }
+    }
+    else {
+        if ((IOLINK_LATENCY_HIST_BUCKETS * 4U) > max_len) {
+            return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+        }
+        (void) iolink_dll_get_latency_histogram(dll, (iolink_latency_kind_t) (subindex - 1U),
+                                                &hist);
+        for (uint8_t i = 0U; i < IOLINK_LATENCY_HIST_BUCKETS; i++) {
+            isdu_write_u32_be(buf, &idx, hist.buckets[i]);
+        }
+    }
+    return (int) idx;
+}
+
+#define ISDU_R(idx, sub_max, rd)                                                                   \
+    {(idx), 0U, (sub_max), IOLINK_ISDU_ACCESS_READ, (rd), NULL, NULL, 0U}
+#define ISDU_RW(idx, sub_max, rd, wr)                                                              \
+    {(idx), 0U, (sub_max), IOLINK_ISDU_ACCESS_RW, (rd), (wr), NULL, 0U}
+
+/** @brief Built-in indices, sorted by index */
+static const iolink_isdu_entry_t g_isdu_builtin[] = {
+    ISDU_RW(IOLINK_IDX_SYSTEM_COMMAND, 0xFFU, isdu_read_system_command, isdu_write_system_command),
+    ISDU_RW(IOLINK_IDX_DATA_STORAGE, IOLINK_DS_SUBIDX_IMAGE, isdu_read_data_storage,
+            isdu_write_data_storage),
+    ISDU_R(IOLINK_IDX_VENDOR_ID, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_DEVICE_ID, 0xFFU, isdu_read_device_info),
+    ISDU_RW(IOLINK_IDX_DEVICE_ACCESS_LOCKS, 0xFFU, isdu_read_access_locks, isdu_write_access_locks),
+    ISDU_R(IOLINK_IDX_PROFILE_CHARACTERISTIC, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_VENDOR_NAME, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_VENDOR_TEXT, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_PRODUCT_NAME, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_PRODUCT_ID, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_PRODUCT_TEXT, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_SERIAL_NUMBER, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_HARDWARE_REVISION, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_FIRMWARE_REVISION, 0xFFU, isdu_read_device_info),
+    ISDU_RW(IOLINK_IDX_APPLICATION_TAG, 0U, isdu_read_param, isdu_write_param),
+    ISDU_RW(IOLINK_IDX_FUNCTION_TAG, 0U, isdu_read_param, isdu_write_param),
+    ISDU_RW(IOLINK_IDX_LOCATION_TAG, 0U, isdu_read_param, isdu_write_param),
+    ISDU_R(IOLINK_IDX_DEVICE_STATUS, 0xFFU, isdu_read_device_status),
+    ISDU_R(IOLINK_IDX_DETAILED_DEVICE_STATUS, 0xFFU, isdu_read_detailed_device_status),
+    ISDU_R(IOLINK_IDX_PDIN_DESCRIPTOR, 0xFFU, isdu_read_pdin_descriptor),
+    ISDU_R(IOLINK_IDX_REVISION_ID, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_MIN_CYCLE_TIME, 0xFFU, isdu_read_device_info),
+    ISDU_R(IOLINK_IDX_ERROR_STATS, 0U, isdu_read_error_stats),
+    ISDU_R(IOLINK_IDX_LATENCY_HIST, (uint8_t) IOLINK_LATENCY_KIND_COUNT, isdu_read_latency_hist),
+};
+
+static const iolink_isdu_entry_t* isdu_table_find(const iolink_isdu_entry_t* table, size_t len,
+                                                  uint16_t index)
+{
+    size_t lo = 0U;
+    size_t hi = len;
+    while (lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2U);
+        if (table[mid].index < index) {
+            lo = mid + 1U;
         }
         else {
-            /* Read of Index 2 - returns the oldest pending event code (2 bytes) */
-            iolink_event_t ev;
-            iolink_events_ctx_t* event_ctx = (iolink_events_ctx_t*) ctx->event_ctx;
-            if (event_ctx != NULL && iolink_events_pop(event_ctx, &ev)) {
-                ctx->response_buf[0] = (uint8_t) (ev.code >> 8);
-                ctx->response_buf[1] = (uint8_t) (ev.code & 0xFF);
-                ctx->response_len = 2U;
-            }
-            else {
-                /* No events pending: return 0x0000 or error?
-                 * Spec says if no events, return error or empty.
-                 * We'll return 0x0000 (no event). */
-                ctx->response_buf[0] = 0x00U;
-                ctx->response_buf[1] = 0x00U;
-                ctx->response_len = 2U;
-            }
-            ctx->response_idx = 0U;
-            ctx->state = ISDU_STATE_RESPONSE_READY;
+            hi = mid;
         }
     }
-    else if (ctx->header.index == IOLINK_IDX_DEVICE_ACCESS_LOCKS) {
-        handle_access_locks(ctx);
+    return ((lo < len) && (table[lo].index == index)) ? &table[lo] : NULL;
+}
+
+static int isdu_read_entry(iolink_isdu_ctx_t* ctx, const iolink_isdu_entry_t* entry)
+{
+    if (entry->read != NULL) {
+        return entry->read(ctx, ctx->header.index, ctx->header.subindex, ctx->response_buf,
+                           IOLINK_ISDU_BUFFER_SIZE);
     }
-    else if (ctx->header.index == IOLINK_IDX_DETAILED_DEVICE_STATUS) {
-        handle_detailed_device_status(ctx);
+    if (entry->data == NULL) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
     }
-    else if (ctx->header.index == IOLINK_IDX_ERROR_STATS) {
-        handle_error_stats(ctx);
-        ctx->response_idx = 0U;
-        ctx->state = ISDU_STATE_RESPONSE_READY;
+    return iolink_isdu_respond_ref(ctx, entry->data, entry->size);
+}
+
+static int isdu_write_entry(iolink_isdu_ctx_t* ctx, const iolink_isdu_entry_t* entry)
+{
+    if (entry->write != NULL) {
+        return entry->write(ctx, ctx->header.index, ctx->header.subindex, ctx->buffer,
+                            ctx->buffer_idx);
+    }
+    if (entry->data == NULL) {
+        return -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+    if (ctx->buffer_idx > entry->size) {
+        return -(int) IOLINK_ISDU_ERROR_WRITE_PROTECTED; /* 0x33: length overrun */
+    }
+    if (ctx->buffer_idx < entry->size) {
+        return -(int) IOLINK_ISDU_ERROR_LENGTH_UNDERRUN;
+    }
+    (void) memcpy(entry->data, ctx->buffer, entry->size);
+    return 0;
+}
+
+static void isdu_dispatch(iolink_isdu_ctx_t* ctx)
+{
+    const iolink_isdu_entry_t* entry =
+        isdu_table_find(ctx->user_table, ctx->user_table_len, ctx->header.index);
+    if (entry == NULL) {
+        entry = isdu_table_find(g_isdu_builtin, sizeof(g_isdu_builtin) / sizeof(g_isdu_builtin[0]),
+                                ctx->header.index);
+    }
+
+    bool is_write = (ctx->header.type == IOLINK_ISDU_SERVICE_TYPE_WRITE);
+    int res;
+    isdu_response_reset(ctx);
+    ctx->transfer_token++;
+    if (ctx->transfer_token == 0U) {
+        ctx->transfer_token = 1U;
+    }
+    if (entry == NULL) {
+        res = -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+    else if ((entry->access & (is_write ? IOLINK_ISDU_ACCESS_WRITE : IOLINK_ISDU_ACCESS_READ)) ==
+             0U) {
+        res = is_write ? -(int) IOLINK_ISDU_ERROR_WRITE_PROTECTED
+                       : -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL;
+    }
+    else if ((ctx->header.subindex < entry->subindex_min) ||
+             (ctx->header.subindex > entry->subindex_max)) {
+        res = -(int) IOLINK_ISDU_ERROR_SUBINDEX_NOT_AVAIL;
+    }
+    else {
+        res = is_write ? isdu_write_entry(ctx, entry) : isdu_read_entry(ctx, entry);
+    }
+
+    if (res == IOLINK_ISDU_PENDING) {
+        isdu_response_reset(ctx);
+        ctx->state = ISDU_STATE_BUSY;
+        return;
+    }
+
+    if (res < 0) {
+        isdu_set_error(ctx, (uint8_t) -res);
+    }
+    else if (is_write) {
+        isdu_response_reset(ctx);
     }
     else {
-        handle_mandatory_indices(ctx);
+        ctx->response_len = (size_t) res;
     }
+    /* A receive ISR may read the response as soon as it is published */
+    iolink_critical_enter();
+    ctx->segment_seq = 0U;
+    ctx->is_response_control_sent = false;
+    ctx->state = ISDU_STATE_RESPONSE_READY; /* Published last */
+    iolink_critical_exit();
+}
+
+int iolink_isdu_register_table(iolink_isdu_ctx_t* ctx, const iolink_isdu_entry_t* table,
+                               size_t count)
+{
+    if ((ctx == NULL) || ((table == NULL) && (count != 0U))) {
+        return -1;
+    }
+    for (size_t i = 1U; i < count; i++) {
+        if (table[i].index <= table[i - 1U].index) {
+            return -1;
+        }
+    }
+    ctx->user_table = table;
+    ctx->user_table_len = count;
+    return 0;
 }
 
 void iolink_isdu_process(iolink_isdu_ctx_t* ctx)
@@ -751,22 +1001,52 @@ void iolink_isdu_process(iolink_isdu_ctx_t* ctx)
     }
 
     if (ctx->state == ISDU_STATE_BUSY) {
-        /* In real implementation, we would check if the background task is done.
-           For now, we just move to RESPONSE_READY or IDLE. */
+        /* Waiting for iolink_isdu_complete(); OD stays empty meanwhile */
         return;
     }
 
     if (ctx->state == ISDU_STATE_SERVICE_EXECUTE) {
-        handle_standard_commands(ctx);
-        if (ctx->state != ISDU_STATE_RESPONSE_READY) {
-            ctx->state = ISDU_STATE_IDLE;
+        /* Ends in RESPONSE_READY or BUSY. A receive ISR may move on from there at
+         * once (read the response, start a new request), so the state is not
+         * looked at again here. */
+        isdu_dispatch(ctx);
+    }
+}
+
+uint32_t iolink_isdu_transfer_token(const iolink_isdu_ctx_t* ctx)
+{
+    return (ctx != NULL) ? ctx->transfer_token : 0U;
+}
+
+int iolink_isdu_complete(iolink_isdu_ctx_t* ctx, uint32_t token, int result, const uint8_t* data,
+                         size_t len)
+{
+    if ((ctx == NULL) || ((result >= 0) && !iolink_buf_is_valid(data, len)) ||
+        (len > IOLINK_ISDU_BUFFER_SIZE)) {
+        return -1;
+    }
+
+    int ret = -1;
+    iolink_critical_enter();
+    /* State alone would accept a stale completion once a later request is BUSY */
+    if ((ctx->state == ISDU_STATE_BUSY) && (token == ctx->transfer_token)) {
+        if (result < 0) {
+            isdu_set_error(ctx, (uint8_t) -result);
         }
         else {
-            /* Prepare for response transmission */
-            ctx->segment_seq = 0U;
-            ctx->is_response_control_sent = false;
+            isdu_response_reset(ctx);
+            if (len > 0U) {
+                (void) memcpy(ctx->response_buf, data, len);
+            }
+            ctx->response_len = len;
         }
+        ctx->segment_seq = 0U;
+        ctx->is_response_control_sent = false;
+        ctx->state = ISDU_STATE_RESPONSE_READY; /* Published last */
+        ret = 0;
     }
+    iolink_critical_exit();
+    return ret;
 }
 
 int iolink_isdu_get_response_byte(iolink_isdu_ctx_t* ctx, uint8_t* byte)
@@ -786,7 +1066,7 @@ int iolink_isdu_get_response_byte(iolink_isdu_ctx_t* ctx, uint8_t* byte)
         }
 
         /* Last bit if this is the final segment */
-        if ((uint8_t) (ctx->response_idx + 1U) >= ctx->response_len) {
+        if ((ctx->response_idx + 1U) >= ctx->response_len) {
             ctrl |= IOLINK_ISDU_CTRL_LAST;
         }
         /* Sequence number */
@@ -798,11 +1078,14 @@ int iolink_isdu_get_response_byte(iolink_isdu_ctx_t* ctx, uint8_t* byte)
     }
 
     if (ctx->response_idx < ctx->response_len) {
-        *byte = ctx->response_buf[ctx->response_idx++];
+        *byte = (ctx->response_pull != NULL)
+                    ? ctx->response_pull(ctx->response_arg, ctx->response_idx)
+                    : ctx->response_src[ctx->response_idx];
+        ctx->response_idx++;
         if (ctx->response_idx >= ctx->response_len) {
-            ctx->state = ISDU_STATE_IDLE;
-            printf("[ISDU] Response complete, entering IDLE\n");
-            fflush(stdout);
+            IOLINK_LOG_DEBUG("ISDU: response complete, index 0x%04X, %u bytes",
+                             ctx->header.index, ctx->response_len);
+            isdu_enter_idle(ctx);
         }
         else {
             /* Mandatory for V1.1.5 on OD=1: Every byte is preceded by Control Byte. */
@@ -812,6 +1095,6 @@ int iolink_isdu_get_response_byte(iolink_isdu_ctx_t* ctx, uint8_t* byte)
         return 1;
     }
 
-    ctx->state = ISDU_STATE_IDLE;
+    isdu_enter_idle(ctx);
     return 0;
 }
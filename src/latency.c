@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file latency.c
+ * @brief Fixed-memory log-linear latency histograms
+ */
+
+#include "iolinki/latency.h"
+#include "iolinki/utils.h"
+
+#define LATENCY_SUB_COUNT (1UL << IOLINK_LATENCY_HIST_SUB_BITS)
+
+IOLINK_STATIC_ASSERT(IOLINK_LATENCY_HIST_BUCKETS >= (2U * LATENCY_SUB_COUNT), latency_buckets_min);
+IOLINK_STATIC_ASSERT(IOLINK_LATENCY_HIST_BUCKETS <= 255U, latency_buckets_u8);
+IOLINK_STATIC_ASSERT((IOLINK_LATENCY_HIST_BUCKETS / LATENCY_SUB_COUNT) <= 32U, latency_shift_max);
+
+/*
+ * Values below 2 * LATENCY_SUB_COUNT map to themselves. Larger ones are shifted
+ * right until LATENCY_SUB_COUNT <= top < 2 * LATENCY_SUB_COUNT; the shift picks the
+ * octave and top the linear sub-bucket inside it.
+ */
+static uint8_t latency_bucket(uint32_t value_us)
+{
+    uint32_t shift = 0U;
+    while (((value_us >> shift) >= (2U * LATENCY_SUB_COUNT)) &&
+           (((shift + 2U) * LATENCY_SUB_COUNT) < IOLINK_LATENCY_HIST_BUCKETS)) {
+        shift++;
+    }
+    uint32_t top = value_us >> shift;
+    uint32_t bucket = (shift * LATENCY_SUB_COUNT) + top;
+    if ((top >= (2U * LATENCY_SUB_COUNT)) || (bucket > (IOLINK_LATENCY_HIST_BUCKETS - 1U))) {
+        bucket = IOLINK_LATENCY_HIST_BUCKETS - 1U; /* Beyond the covered range */
+    }
+    return (uint8_t) bucket;
+}
+
+/* Largest value that maps to @p bucket (not the last one) */
+static uint32_t latency_bucket_upper(uint32_t bucket)
+{
+    if (bucket < (2U * LATENCY_SUB_COUNT)) {
+        return bucket;
+    }
+    uint32_t shift = (bucket / LATENCY_SUB_COUNT) - 1U;
+    uint32_t top = bucket - (shift * LATENCY_SUB_COUNT);
+    return ((top + 1U) << shift) - 1U;
+}
+
+void iolink_latency_hist_reset(iolink_latency_hist_t* hist)
+{
+    (void) iolink_ctx_zero(hist, sizeof(iolink_latency_hist_t));
+}
+
+void iolink_latency_hist_record(iolink_latency_hist_t* hist, uint32_t value_us)
+{
+    if (hist == NULL) {
+        return;
+    }
+    hist->buckets[latency_bucket(value_us)]++;
+    hist->count++;
+    if (value_us > hist->max_us) {
+        hist->max_us = value_us;
+    }
+}
+
+uint32_t iolink_latency_hist_percentile(const iolink_latency_hist_t* hist, uint16_t per_10k)
+{
+    if ((hist == NULL) || (hist->count == 0U)) {
+        return 0U;
+    }
+    if (per_10k > 10000U) {
+        per_10k = 10000U;
+    }
+
+    /* Rank of the requested sample, rounded up, at least 1 */
+    uint64_t rank = (((uint64_t) hist->count * per_10k) + 9999U) / 10000U;
+    if (rank == 0U) {
+        rank = 1U;
+    }
+
+    uint64_t seen = 0U;
+    for (uint8_t i = 0U; i < IOLINK_LATENCY_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            if (i == (IOLINK_LATENCY_HIST_BUCKETS - 1U)) {
+                return hist->max_us;
+            }
+            uint32_t upper = latency_bucket_upper(i);
+            return (upper < hist->max_us) ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file log.c
+ * @brief Deferred binary log ring and formatter
+ *
+ * Bounded MPMC ring (Vyukov, as in events.c) used with a single consumer. To work
+ * without an init call, a cell stores the lap it is free for (pos & ~mask) and
+ * lap + 1 once published; a zero-initialized ring is empty.
+ */
+
+#include "iolinki/log.h"
+#include "iolinki/atomic.h"
+#include "iolinki/time_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#if IOLINK_LOG_LEVEL > 0
+
+#if (IOLINK_LOG_RING_SIZE & (IOLINK_LOG_RING_SIZE - 1U)) != 0U
+#error "IOLINK_LOG_RING_SIZE must be a power of two"
+#endif
+
+#define LOG_MASK ((uint32_t) IOLINK_LOG_RING_SIZE - 1U)
+
+typedef struct
+{
+    volatile uint32_t seq;
+    iolink_log_record_t rec;
+} log_cell_t;
+
+static log_cell_t g_log_cells[IOLINK_LOG_RING_SIZE];
+static volatile uint32_t g_log_enqueue_pos;
+static uint32_t g_log_dequeue_pos;
+static volatile uint32_t g_log_dropped;
+
+void iolink_log_write(uint8_t level, const char* fmt, uint32_t a0, uint32_t a1, uint32_t a2,
+                      uint32_t a3)
+{
+    uint32_t pos = iolink_atomic_load_u32(&g_log_enqueue_pos);
+    log_cell_t* cell;
+    for (;;) {
+        cell = &g_log_cells[pos & LOG_MASK];
+        int32_t diff = (int32_t) (iolink_atomic_load_u32(&cell->seq) - (pos & ~LOG_MASK));
+        if (diff == 0) {
+            if (iolink_atomic_cas_u32(&g_log_enqueue_pos, &pos, pos + 1U)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            (void) iolink_atomic_add_u32(&g_log_dropped, 1U);
+            return;
+        }
+        else {
+            pos = iolink_atomic_load_u32(&g_log_enqueue_pos);
+        }
+    }
+
+    cell->rec.ts_us = (uint32_t) iolink_time_get_us();
+    cell->rec.fmt = fmt;
+    cell->rec.args[0] = a0;
+    cell->rec.args[1] = a1;
+    cell->rec.args[2] = a2;
+    cell->rec.args[3] = a3;
+    cell->rec.level = level;
+    iolink_atomic_store_u32(&cell->seq, (pos & ~LOG_MASK) + 1U);
+}
+
+bool iolink_log_read(iolink_log_record_t* rec)
+{
+    if (rec == NULL) {
+        return false;
+    }
+    uint32_t pos = g_log_dequeue_pos;
+    log_cell_t* cell = &g_log_cells[pos & LOG_MASK];
+    if (iolink_atomic_load_u32(&cell->seq) != ((pos & ~LOG_MASK) + 1U)) {
+        return false;
+    }
+    *rec = cell->rec;
+    g_log_dequeue_pos = pos + 1U;
+    /* Free for the producer one lap later */
+    iolink_atomic_store_u32(&cell->seq, (pos & ~LOG_MASK) + IOLINK_LOG_RING_SIZE);
+    return true;
+}
+
+uint32_t iolink_log_dropped(void)
+{
+    return iolink_atomic_load_u32(&g_log_dropped);
+}
+
+#else
+
+void iolink_log_write(uint8_t level, const char* fmt, uint32_t a0, uint32_t a1, uint32_t a2,
+                      uint32_t a3)
+{
+    (void) level;
+    (void) fmt;
+    (void) a0;
+    (void) a1;
+    (void) a2;
+    (void) a3;
+}
+
+bool iolink_log_read(iolink_log_record_t* rec)
+{
+    (void) rec;
+    return false;
+}
+
+uint32_t iolink_log_dropped(void)
+{
+    return 0U;
+}
+
+#endif
+
+size_t iolink_log_format(const iolink_log_record_t* rec, char* buf, size_t size)
+{
+    if ((rec == NULL) || (buf == NULL) || (size == 0U)) {
+        return 0U;
+    }
+
+    size_t len = 0U;
+    size_t arg = 0U;
+    const char* p = (rec->fmt != NULL) ? rec->fmt : "";
+    buf[0] = '\0';
+
+    while ((*p != '\0') && (len + 1U < size)) {
+        if (*p != '%') {
+            buf[len++] = *p++;
+            continue;
+        }
+
+        /* Conversion spec: %[0][width]{d,i,u,x,X,c,%} */
+        char spec[8];
+        size_t spec_len = 0U;
+        spec[spec_len++] = *p++;
+        while (((*p == '0') || ((*p >= '1') && (*p <= '9'))) && (spec_len < 5U)) {
+            spec[spec_len++] = *p++;
+        }
+        char conv = *p;
+        if (conv == '\0') {
+            break;
+        }
+        p++;
+        if (conv == '%') {
+            buf[len++] = '%';
+            continue;
+        }
+        spec[spec_len++] = conv;
+        spec[spec_len] = '\0';
+
+        uint32_t value = (arg < IOLINK_LOG_MAX_ARGS) ? rec->args[arg] : 0U;
+        arg++;
+        int n;
+        switch (conv) {
+            case 'd':
+            case 'i':
+                n = snprintf(&buf[len], size - len, spec, (int) (int32_t) value);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+                n = snprintf(&buf[len], size - len, spec, (unsigned int) value);
+                break;
+            case 'c':
+                n = snprintf(&buf[len], size - len, spec, (int) (uint8_t) value);
+                break;
+            default:
+                n = snprintf(&buf[len], size - len, "%%%c", conv);
+                break;
+        }
+        if (n < 0) {
+            break;
+        }
+        len += (size_t) n;
+        if (len >= size) {
+            len = size - 1U;
+            break;
+        }
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+size_t iolink_log_drain(iolink_log_sink_fn sink, void* arg)
+{
+    if (sink == NULL) {
+        return 0U;
+    }
+    size_t count = 0U;
+    iolink_log_record_t rec;
+    char text[96];
+    while (iolink_log_read(&rec)) {
+        (void) iolink_log_format(&rec, text, sizeof(text));
+        sink(arg, &rec, text);
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,475 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file nvm_log.c
+ * @brief Log-structured, wear-leveled key/value store on flash
+ */
+
+#include "iolinki/nvm_log.h"
+#include "iolinki/utils.h"
+
+#if IOLINK_NVM_LOG_MAX_SECTORS > 32U
+#error "IOLINK_NVM_LOG_MAX_SECTORS must not exceed 32"
+#endif
+#if IOLINK_NVM_LOG_MAX_KEYS > 255U
+#error "IOLINK_NVM_LOG_MAX_KEYS must not exceed 255"
+#endif
+
+#define NVM_LOG_MAGIC 0x534C4F49UL /* "IOLS" */
+#define NVM_LOG_SECTOR_HDR 8U
+#define NVM_LOG_REC_HDR 4U
+#define NVM_LOG_REC_TRAILER 4U
+#define NVM_LOG_NO_ADDR 0xFFFFFFFFUL
+#define NVM_LOG_CHUNK 32U
+
+static uint32_t nvm_log_rec_size(uint32_t len)
+{
+    return NVM_LOG_REC_HDR + ((len + 3U) & ~3UL) + NVM_LOG_REC_TRAILER;
+}
+
+static uint32_t nvm_log_sector_addr(const iolink_nvm_log_t* log, uint8_t sector)
+{
+    return (uint32_t) sector * log->sector_size;
+}
+
+static uint8_t nvm_log_sector_of(const iolink_nvm_log_t* log, uint32_t addr)
+{
+    return (uint8_t) (addr / log->sector_size);
+}
+
+/* CRC-16/CCITT-FALSE; runs only when writing or mounting */
+static uint16_t nvm_log_crc16(uint16_t crc, const uint8_t* data, size_t len)
+{
+    for (size_t i = 0U; i < len; i++) {
+        crc ^= (uint16_t) ((uint16_t) data[i] << 8U);
+        for (uint8_t bit = 0U; bit < 8U; bit++) {
+            crc = ((crc & 0x8000U) != 0U) ? (uint16_t) ((crc << 1U) ^ 0x1021U)
+                                          : (uint16_t) (crc << 1U);
+        }
+    }
+    return crc;
+}
+
+static void nvm_log_put_u32(uint8_t* out, uint32_t value)
+{
+    out[0] = (uint8_t) value;
+    out[1] = (uint8_t) (value >> 8U);
+    out[2] = (uint8_t) (value >> 16U);
+    out[3] = (uint8_t) (value >> 24U);
+}
+
+static uint32_t nvm_log_get_u32(const uint8_t* in)
+{
+    return (uint32_t) in[0] | ((uint32_t) in[1] << 8U) | ((uint32_t) in[2] << 16U) |
+           ((uint32_t) in[3] << 24U);
+}
+
+static int nvm_log_erase(iolink_nvm_log_t* log, uint8_t sector)
+{
+    log->stats.sector_erases++;
+    if (log->storage->erase(nvm_log_sector_addr(log, sector), log->sector_size) != 0) {
+        return -1;
+    }
+    log->erased_mask |= (1UL << sector);
+    log->sector_live[sector] = 0U;
+    return 0;
+}
+
+/* First erased sector after the head, in ring order */
+static int nvm_log_next_erased(const iolink_nvm_log_t* log)
+{
+    for (uint8_t i = 1U; i < log->sector_count; i++) {
+        uint8_t sector = (uint8_t) ((log->head + i) % log->sector_count);
+        if ((log->erased_mask & (1UL << sector)) != 0U) {
+            return (int) sector;
+        }
+    }
+    return -1;
+}
+
+/* Oldest sector in use other than the head, in ring order */
+static int nvm_log_oldest(const iolink_nvm_log_t* log)
+{
+    for (uint8_t i = 1U; i < log->sector_count; i++) {
+        uint8_t sector = (uint8_t) ((log->head + i) % log->sector_count);
+        if ((log->erased_mask & (1UL << sector)) == 0U) {
+            return (int) sector;
+        }
+    }
+    return -1;
+}
+
+static uint32_t nvm_log_erased_count(const iolink_nvm_log_t* log)
+{
+    uint32_t count = 0U;
+    for (uint32_t mask = log->erased_mask; mask != 0U; mask &= mask - 1U) {
+        count++;
+    }
+    return count;
+}
+
+static int nvm_log_open_sector(iolink_nvm_log_t* log, uint8_t sector)
+{
+    uint8_t hdr[NVM_LOG_SECTOR_HDR];
+    uint32_t seq = log->head_seq + 1U;
+    nvm_log_put_u32(&hdr[0], seq);
+    nvm_log_put_u32(&hdr[4], NVM_LOG_MAGIC);
+    if (log->storage->write(nvm_log_sector_addr(log, sector), hdr, sizeof(hdr)) != 0) {
+        return -1;
+    }
+    log->erased_mask &= ~(1UL << sector);
+    log->sector_live[sector] = 0U;
+    log->head = sector;
+    log->head_seq = seq;
+    log->head_offset = NVM_LOG_SECTOR_HDR;
+    return 0;
+}
+
+static void nvm_log_index_set(iolink_nvm_log_t* log, uint8_t key, uint32_t addr, uint16_t len)
+{
+    iolink_nvm_log_entry_t* entry = &log->index[key];
+    if (entry->addr != NVM_LOG_NO_ADDR) {
+        log->sector_live[nvm_log_sector_of(log, entry->addr)] -= nvm_log_rec_size(entry->len);
+    }
+    entry->addr = addr;
+    entry->len = len;
+    log->sector_live[nvm_log_sector_of(log, addr)] += nvm_log_rec_size(len);
+}
+
+/*
+ * Program one record at the head. The value comes from data, or from the record
+ * at src when data is NULL (compaction). The caller has checked that it fits.
+ */
+static int nvm_log_put(iolink_nvm_log_t* log, uint8_t key, const uint8_t* data, uint32_t src,
+                       uint16_t len)
+{
+    const iolink_ds_storage_api_t* storage = log->storage;
+    uint32_t addr = nvm_log_sector_addr(log, log->head) + log->head_offset;
+    uint8_t buf[NVM_LOG_CHUNK];
+
+    buf[0] = (uint8_t) len;
+    buf[1] = (uint8_t) (len >> 8U);
+    buf[2] = key;
+    buf[3] = (uint8_t) ~key;
+    uint16_t crc = nvm_log_crc16(0xFFFFU, buf, NVM_LOG_REC_HDR);
+    /* Consume the space first: a failed program leaves bytes that cannot be reused */
+    log->head_offset += nvm_log_rec_size(len);
+    if (storage->write(addr, buf, NVM_LOG_REC_HDR) != 0) {
+        return -1;
+    }
+
+    for (uint32_t done = 0U; done < len;) {
+        uint32_t chunk = ((len - done) > NVM_LOG_CHUNK) ? NVM_LOG_CHUNK : (len - done);
+        const uint8_t* part = (data != NULL) ? &data[done] : buf;
+        if ((data == NULL) &&
+            (storage->read(src + NVM_LOG_REC_HDR + done, buf, chunk) != 0)) {
+            return -1;
+        }
+        crc = nvm_log_crc16(crc, part, chunk);
+        if (storage->write(addr + NVM_LOG_REC_HDR + done, part, chunk) != 0) {
+            return -1;
+        }
+        done += chunk;
+    }
+
+    uint32_t trailer = addr + nvm_log_rec_size(len) - NVM_LOG_REC_TRAILER;
+    buf[0] = (uint8_t) crc;
+    buf[1] = (uint8_t) (crc >> 8U);
+    if (storage->write(trailer, buf, 2U) != 0) {
+        return -1;
+    }
+    /* Commit point */
+    buf[0] = 0x00U;
+    buf[1] = 0x00U;
+    if (storage->write(trailer + 2U, buf, 2U) != 0) {
+        return -1;
+    }
+
+    nvm_log_index_set(log, key, addr, len);
+    return 0;
+}
+
+/* Make room for a record of `size` bytes, opening the next erased sector if needed */
+static int nvm_log_ensure_room(iolink_nvm_log_t* log, uint32_t size)
+{
+    if ((log->head_offset + size) <= log->sector_size) {
+        return 0;
+    }
+    int next = nvm_log_next_erased(log);
+    if (next < 0) {
+        return -1;
+    }
+    return nvm_log_open_sector(log, (uint8_t) next);
+}
+
+/* Move the live records of the oldest sector to the head, then erase it */
+static int nvm_log_reclaim(iolink_nvm_log_t* log)
+{
+    int victim = nvm_log_oldest(log);
+    if (victim < 0) {
+        return -1;
+    }
+    for (uint8_t key = 0U; key < IOLINK_NVM_LOG_MAX_KEYS; key++) {
+        const iolink_nvm_log_entry_t* entry = &log->index[key];
+        if ((entry->addr == NVM_LOG_NO_ADDR) ||
+            (nvm_log_sector_of(log, entry->addr) != (uint8_t) victim)) {
+            continue;
+        }
+        if ((nvm_log_ensure_room(log, nvm_log_rec_size(entry->len)) != 0) ||
+            (nvm_log_put(log, key, NULL, entry->addr, entry->len) != 0)) {
+            return -1;
+        }
+        log->stats.records_copied++;
+    }
+    return nvm_log_erase(log, (uint8_t) victim);
+}
+
+int iolink_nvm_log_format(iolink_nvm_log_t* log)
+{
+    if ((log == NULL) || (log->storage == NULL)) {
+        return -1;
+    }
+    for (uint8_t key = 0U; key < IOLINK_NVM_LOG_MAX_KEYS; key++) {
+        log->index[key].addr = NVM_LOG_NO_ADDR;
+        log->index[key].len = 0U;
+    }
+    for (uint8_t sector = 0U; sector < log->sector_count; sector++) {
+        if (nvm_log_erase(log, sector) != 0) {
+            return -1;
+        }
+    }
+    log->head = (uint8_t) (log->sector_count - 1U);
+    return nvm_log_open_sector(log, 0U);
+}
+
+/* True if [addr, addr + len) reads as erased flash */
+static bool nvm_log_range_blank(const iolink_nvm_log_t* log, uint32_t addr, uint32_t len)
+{
+    uint8_t buf[NVM_LOG_CHUNK];
+    for (uint32_t done = 0U; done < len;) {
+        uint32_t chunk = ((len - done) > NVM_LOG_CHUNK) ? NVM_LOG_CHUNK : (len - done);
+        if (log->storage->read(addr + done, buf, chunk) != 0) {
+            return false;
+        }
+        for (uint32_t i = 0U; i < chunk; i++) {
+            if (buf[i] != 0xFFU) {
+                return false;
+            }
+        }
+        done += chunk;
+    }
+    return true;
+}
+
+/*
+ * Replay the records of one sector into the index. Returns the offset where the
+ * next record may be programmed, or sector_size (sealed) if a record header is
+ * unreadable and the extent of the programmed area is unknown.
+ */
+static uint32_t nvm_log_replay(iolink_nvm_log_t* log, uint8_t sector)
+{
+    const iolink_ds_storage_api_t* storage = log->storage;
+    uint32_t base = nvm_log_sector_addr(log, sector);
+    uint32_t off = NVM_LOG_SECTOR_HDR;
+    uint8_t buf[NVM_LOG_CHUNK];
+
+    while ((off + NVM_LOG_REC_HDR + NVM_LOG_REC_TRAILER) <= log->sector_size) {
+        uint8_t hdr[NVM_LOG_REC_HDR];
+        if (storage->read(base + off, hdr, sizeof(hdr)) != 0) {
+            return log->sector_size;
+        }
+        uint16_t len = (uint16_t) (hdr[0] | ((uint16_t) hdr[1] << 8U));
+        if ((len == 0xFFFFU) && (hdr[2] == 0xFFU) && (hdr[3] == 0xFFU)) {
+            return off; /* End of log in this sector */
+        }
+        uint32_t size = nvm_log_rec_size(len);
+        if (((uint8_t) (hdr[2] ^ hdr[3]) != 0xFFU) || (hdr[2] >= IOLINK_NVM_LOG_MAX_KEYS) ||
+            ((off + size) > log->sector_size)) {
+            log->stats.torn_records++;
+            return log->sector_size;
+        }
+        uint32_t next = off + size;
+
+        uint16_t crc = nvm_log_crc16(0xFFFFU, hdr, sizeof(hdr));
+        for (uint32_t done = 0U; done < len;) {
+            uint32_t chunk = ((len - done) > NVM_LOG_CHUNK) ? NVM_LOG_CHUNK : (len - done);
+            if (storage->read(base + off + NVM_LOG_REC_HDR + done, buf, chunk) != 0) {
+                return log->sector_size;
+            }
+            crc = nvm_log_crc16(crc, buf, chunk);
+            done += chunk;
+        }
+        uint8_t trailer[NVM_LOG_REC_TRAILER];
+        if (storage->read(base + off + size - NVM_LOG_REC_TRAILER, trailer, sizeof(trailer)) !=
+            0) {
+            return log->sector_size;
+        }
+        uint16_t stored = (uint16_t) (trailer[0] | ((uint16_t) trailer[1] << 8U));
+        if ((trailer[2] != 0x00U) || (trailer[3] != 0x00U) || (stored != crc)) {
+            /* Interrupted write: skip it, later records may follow */
+            log->stats.torn_records++;
+        }
+        else {
+            nvm_log_index_set(log, hdr[2], base + off, len);
+        }
+        off = next;
+    }
+    return off;
+}
+
+int iolink_nvm_log_mount(iolink_nvm_log_t* log, const iolink_ds_storage_api_t* storage,
+                         uint32_t sector_size, uint8_t sector_count)
+{
+    if (!iolink_ctx_zero(log, sizeof(*log))) {
+        return -1;
+    }
+    if ((storage == NULL) || (storage->read == NULL) || (storage->write == NULL) ||
+        (storage->erase == NULL) || ((sector_size % 4U) != 0U) || (sector_size < 64U) ||
+        (sector_count < 2U) || (sector_count > IOLINK_NVM_LOG_MAX_SECTORS)) {
+        return -1;
+    }
+    log->storage = storage;
+    log->sector_size = sector_size;
+    log->sector_count = sector_count;
+    for (uint8_t key = 0U; key < IOLINK_NVM_LOG_MAX_KEYS; key++) {
+        log->index[key].addr = NVM_LOG_NO_ADDR;
+    }
+
+    /* Classify sectors by header */
+    uint32_t seq[IOLINK_NVM_LOG_MAX_SECTORS];
+    uint32_t used = 0U;
+    for (uint8_t sector = 0U; sector < sector_count; sector++) {
+        uint8_t hdr[NVM_LOG_SECTOR_HDR];
+        if (storage->read(nvm_log_sector_addr(log, sector), hdr, sizeof(hdr)) != 0) {
+            return -1;
+        }
+        seq[sector] = nvm_log_get_u32(&hdr[0]);
+        if (nvm_log_get_u32(&hdr[4]) == NVM_LOG_MAGIC) {
+            used |= (1UL << sector);
+        }
+        else if (nvm_log_range_blank(log, nvm_log_sector_addr(log, sector), sector_size)) {
+            log->erased_mask |= (1UL << sector);
+        }
+        else if (nvm_log_erase(log, sector) != 0) {
+            return -1; /* Torn header or interrupted erase */
+        }
+    }
+    if (used == 0U) {
+        return iolink_nvm_log_format(log);
+    }
+
+    /* No erased sector left means a reclaim was cut off after opening its target.
+     * That sector holds only copies of records still in the oldest one: drop it. */
+    if (log->erased_mask == 0U) {
+        uint8_t newest = 0U;
+        for (uint8_t sector = 1U; sector < sector_count; sector++) {
+            if ((int32_t) (seq[sector] - seq[newest]) > 0) {
+                newest = sector;
+            }
+        }
+        if (nvm_log_erase(log, newest) != 0) {
+            return -1;
+        }
+        used &= ~(1UL << newest);
+    }
+
+    /* Replay oldest to newest so later records win */
+    while (used != 0U) {
+        uint8_t oldest = 0U;
+        bool found = false;
+        for (uint8_t sector = 0U; sector < sector_count; sector++) {
+            if (((used & (1UL << sector)) != 0U) &&
+                (!found || ((int32_t) (seq[sector] - seq[oldest]) < 0))) {
+                oldest = sector;
+                found = true;
+            }
+        }
+        used &= ~(1UL << oldest);
+        uint32_t end = nvm_log_replay(log, oldest);
+        log->head = oldest;
+        log->head_seq = seq[oldest];
+        log->head_offset = end;
+    }
+    return 0;
+}
+
+int iolink_nvm_log_read(iolink_nvm_log_t* log, uint8_t key, uint8_t* buf, size_t max_len)
+{
+    if ((log == NULL) || (log->storage == NULL) || (key >= IOLINK_NVM_LOG_MAX_KEYS) ||
+        !iolink_buf_is_valid(buf, max_len)) {
+        return -1;
+    }
+    const iolink_nvm_log_entry_t* entry = &log->index[key];
+    if (entry->addr == NVM_LOG_NO_ADDR) {
+        return -1;
+    }
+    size_t len = (entry->len < max_len) ? entry->len : max_len;
+    if ((len > 0U) && (log->storage->read(entry->addr + NVM_LOG_REC_HDR, buf, len) != 0)) {
+        return -1;
+    }
+    return (int) len;
+}
+
+int iolink_nvm_log_write(iolink_nvm_log_t* log, uint8_t key, const uint8_t* data, size_t len)
+{
+    if ((log == NULL) || (log->storage == NULL) || (key >= IOLINK_NVM_LOG_MAX_KEYS) ||
+        !iolink_buf_is_valid(data, len) || (len >= 0xFFFFU)) {
+        return -1;
+    }
+    uint32_t size = nvm_log_rec_size((uint32_t) len);
+    if (size > (log->sector_size - NVM_LOG_SECTOR_HDR)) {
+        return -1;
+    }
+
+    /* Every pass either fits, opens a sector or reclaims one; more passes than
+     * sectors means the log is full of live data. */
+    for (uint32_t pass = 0U; pass <= (2U * log->sector_count); pass++) {
+        if ((log->head_offset + size) <= log->sector_size) {
+            if (nvm_log_put(log, key, data, 0U, (uint16_t) len) != 0) {
+                return -1;
+            }
+            log->stats.records_written++;
+            return 0;
+        }
+        if (nvm_log_ensure_room(log, size) != 0) {
+            return -1;
+        }
+        /* Opening a sector may have used the last erased one: reclaim the oldest
+         * into the fresh head (its live data fits in one sector). */
+        if ((log->erased_mask == 0U) && (nvm_log_reclaim(log) != 0)) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+void iolink_nvm_log_process(iolink_nvm_log_t* log)
+{
+    if ((log == NULL) || (log->storage == NULL) || (nvm_log_erased_count(log) >= 2U)) {
+        return;
+    }
+    int victim = nvm_log_oldest(log);
+    if (victim < 0) {
+        return;
+    }
+    /* Only when no sector has to be opened, otherwise nothing is gained */
+    if (log->sector_live[victim] <= (log->sector_size - log->head_offset)) {
+        if (nvm_log_reclaim(log) == 0) {
+            log->stats.background_compactions++;
+        }
+    }
+}
+
+void iolink_nvm_log_get_stats(const iolink_nvm_log_t* log, iolink_nvm_log_stats_t* stats)
+{
+    if ((log == NULL) || (stats == NULL)) {
+        return;
+    }
+    *stats = log->stats;
+}
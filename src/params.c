@@ -9,7 +9,12 @@
 #include "iolinki/params.h"
 #include "iolinki/platform.h"
 #include "iolinki/device_info.h"
+#include "iolinki/protocol.h"
 #include "iolinki/utils.h"
+#include "iolinki/time_utils.h"
+#include "iolinki/config.h"
+#include "iolinki/nvm_log.h"
+#include <stddef.h>
 #include <string.h>
 
 #define PARAMS_NVM_MAGIC 0x494F4C31U /* "IOL1" */
@@ -25,19 +30,94 @@ typedef struct
 
 static iolink_params_nvm_t g_nvm_shadow;
 
-void iolink_params_init(void)
+#define PARAMS_TAG_MAX_LEN 32U
+
+/**
+ * @brief Parameter descriptor
+ *
+ * The tag indices are contiguous, so lookup is a direct table index.
+ */
+typedef struct
 {
-    /* Try to load from NVM */
-    if (iolink_nvm_read(0U, (uint8_t*) &g_nvm_shadow, sizeof(g_nvm_shadow)) == 0) {
-        if (g_nvm_shadow.magic == PARAMS_NVM_MAGIC) {
-            /* Sync with device info */
-            (void) iolink_device_info_set_application_tag(
-                g_nvm_shadow.application_tag, (uint8_t) strlen(g_nvm_shadow.application_tag));
-            return;
-        }
+    uint16_t index;           /**< ISDU Index */
+    size_t offset;            /**< Offset of the string in iolink_params_nvm_t */
+    bool mirrors_device_info; /**< Live value lives in iolink_device_info_t */
+} params_entry_t;
+
+static const params_entry_t g_params_table[] = {
+    {IOLINK_IDX_APPLICATION_TAG, offsetof(iolink_params_nvm_t, application_tag), true},
+    {IOLINK_IDX_FUNCTION_TAG, offsetof(iolink_params_nvm_t, function_tag), false},
+    {IOLINK_IDX_LOCATION_TAG, offsetof(iolink_params_nvm_t, location_tag), false},
+};
+
+#define PARAMS_TABLE_LEN (sizeof(g_params_table) / sizeof(g_params_table[0]))
+
+/*
+ * Write-behind state. Shared between the cycle path (iolink_params_set() from ISDU)
+ * and the background task running iolink_params_process(); guarded by critical
+ * sections. Dirty bit 0 is the header (magic), bit 1 + slot a table entry.
+ */
+#define PARAMS_DIRTY_HEADER 0x01U
+#define PARAMS_DIRTY_ENTRY(slot) (0x02U << (slot))
+#define PARAMS_DIRTY_ALL (PARAMS_DIRTY_ENTRY(PARAMS_TABLE_LEN) - 1U)
+
+static uint32_t g_dirty;          /**< PARAMS_DIRTY_* bits not yet in NVM */
+static uint32_t g_dirty_since_ms; /**< Time of the first unsaved change */
+static uint32_t g_pending_sets;   /**< Persisted sets since the last flush */
+static bool g_flush_requested;    /**< Flush on the next process run */
+static bool g_download_active;    /**< Block parametrization in progress */
+static bool g_nvm_valid;          /**< NVM holds an image with a valid header */
+static iolink_params_stats_t g_stats;
+static uint32_t g_revision;                         /**< Counts changes of any parameter */
+static uint32_t g_entry_revision[PARAMS_TABLE_LEN]; /**< g_revision at an entry's last change */
+static iolink_nvm_log_t* g_params_log; /**< Log backend, NULL for iolink_nvm_write() */
+static bool g_params_ready;            /**< iolink_params_init() has run */
+
+/* Caller holds the critical section */
+static void params_mark_dirty(uint32_t bits)
+{
+    if (!g_nvm_valid) {
+        /* Nothing valid in NVM yet: the first flush writes the whole image */
+        bits = PARAMS_DIRTY_ALL;
     }
+    if (g_dirty == 0U) {
+        g_dirty_since_ms = iolink_time_get_ms();
+    }
+    g_dirty |= bits;
+}
 
-    /* Init default state */
+/* Caller holds the critical section */
+static void params_touch(uint32_t slot)
+{
+    g_revision++;
+    g_entry_revision[slot] = g_revision;
+}
+
+static void params_touch_all(void)
+{
+    iolink_critical_enter();
+    for (uint32_t slot = 0U; slot < PARAMS_TABLE_LEN; slot++) {
+        params_touch(slot);
+    }
+    iolink_critical_exit();
+}
+
+static const params_entry_t* params_find(uint16_t index, uint8_t subindex)
+{
+    uint16_t slot = (uint16_t) (index - IOLINK_IDX_APPLICATION_TAG);
+    if ((subindex != 0U) || (slot >= PARAMS_TABLE_LEN)) {
+        return NULL;
+    }
+    return &g_params_table[slot];
+}
+
+static char* params_shadow_str(const params_entry_t* entry)
+{
+    return (char*) ((uint8_t*) &g_nvm_shadow + entry->offset);
+}
+
+static void params_load_defaults(void)
+{
     g_nvm_shadow.magic = PARAMS_NVM_MAGIC;
     const iolink_device_info_t* info = iolink_device_info_get();
     if ((info != NULL) && (info->application_tag != NULL)) {
@@ -55,96 +135,300 @@ void iolink_params_init(void)
     g_nvm_shadow.location_tag[0] = '\0';
 }
 
-int iolink_params_get(uint16_t index, uint8_t subindex, uint8_t* buffer, size_t max_len)
+/* Log backend: one record per table entry, keyed by its slot */
+static void params_load_log(void)
 {
-    if (buffer == NULL) {
-        return -1;
-    }
-    if ((index == 0x0018U) && (subindex == 0U)) {
-        const iolink_device_info_t* info = iolink_device_info_get();
-        if ((info != NULL) && (info->application_tag != NULL)) {
-            size_t len = strlen(info->application_tag);
-            if (len > max_len) {
-                len = max_len;
+    params_load_defaults();
+    for (uint8_t slot = 0U; slot < PARAMS_TABLE_LEN; slot++) {
+        char* shadow = params_shadow_str(&g_params_table[slot]);
+        int len = iolink_nvm_log_read(g_params_log, slot, (uint8_t*) shadow, PARAMS_TAG_MAX_LEN);
+        if (len >= 0) {
+            shadow[len] = '\0';
+            if (g_params_table[slot].mirrors_device_info) {
+                (void) iolink_device_info_set_application_tag(shadow, (uint8_t) len);
             }
-            (void) memcpy(buffer, info->application_tag, len);
-            return (int) len;
         }
     }
-    if ((index == 0x0019U) && (subindex == 0U)) {
-        size_t len = strlen(g_nvm_shadow.function_tag);
-        if (len > max_len) {
-            len = max_len;
+    g_nvm_valid = true; /* No header record needed */
+}
+
+void iolink_params_init(void)
+{
+    g_dirty = 0U;
+    g_pending_sets = 0U;
+    g_flush_requested = false;
+    g_download_active = false;
+    g_nvm_valid = false;
+    g_params_ready = true;
+    (void) memset(&g_stats, 0, sizeof(g_stats));
+    params_touch_all(); /* Values are reloaded below */
+
+    if (g_params_log != NULL) {
+        params_load_log();
+        return;
+    }
+
+    /* Try to load from NVM */
+    if (iolink_nvm_read(0U, (uint8_t*) &g_nvm_shadow, sizeof(g_nvm_shadow)) == 0) {
+        if (g_nvm_shadow.magic == PARAMS_NVM_MAGIC) {
+            g_nvm_valid = true;
+            /* Sync with device info */
+            (void) iolink_device_info_set_application_tag(
+                g_nvm_shadow.application_tag, (uint8_t) strlen(g_nvm_shadow.application_tag));
+            return;
         }
-        (void) memcpy(buffer, g_nvm_shadow.function_tag, len);
-        return (int) len;
     }
-    if ((index == 0x001AU) && (subindex == 0U)) {
-        size_t len = strlen(g_nvm_shadow.location_tag);
-        if (len > max_len) {
-            len = max_len;
+
+    /* Init default state */
+    params_load_defaults();
+}
+
+void iolink_params_init_once(void)
+{
+    if (!g_params_ready) {
+        iolink_params_init();
+    }
+}
+
+void iolink_params_use_nvm_log(iolink_nvm_log_t* log)
+{
+    g_params_log = log;
+}
+
+int iolink_params_get(uint16_t index, uint8_t subindex, uint8_t* buffer, size_t max_len)
+{
+    const params_entry_t* entry = params_find(index, subindex);
+    if ((buffer == NULL) || (entry == NULL)) {
+        return -1;
+    }
+
+    const char* value = params_shadow_str(entry);
+    if (entry->mirrors_device_info) {
+        const iolink_device_info_t* info = iolink_device_info_get();
+        if ((info == NULL) || (info->application_tag == NULL)) {
+            return -1;
         }
-        (void) memcpy(buffer, g_nvm_shadow.location_tag, len);
-        return (int) len;
+        value = info->application_tag;
     }
-    return -1;
+
+    size_t len = strlen(value);
+    if (len > max_len) {
+        len = max_len;
+    }
+    (void) memcpy(buffer, value, len);
+    return (int) len;
 }
 
 int iolink_params_set(uint16_t index, uint8_t subindex, const uint8_t* data, size_t len,
                       bool persist)
 {
-    if (!iolink_buf_is_valid(data, len)) {
+    const params_entry_t* entry = params_find(index, subindex);
+    if (!iolink_buf_is_valid(data, len) || (entry == NULL)) {
         return -1;
     }
-    if ((index == 0x0018U) && (subindex == 0U)) {
-        if (iolink_device_info_set_application_tag((const char*) data, (uint8_t) len) == 0) {
-            if (persist) {
-                size_t copy_len = (len > 32U) ? 32U : len;
-                if (copy_len > 0U) {
-                    (void) memcpy(g_nvm_shadow.application_tag, data, copy_len);
-                }
-                g_nvm_shadow.application_tag[copy_len] = '\0';
-                (void) iolink_nvm_write(0U, (uint8_t*) &g_nvm_shadow, sizeof(g_nvm_shadow));
-            }
-            return 0;
-        }
-    }
-    if ((index == 0x0019U) && (subindex == 0U)) {
-        size_t copy_len = (len > 32U) ? 32U : len;
-        if (copy_len > 0U) {
-            (void) memcpy(g_nvm_shadow.function_tag, data, copy_len);
+
+    uint32_t slot = (uint32_t) (entry - g_params_table);
+    if (entry->mirrors_device_info) {
+        if (iolink_device_info_set_application_tag((const char*) data, (uint8_t) len) != 0) {
+            return -1;
         }
-        g_nvm_shadow.function_tag[copy_len] = '\0';
-        if (persist) {
-            (void) iolink_nvm_write(0U, (uint8_t*) &g_nvm_shadow, sizeof(g_nvm_shadow));
+        if (!persist) {
+            iolink_critical_enter();
+            params_touch(slot);
+            iolink_critical_exit();
+            return 0; /* Shadow only tracks the persisted value */
         }
-        return 0;
     }
-    if ((index == 0x001AU) && (subindex == 0U)) {
-        size_t copy_len = (len > 32U) ? 32U : len;
-        if (copy_len > 0U) {
-            (void) memcpy(g_nvm_shadow.location_tag, data, copy_len);
-        }
-        g_nvm_shadow.location_tag[copy_len] = '\0';
-        if (persist) {
-            (void) iolink_nvm_write(0U, (uint8_t*) &g_nvm_shadow, sizeof(g_nvm_shadow));
-        }
-        return 0;
+
+    char* shadow = params_shadow_str(entry);
+    size_t copy_len = (len > PARAMS_TAG_MAX_LEN) ? PARAMS_TAG_MAX_LEN : len;
+    iolink_critical_enter();
+    if (copy_len > 0U) {
+        (void) memcpy(shadow, data, copy_len);
+    }
+    shadow[copy_len] = '\0';
+    params_touch(slot);
+    if (persist) {
+        /* Write-behind: NVM is updated by iolink_params_process() */
+        params_mark_dirty(PARAMS_DIRTY_ENTRY(slot));
+        g_pending_sets++;
+        g_stats.persisted_sets++;
     }
-    return -1;
+    iolink_critical_exit();
+    return 0;
 }
 
 void iolink_params_factory_reset(void)
 {
     /* Reset to factory defaults */
+    iolink_critical_enter();
     g_nvm_shadow.magic = PARAMS_NVM_MAGIC;
     g_nvm_shadow.application_tag[0] = '\0';
     g_nvm_shadow.function_tag[0] = '\0';
     g_nvm_shadow.location_tag[0] = '\0';
 
+    /* Rewrite the whole default image on the next process run */
+    params_mark_dirty(PARAMS_DIRTY_ALL);
+    g_flush_requested = true;
+    iolink_critical_exit();
+
     /* Clear device info application tag */
     (void) iolink_device_info_set_application_tag("", 0U);
+    params_touch_all();
+}
+
+static size_t params_field_start(uint32_t field)
+{
+    return (field == 0U) ? offsetof(iolink_params_nvm_t, magic)
+                         : g_params_table[field - 1U].offset;
+}
+
+static size_t params_field_end(uint32_t field)
+{
+    if (field == PARAMS_TABLE_LEN) {
+        return sizeof(iolink_params_nvm_t); /* Include trailing padding */
+    }
+    return (field == 0U) ? (offsetof(iolink_params_nvm_t, magic) + sizeof(uint32_t))
+                         : (g_params_table[field - 1U].offset + PARAMS_TAG_MAX_LEN + 1U);
+}
+
+/* Log backend: one appended record per dirty entry, no in-place rewrite */
+static int params_flush_log(uint32_t dirty, const iolink_params_nvm_t* image)
+{
+    uint32_t failed = 0U;
+    for (uint8_t slot = 0U; slot < PARAMS_TABLE_LEN; slot++) {
+        if ((dirty & PARAMS_DIRTY_ENTRY(slot)) == 0U) {
+            continue;
+        }
+        const char* value = (const char*) image + g_params_table[slot].offset;
+        if (iolink_nvm_log_write(g_params_log, slot, (const uint8_t*) value, strlen(value)) !=
+            0) {
+            failed |= PARAMS_DIRTY_ENTRY(slot);
+        }
+        iolink_critical_enter();
+        g_stats.nvm_writes++;
+        iolink_critical_exit();
+    }
+
+    iolink_critical_enter();
+    if (failed != 0U) {
+        g_stats.nvm_errors++;
+        params_mark_dirty(failed);
+    }
+    iolink_critical_exit();
+    return (failed == 0U) ? 0 : -1;
+}
+
+int iolink_params_flush(void)
+{
+    iolink_params_nvm_t image;
 
-    /* Erase NVM (write zeros or default structure) */
-    (void) iolink_nvm_write(0U, (uint8_t*) &g_nvm_shadow, sizeof(g_nvm_shadow));
+    iolink_critical_enter();
+    uint32_t dirty = g_dirty;
+    image = g_nvm_shadow;
+    g_dirty = 0U;
+    g_pending_sets = 0U;
+    g_flush_requested = false;
+    iolink_critical_exit();
+
+    if (dirty == 0U) {
+        return 0;
+    }
+    if (g_params_log != NULL) {
+        return params_flush_log(dirty, &image);
+    }
+
+    /* One write from the first to the last dirty field; clean fields in between
+     * are rewritten with their current value, which is cheaper than a second
+     * program/erase cycle. */
+    uint32_t first = 0U;
+    while ((dirty & (1UL << first)) == 0U) {
+        first++;
+    }
+    uint32_t last = first;
+    for (uint32_t field = first; field <= PARAMS_TABLE_LEN; field++) {
+        if ((dirty & (1UL << field)) != 0U) {
+            last = field;
+        }
+    }
+    size_t start = params_field_start(first);
+    size_t end = params_field_end(last);
+    int ret = iolink_nvm_write((uint32_t) start, (const uint8_t*) &image + start, end - start);
+
+    iolink_critical_enter();
+    g_stats.nvm_writes++;
+    if (ret != 0) {
+        /* Keep the data dirty; the next process run retries after the delay */
+        g_stats.nvm_errors++;
+        params_mark_dirty(dirty);
+    }
+    else if ((dirty & PARAMS_DIRTY_HEADER) != 0U) {
+        g_nvm_valid = true;
+    }
+    iolink_critical_exit();
+    return (ret == 0) ? 0 : -1;
+}
+
+void iolink_params_process(void)
+{
+    uint32_t now_ms = iolink_time_get_ms();
+
+    iolink_critical_enter();
+    bool due = (g_dirty != 0U) &&
+               (g_flush_requested ||
+                (!g_download_active && ((g_pending_sets >= IOLINK_PARAMS_FLUSH_COUNT) ||
+                                        ((now_ms - g_dirty_since_ms) >=
+                                         IOLINK_PARAMS_FLUSH_DELAY_MS))));
+    iolink_critical_exit();
+
+    if (due) {
+        (void) iolink_params_flush();
+    }
+}
+
+void iolink_params_download_start(void)
+{
+    iolink_critical_enter();
+    g_download_active = true;
+    iolink_critical_exit();
+}
+
+void iolink_params_download_end(bool commit)
+{
+    iolink_critical_enter();
+    g_download_active = false;
+    if (commit) {
+        g_flush_requested = true;
+    }
+    iolink_critical_exit();
+}
+
+uint32_t iolink_params_revision(uint16_t index, uint8_t subindex)
+{
+    const params_entry_t* entry = params_find(index, subindex);
+    if (entry == NULL) {
+        return 0U;
+    }
+    iolink_critical_enter();
+    uint32_t revision = g_entry_revision[entry - g_params_table];
+    iolink_critical_exit();
+    return revision;
+}
+
+bool iolink_params_dirty(void)
+{
+    iolink_critical_enter();
+    bool dirty = (g_dirty != 0U);
+    iolink_critical_exit();
+    return dirty;
+}
+
+void iolink_params_get_stats(iolink_params_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    iolink_critical_enter();
+    *stats = g_stats;
+    iolink_critical_exit();
 }
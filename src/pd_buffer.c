@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file pd_buffer.c
+ * @brief Wait-free triple buffer for Process Data exchange
+ */
+
+#include "iolinki/pd_buffer.h"
+#include "iolinki/atomic.h"
+
+#include <string.h>
+
+#define PD_BUFFER_INDEX_MASK 0x03U
+
+void iolink_pd_buffer_init(iolink_pd_buffer_t* buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+    (void) memset(buf->slots, 0, sizeof(buf->slots));
+    buf->back = 0U;
+    buf->front = 1U;
+    iolink_atomic_store_u32(&buf->shared, 2U);
+}
+
+iolink_pd_slot_t* iolink_pd_buffer_write_slot(iolink_pd_buffer_t* buf)
+{
+    return &buf->slots[buf->back];
+}
+
+void iolink_pd_buffer_publish(iolink_pd_buffer_t* buf)
+{
+    /* Release the filled slot, take back whichever slot was shared (read or not) */
+    uint32_t prev =
+        iolink_atomic_exchange_u32(&buf->shared, (uint32_t) buf->back | IOLINK_PD_BUFFER_FRESH);
+    buf->back = (uint8_t) (prev & PD_BUFFER_INDEX_MASK);
+}
+
+bool iolink_pd_buffer_acquire(iolink_pd_buffer_t* buf)
+{
+    if ((iolink_atomic_load_u32(&buf->shared) & IOLINK_PD_BUFFER_FRESH) == 0U) {
+        return false;
+    }
+    /* Only the consumer clears the fresh flag, so the check above cannot go stale */
+    uint32_t prev = iolink_atomic_exchange_u32(&buf->shared, (uint32_t) buf->front);
+    buf->front = (uint8_t) (prev & PD_BUFFER_INDEX_MASK);
+    return true;
+}
+
+const iolink_pd_slot_t* iolink_pd_buffer_read_slot(const iolink_pd_buffer_t* buf)
+{
+    return &buf->slots[buf->front];
+}
@@ -7,7 +7,7 @@
  */
 
 #include "iolinki/phy_virtual.h"
-#include <stdio.h>
+#include "iolinki/log.h"
 #include <fcntl.h>
 #include <unistd.h>
 #include <termios.h>
@@ -22,16 +22,21 @@ void iolink_phy_virtual_set_port(const char* port)
     g_port_path = port;
 }
 
+int iolink_phy_virtual_get_fd(void)
+{
+    return g_fd;
+}
+
 static int virtual_init(void)
 {
     if (g_port_path == NULL) {
-        printf("[PHY-VIRTUAL] Error: Port not set\n");
+        IOLINK_LOG_ERROR("PHY-VIRTUAL: port not set");
         return -1;
     }
 
     g_fd = open(g_port_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (g_fd < 0) {
-        printf("[PHY-VIRTUAL] Error opening %s: %s\n", g_port_path, strerror(errno));
+        IOLINK_LOG_ERROR("PHY-VIRTUAL: open failed, errno %d", errno);
         return -1;
     }
 
@@ -39,7 +44,7 @@ static int virtual_init(void)
     if (isatty(g_fd)) {
         struct termios tty;
         if (tcgetattr(g_fd, &tty) != 0) {
-            printf("[PHY-VIRTUAL] Error from tcgetattr: %s\n", strerror(errno));
+            IOLINK_LOG_ERROR("PHY-VIRTUAL: tcgetattr failed, errno %d", errno);
             return -1;
         }
 
@@ -50,25 +55,27 @@ static int virtual_init(void)
         tty.c_cc[VTIME] = 0U;
 
         if (tcsetattr(g_fd, TCSANOW, &tty) != 0) {
-            printf("[PHY-VIRTUAL] Error from tcsetattr: %s\n", strerror(errno));
+            IOLINK_LOG_ERROR("PHY-VIRTUAL: tcsetattr failed, errno %d", errno);
             return -1;
         }
-        printf("[PHY-VIRTUAL] Initialized TTY connection to %s (fd=%d)\n", g_port_path, g_fd);
+        IOLINK_LOG_INFO("PHY-VIRTUAL: TTY connection open (fd=%d)", g_fd);
     }
     else {
-        printf("[PHY-VIRTUAL] Initialized non-TTY connection to %s (fd=%d)\n", g_port_path, g_fd);
+        IOLINK_LOG_INFO("PHY-VIRTUAL: non-TTY connection open (fd=%d)", g_fd);
     }
     return 0;
 }
 
 static void virtual_set_mode(iolink_phy_mode_t mode)
 {
-    printf("[PHY-VIRTUAL] Mode set to: %d\n", (int) mode);
+    (void) mode;
+    IOLINK_LOG_DEBUG("PHY-VIRTUAL: mode %d", (int) mode);
 }
 
 static void virtual_set_baudrate(iolink_baudrate_t baudrate)
 {
-    printf("[PHY-VIRTUAL] Baudrate set to: %d\n", (int) baudrate);
+    (void) baudrate;
+    IOLINK_LOG_DEBUG("PHY-VIRTUAL: baudrate %d", (int) baudrate);
 }
 
 static int virtual_send(const uint8_t* data, size_t len)
@@ -92,6 +99,16 @@ static int virtual_recv_byte(uint8_t* byte)
     return (n > 0) ? 1 : 0;
 }
 
+static int virtual_recv_buf(uint8_t* buf, size_t len)
+{
+    if ((g_fd < 0) || (buf == NULL) || (len == 0U)) {
+        return 0;
+    }
+
+    ssize_t n = read(g_fd, buf, len);
+    return (n > 0) ? (int) n : 0;
+}
+
 static int virtual_detect_wakeup(void)
 {
     if (g_fd < 0) {
@@ -113,7 +130,8 @@ static const iolink_phy_api_t g_phy_virtual = {.init = virtual_init,
                                                .set_baudrate = virtual_set_baudrate,
                                                .send = virtual_send,
                                                .recv_byte = virtual_recv_byte,
-                                               .detect_wakeup = virtual_detect_wakeup};
+                                               .detect_wakeup = virtual_detect_wakeup,
+                                               .recv_buf = virtual_recv_buf};
 
 const iolink_phy_api_t* iolink_phy_virtual_get(void)
 {
@@ -24,7 +24,7 @@ uint32_t iolink_time_get_ms(void)
     return g_iolink_ticks_ms;
 }
 
-uint64_t iolink_time_get_us(void)
+iolink_usec_t iolink_time_get_us(void)
 {
     /* Rough approximation or need a high-res timer */
     return iolink_us_from_ms(g_iolink_ticks_ms);
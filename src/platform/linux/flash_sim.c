@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file flash_sim.c
+ * @brief File-backed NOR flash simulator with power-loss injection
+ *
+ * The image is cached in RAM and every change is written through to the file.
+ */
+
+#include "iolinki/flash_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLASH_SIM_MAX_SECTORS 32U
+
+static FILE* g_flash_fp;
+static uint8_t* g_flash_image;
+static uint32_t g_flash_size;
+static uint32_t g_flash_sector_size;
+static uint8_t g_flash_sector_count;
+static int32_t g_flash_budget = -1;
+static bool g_flash_lost;
+static uint32_t g_flash_erases[FLASH_SIM_MAX_SECTORS];
+
+static bool flash_sim_range_ok(uint32_t addr, size_t len)
+{
+    return (g_flash_image != NULL) && !g_flash_lost && (addr <= g_flash_size) &&
+           (len <= (size_t) (g_flash_size - addr));
+}
+
+/* Bytes of the next operation that complete before an injected power loss */
+static size_t flash_sim_take_budget(size_t len)
+{
+    if (g_flash_budget < 0) {
+        return len;
+    }
+    if ((size_t) g_flash_budget >= len) {
+        g_flash_budget -= (int32_t) len;
+        return len;
+    }
+    size_t done = (size_t) g_flash_budget;
+    g_flash_budget = 0;
+    g_flash_lost = true;
+    return done;
+}
+
+static int flash_sim_sync(uint32_t addr, size_t len)
+{
+    if ((fseek(g_flash_fp, (long) addr, SEEK_SET) != 0) ||
+        (fwrite(&g_flash_image[addr], 1U, len, g_flash_fp) != len) || (fflush(g_flash_fp) != 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int flash_sim_read(uint32_t addr, uint8_t* buf, size_t len)
+{
+    if ((buf == NULL) || !flash_sim_range_ok(addr, len)) {
+        return -1;
+    }
+    (void) memcpy(buf, &g_flash_image[addr], len);
+    return 0;
+}
+
+static int flash_sim_write(uint32_t addr, const uint8_t* buf, size_t len)
+{
+    if ((buf == NULL) || !flash_sim_range_ok(addr, len)) {
+        return -1;
+    }
+    size_t done = flash_sim_take_budget(len);
+    for (size_t i = 0U; i < done; i++) {
+        g_flash_image[addr + i] &= buf[i]; /* Programming only clears bits */
+    }
+    if ((flash_sim_sync(addr, done) != 0) || (done != len)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int flash_sim_erase(uint32_t addr, size_t len)
+{
+    if (!flash_sim_range_ok(addr, len) || ((addr % g_flash_sector_size) != 0U) ||
+        ((len % g_flash_sector_size) != 0U)) {
+        return -1;
+    }
+    for (uint32_t sector = addr / g_flash_sector_size;
+         sector < (uint32_t) ((addr + len) / g_flash_sector_size); sector++) {
+        g_flash_erases[sector]++;
+    }
+    /* An interrupted erase leaves the tail of the range untouched */
+    size_t done = flash_sim_take_budget(len);
+    (void) memset(&g_flash_image[addr], 0xFF, done);
+    if ((flash_sim_sync(addr, done) != 0) || (done != len)) {
+        return -1;
+    }
+    return 0;
+}
+
+static const iolink_ds_storage_api_t g_flash_sim_api = {
+    .read = flash_sim_read,
+    .write = flash_sim_write,
+    .erase = flash_sim_erase,
+};
+
+int iolink_flash_sim_open(const char* path, uint32_t sector_size, uint8_t sector_count)
+{
+    if ((path == NULL) || (sector_size == 0U) || (sector_count == 0U) ||
+        (sector_count > FLASH_SIM_MAX_SECTORS)) {
+        return -1;
+    }
+    iolink_flash_sim_close();
+
+    g_flash_size = sector_size * sector_count;
+    g_flash_image = (uint8_t*) malloc(g_flash_size);
+    if (g_flash_image == NULL) {
+        return -1;
+    }
+    (void) memset(g_flash_image, 0xFF, g_flash_size);
+
+    g_flash_fp = fopen(path, "r+b");
+    if (g_flash_fp != NULL) {
+        /* A shorter file reads as blank flash beyond its end */
+        (void) fread(g_flash_image, 1U, g_flash_size, g_flash_fp);
+    }
+    else {
+        g_flash_fp = fopen(path, "w+b");
+    }
+    if ((g_flash_fp == NULL) || (flash_sim_sync(0U, g_flash_size) != 0)) {
+        iolink_flash_sim_close();
+        return -1;
+    }
+
+    g_flash_sector_size = sector_size;
+    g_flash_sector_count = sector_count;
+    g_flash_budget = -1;
+    g_flash_lost = false;
+    (void) memset(g_flash_erases, 0, sizeof(g_flash_erases));
+    return 0;
+}
+
+void iolink_flash_sim_close(void)
+{
+    if (g_flash_fp != NULL) {
+        (void) fclose(g_flash_fp);
+        g_flash_fp = NULL;
+    }
+    free(g_flash_image);
+    g_flash_image = NULL;
+    g_flash_size = 0U;
+}
+
+const iolink_ds_storage_api_t* iolink_flash_sim_api(void)
+{
+    return &g_flash_sim_api;
+}
+
+void iolink_flash_sim_fail_after(int32_t bytes)
+{
+    g_flash_budget = (bytes < 0) ? -1 : bytes;
+}
+
+bool iolink_flash_sim_power_lost(void)
+{
+    return g_flash_lost;
+}
+
+uint32_t iolink_flash_sim_erase_count(uint8_t sector)
+{
+    return (sector < g_flash_sector_count) ? g_flash_erases[sector] : 0U;
+}
@@ -39,8 +39,11 @@ int iolink_nvm_write(uint32_t offset, const uint8_t* data, size_t len)
     if (!iolink_buf_is_valid(data, len)) {
         return -1;
     }
-    /* Use a+b to avoid truncating and create file if missing */
-    FILE* f = fopen(NVM_FILE, "a+b");
+    /* r+b keeps existing contents and honours the offset (a+b would append) */
+    FILE* f = fopen(NVM_FILE, "r+b");
+    if (f == NULL) {
+        f = fopen(NVM_FILE, "w+b");
+    }
     if (f == NULL) {
         return -1;
     }
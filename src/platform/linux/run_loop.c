@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file run_loop.c
+ * @brief Blocking epoll run loop with a timerfd for DLL deadlines
+ */
+
+#include "iolinki/run_loop.h"
+#include "iolinki/time_utils.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Arm the timer for the next DLL deadline, or disarm it when there is none */
+static int run_loop_arm_timer(iolink_run_loop_t* loop)
+{
+    struct itimerspec spec;
+    (void) memset(&spec, 0, sizeof(spec));
+
+    iolink_usec_t deadline_us;
+    if (iolink_instance_next_deadline_us(loop->inst, &deadline_us)) {
+        iolink_usec_t now_us = iolink_time_get_us();
+        uint64_t wait_us = 0U;
+        if (iolink_usec_before(now_us, deadline_us)) {
+            wait_us = (uint64_t) iolink_usec_elapsed(deadline_us, now_us);
+        }
+        /* A zero it_value disarms, so an overdue deadline fires after 1 ns */
+        spec.it_value.tv_sec = (time_t) (wait_us / 1000000U);
+        spec.it_value.tv_nsec = (long) ((wait_us % 1000000U) * 1000U);
+        if (wait_us == 0U) {
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    return timerfd_settime(loop->timerfd, 0, &spec, NULL);
+}
+
+int iolink_run_loop_init(iolink_run_loop_t* loop, iolink_instance_t* inst, int phy_fd)
+{
+    if ((loop == NULL) || (inst == NULL) || (phy_fd < 0)) {
+        return -1;
+    }
+    (void) memset(loop, 0, sizeof(*loop));
+    loop->inst = inst;
+    loop->phy_fd = phy_fd;
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    loop->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if ((loop->epfd < 0) || (loop->timerfd < 0)) {
+        iolink_run_loop_close(loop);
+        return -1;
+    }
+
+    struct epoll_event ev;
+    (void) memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = IOLINK_RUN_LOOP_IO;
+    if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, phy_fd, &ev) != 0) {
+        iolink_run_loop_close(loop);
+        return -1;
+    }
+    ev.data.u32 = IOLINK_RUN_LOOP_TIMER;
+    if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, loop->timerfd, &ev) != 0) {
+        iolink_run_loop_close(loop);
+        return -1;
+    }
+    return 0;
+}
+
+int iolink_run_loop_once(iolink_run_loop_t* loop, int max_wait_ms)
+{
+    if ((loop == NULL) || (loop->epfd < 0)) {
+        return -1;
+    }
+    if (run_loop_arm_timer(loop) != 0) {
+        return -1;
+    }
+
+    struct epoll_event events[2];
+    int n = epoll_wait(loop->epfd, events, 2, (max_wait_ms < 0) ? -1 : max_wait_ms);
+    if (n < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+        n = 0;
+    }
+
+    int result = 0;
+    for (int i = 0; i < n; i++) {
+        result |= (int) events[i].data.u32;
+    }
+    if ((result & IOLINK_RUN_LOOP_TIMER) != 0) {
+        uint64_t expirations;
+        (void) read(loop->timerfd, &expirations, sizeof(expirations));
+        loop->timer_wakeups++;
+    }
+    if ((result & IOLINK_RUN_LOOP_IO) != 0) {
+        loop->io_wakeups++;
+    }
+    if (result == 0) {
+        loop->idle_wakeups++;
+    }
+
+    iolink_instance_process(loop->inst);
+    return result;
+}
+
+void iolink_run_loop_close(iolink_run_loop_t* loop)
+{
+    if (loop == NULL) {
+        return;
+    }
+    if (loop->timerfd >= 0) {
+        (void) close(loop->timerfd);
+    }
+    if (loop->epfd >= 0) {
+        (void) close(loop->epfd);
+    }
+    loop->timerfd = -1;
+    loop->epfd = -1;
+}
@@ -18,11 +18,12 @@ uint32_t iolink_time_get_ms(void)
     return (uint32_t) ((uint64_t) ts.tv_sec * 1000U + (uint64_t) ts.tv_nsec / 1000000U);
 }
 
-uint64_t iolink_time_get_us(void)
+iolink_usec_t iolink_time_get_us(void)
 {
     struct timespec ts;
     if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
-        return 0ULL;
+        return 0U;
     }
-    return ((uint64_t) ts.tv_sec * 1000000ULL + (uint64_t) ts.tv_nsec / 1000ULL);
+    /* Truncates to the low 32 bits with IOLINK_TIMEBASE_32BIT */
+    return (iolink_usec_t) ((uint64_t) ts.tv_sec * 1000000ULL + (uint64_t) ts.tv_nsec / 1000ULL);
 }
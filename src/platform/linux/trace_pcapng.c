@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file trace_pcapng.c
+ * @brief pcapng writer for trace rings (host byte order, microsecond timestamps)
+ */
+
+#include "iolinki/trace_pcapng.h"
+#include <stdint.h>
+#include <string.h>
+
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0AU
+#define PCAPNG_BLOCK_IDB 0x00000001U
+#define PCAPNG_BLOCK_EPB 0x00000006U
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4DU
+#define PCAPNG_PSEUDO_HDR_LEN 4U
+
+static int pcapng_put(FILE* fp, const void* data, size_t len)
+{
+    return (fwrite(data, 1U, len, fp) == len) ? 0 : -1;
+}
+
+static int pcapng_put_u32(FILE* fp, uint32_t value)
+{
+    return pcapng_put(fp, &value, sizeof(value));
+}
+
+int iolink_trace_pcapng_begin(FILE* fp)
+{
+    if (fp == NULL) {
+        return -1;
+    }
+
+    /* Section Header Block: no options, unknown section length */
+    const uint32_t shb_len = 28U;
+    const uint16_t version[2] = {1U, 0U};
+    const int64_t section_len = -1;
+    int err = 0;
+    err |= pcapng_put_u32(fp, PCAPNG_BLOCK_SHB);
+    err |= pcapng_put_u32(fp, shb_len);
+    err |= pcapng_put_u32(fp, PCAPNG_BYTE_ORDER_MAGIC);
+    err |= pcapng_put(fp, version, sizeof(version));
+    err |= pcapng_put(fp, &section_len, sizeof(section_len));
+    err |= pcapng_put_u32(fp, shb_len);
+
+    /* Interface Description Block: default microsecond resolution */
+    const uint32_t idb_len = 20U;
+    const uint16_t link[2] = {(uint16_t) IOLINK_TRACE_PCAPNG_LINKTYPE, 0U};
+    err |= pcapng_put_u32(fp, PCAPNG_BLOCK_IDB);
+    err |= pcapng_put_u32(fp, idb_len);
+    err |= pcapng_put(fp, link, sizeof(link));
+    err |= pcapng_put_u32(fp, 0U); /* SnapLen: unlimited */
+    err |= pcapng_put_u32(fp, idb_len);
+
+    return (err != 0) ? -1 : 0;
+}
+
+int iolink_trace_pcapng_drain(iolink_trace_ring_t* ring, FILE* fp)
+{
+    if ((ring == NULL) || (fp == NULL)) {
+        return -1;
+    }
+
+    int count = 0;
+    iolink_trace_record_t rec;
+    while (iolink_trace_read(ring, &rec) > 0) {
+        uint8_t pkt[PCAPNG_PSEUDO_HDR_LEN + IOLINK_TRACE_MAX_DATA + 3U];
+        uint32_t cap_len = PCAPNG_PSEUDO_HDR_LEN + rec.len;
+        uint32_t padded = (cap_len + 3U) & ~3U;
+
+        (void) memset(pkt, 0, sizeof(pkt));
+        pkt[0] = rec.dir;
+        pkt[1] = rec.state;
+        pkt[2] = rec.flags;
+        pkt[3] = rec.len;
+        (void) memcpy(&pkt[PCAPNG_PSEUDO_HDR_LEN], rec.data, rec.len);
+
+        /* Enhanced Packet Block */
+        uint32_t block_len = 32U + padded;
+        int err = 0;
+        err |= pcapng_put_u32(fp, PCAPNG_BLOCK_EPB);
+        err |= pcapng_put_u32(fp, block_len);
+        err |= pcapng_put_u32(fp, 0U); /* Interface ID */
+        err |= pcapng_put_u32(fp, (uint32_t) (rec.ts_us >> 32));
+        err |= pcapng_put_u32(fp, (uint32_t) (rec.ts_us & 0xFFFFFFFFU));
+        err |= pcapng_put_u32(fp, cap_len);
+        err |= pcapng_put_u32(fp, cap_len);
+        err |= pcapng_put(fp, pkt, padded);
+        err |= pcapng_put_u32(fp, block_len);
+        if (err != 0) {
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
@@ -14,7 +14,7 @@ uint32_t iolink_time_get_ms(void)
     return (uint32_t) k_uptime_get();
 }
 
-uint64_t iolink_time_get_us(void)
+iolink_usec_t iolink_time_get_us(void)
 {
     /* k_ticks_to_us_near64(k_uptime_ticks()) is better but this is simple */
     return iolink_us_from_ms(k_uptime_get());
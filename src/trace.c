@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file trace.c
+ * @brief Binary frame trace ring
+ *
+ * Record layout: [hdr][ts delta varint (LEB128)][len][data...]
+ * hdr: bit 0 direction, bit 1 CRC OK, bits 2-4 DLL state.
+ */
+
+#include "iolinki/trace.h"
+#include "iolinki/atomic.h"
+#include "iolinki/utils.h"
+#include <string.h>
+
+#define TRACE_HDR_MAX 12U /* hdr + 10-byte varint + len */
+#define TRACE_MIN_SIZE 64U
+
+static void trace_copy_in(iolink_trace_ring_t* ring, uint32_t pos, const uint8_t* src,
+                          uint32_t len)
+{
+    uint32_t off = pos & ring->mask;
+    uint32_t first = (ring->mask + 1U) - off;
+    if (first > len) {
+        first = len;
+    }
+    (void) memcpy(&ring->buf[off], src, first);
+    if (len > first) {
+        (void) memcpy(ring->buf, &src[first], len - first);
+    }
+}
+
+static void trace_copy_out(const iolink_trace_ring_t* ring, uint32_t pos, uint8_t* dst,
+                           uint32_t len)
+{
+    uint32_t off = pos & ring->mask;
+    uint32_t first = (ring->mask + 1U) - off;
+    if (first > len) {
+        first = len;
+    }
+    (void) memcpy(dst, &ring->buf[off], first);
+    if (len > first) {
+        (void) memcpy(&dst[first], ring->buf, len - first);
+    }
+}
+
+int iolink_trace_init(iolink_trace_ring_t* ring, uint8_t* storage, uint32_t size)
+{
+    if ((storage == NULL) || (size < TRACE_MIN_SIZE) || ((size & (size - 1U)) != 0U) ||
+        !iolink_ctx_zero(ring, sizeof(iolink_trace_ring_t))) {
+        return -1;
+    }
+    ring->buf = storage;
+    ring->mask = size - 1U;
+    return 0;
+}
+
+bool iolink_trace_write(iolink_trace_ring_t* ring, uint8_t dir, uint8_t state, uint8_t flags,
+                        iolink_usec_t ts_us, const uint8_t* data, uint8_t len)
+{
+    if ((ring == NULL) || (ring->buf == NULL) || !iolink_buf_is_valid(data, len)) {
+        return false;
+    }
+    if (len > IOLINK_TRACE_MAX_DATA) {
+        len = IOLINK_TRACE_MAX_DATA;
+    }
+
+    uint8_t hdr[TRACE_HDR_MAX];
+    uint32_t n = 0U;
+    hdr[n++] = (uint8_t) ((dir & 0x01U) | ((flags & IOLINK_TRACE_FLAG_CRC_OK) << 1U) |
+                          ((state & 0x07U) << 2U));
+
+    /* Deltas are wrap-safe; out-of-order stamps are clamped to the previous one */
+    bool behind = ring->has_last && iolink_usec_before(ts_us, ring->last_ts_us);
+    uint64_t delta = behind ? 0U : (uint64_t) iolink_usec_elapsed(ts_us, ring->last_ts_us);
+    do {
+        uint8_t b = (uint8_t) (delta & 0x7FU);
+        delta >>= 7U;
+        if (delta != 0U) {
+            b |= 0x80U;
+        }
+        hdr[n++] = b;
+    } while (delta != 0U);
+    hdr[n++] = len;
+
+    uint32_t need = n + len;
+    uint32_t head = ring->head;
+    uint32_t tail = iolink_atomic_load_u32(&ring->tail);
+    if (((ring->mask + 1U) - (head - tail)) < need) {
+        iolink_atomic_store_u32(&ring->dropped, ring->dropped + 1U);
+        return false;
+    }
+
+    trace_copy_in(ring, head, hdr, n);
+    if (len > 0U) {
+        trace_copy_in(ring, head + n, data, len);
+    }
+    ring->last_ts_us = behind ? ring->last_ts_us : ts_us;
+    ring->has_last = true;
+    iolink_atomic_store_u32(&ring->head, head + need);
+    return true;
+}
+
+int iolink_trace_read(iolink_trace_ring_t* ring, iolink_trace_record_t* out)
+{
+    if ((ring == NULL) || (ring->buf == NULL) || (out == NULL)) {
+        return -1;
+    }
+
+    uint32_t tail = ring->tail;
+    uint32_t head = iolink_atomic_load_u32(&ring->head);
+    if (head == tail) {
+        return 0;
+    }
+
+    uint8_t b = ring->buf[tail & ring->mask];
+    tail++;
+    out->dir = b & 0x01U;
+    out->flags = (b >> 1U) & IOLINK_TRACE_FLAG_CRC_OK;
+    out->state = (b >> 2U) & 0x07U;
+
+    uint64_t delta = 0U;
+    uint8_t shift = 0U;
+    do {
+        b = ring->buf[tail & ring->mask];
+        tail++;
+        delta |= (uint64_t) (b & 0x7FU) << shift;
+        shift = (uint8_t) (shift + 7U);
+    } while (((b & 0x80U) != 0U) && (shift < 64U));
+    ring->read_ts_us += delta;
+    out->ts_us = ring->read_ts_us;
+
+    out->len = ring->buf[tail & ring->mask];
+    tail++;
+    trace_copy_out(ring, tail, out->data, out->len);
+    tail += out->len;
+
+    iolink_atomic_store_u32(&ring->tail, tail);
+    return 1;
+}
+
+uint32_t iolink_trace_dropped(const iolink_trace_ring_t* ring)
+{
+    return (ring != NULL) ? iolink_atomic_load_u32(&ring->dropped) : 0U;
+}
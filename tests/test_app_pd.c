@@ -124,10 +124,110 @@ static void test_pd_toggle_bit(void** state)
     iolink_process();
 }
 
+static uint8_t g_expected_resp[8];
+
+static int check_response_bytes(const LargestIntegralType value,
+                                const LargestIntegralType check_value_data)
+{
+    const uint8_t* data = (const uint8_t*) value;
+    size_t len = (size_t) check_value_data;
+    if (memcmp(data, g_expected_resp, len) != 0) {
+        print_error("Response does not match expected frame\n");
+        return 0;
+    }
+    return 1;
+}
+
+static void test_pd_response_prearmed(void** state)
+{
+    (void) state;
+    iolink_config_t config = {.pd_in_len = 2, .pd_out_len = 2, .m_seq_type = IOLINK_M_SEQ_TYPE_2_2};
+    setup_mock_phy();
+    will_return(mock_phy_init, 0);
+    iolink_init(&g_phy_mock, &config);
+    move_to_operate();
+
+    uint8_t input[2] = {0x11, 0x22};
+    iolink_pd_input_update(input, 2, true);
+
+    /* Idle pass: response is armed with the new PD_In before any request arrives */
+    will_return(mock_phy_recv_byte, 0);
+    iolink_process();
+    const iolink_dll_ctx_t* dll = &iolink_get_default_instance()->dll;
+    assert_true(dll->tx_armed);
+    assert_int_equal(dll->tx_buf[1], 0x11);
+    assert_int_equal(dll->tx_buf[2], 0x22);
+
+    /* Event raised after arming must still show up in the reply */
+    iolink_event_trigger(iolink_get_events_ctx(), IOLINK_EVENT_HW_GENERAL_FAULT,
+                         IOLINK_EVENT_TYPE_ERROR);
+
+    uint8_t frame[7] = {0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    frame[6] = iolink_crc6(frame, 6);
+    for (int i = 0; i < 7; i++) {
+        will_return(mock_phy_recv_byte, 1);
+        will_return(mock_phy_recv_byte, frame[i]);
+    }
+    will_return(mock_phy_recv_byte, 0);
+
+    g_expected_resp[0] =
+        IOLINK_OD_STATUS_EVENT | IOLINK_OD_STATUS_PD_TOGGLE | IOLINK_OD_STATUS_PD_VALID;
+    g_expected_resp[1] = 0x11;
+    g_expected_resp[2] = 0x22;
+    g_expected_resp[3] = 0x00;
+    g_expected_resp[4] = 0x00;
+    g_expected_resp[5] = iolink_crc6(g_expected_resp, 5);
+
+    expect_check(mock_phy_send, data, check_response_bytes, (void*) (uintptr_t) 6);
+    expect_value(mock_phy_send, len, 6);
+    will_return(mock_phy_send, 0);
+    iolink_process();
+}
+
+static void test_pd_latest_sample_wins(void** state)
+{
+    (void) state;
+    iolink_config_t config = {.pd_in_len = 2, .pd_out_len = 2, .m_seq_type = IOLINK_M_SEQ_TYPE_2_2};
+    setup_mock_phy();
+    will_return(mock_phy_init, 0);
+    iolink_init(&g_phy_mock, &config);
+    move_to_operate();
+
+    /* Several publishes between two requests: only the last one goes out, toggle flips once */
+    uint8_t first[2] = {0x01, 0x02};
+    uint8_t second[2] = {0x03, 0x04};
+    uint8_t latest[2] = {0x05, 0x06};
+    iolink_pd_input_update(first, 2, false);
+    iolink_pd_input_update(second, 2, false);
+    iolink_pd_input_update(latest, 2, true);
+
+    uint8_t frame[7] = {0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    frame[6] = iolink_crc6(frame, 6);
+    for (int i = 0; i < 7; i++) {
+        will_return(mock_phy_recv_byte, 1);
+        will_return(mock_phy_recv_byte, frame[i]);
+    }
+    will_return(mock_phy_recv_byte, 0);
+
+    g_expected_resp[0] = IOLINK_OD_STATUS_PD_TOGGLE | IOLINK_OD_STATUS_PD_VALID;
+    g_expected_resp[1] = 0x05;
+    g_expected_resp[2] = 0x06;
+    g_expected_resp[3] = 0x00;
+    g_expected_resp[4] = 0x00;
+    g_expected_resp[5] = iolink_crc6(g_expected_resp, 5);
+
+    expect_check(mock_phy_send, data, check_response_bytes, (void*) (uintptr_t) 6);
+    expect_value(mock_phy_send, len, 6);
+    will_return(mock_phy_send, 0);
+    iolink_process();
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_pd_toggle_bit),
+        cmocka_unit_test(test_pd_response_prearmed),
+        cmocka_unit_test(test_pd_latest_sample_wins),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
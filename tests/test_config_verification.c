@@ -28,18 +28,20 @@ static void test_config_defaults(void** state)
     /* Verify ISDU buffer size */
     iolink_isdu_ctx_t isdu;
     /* Expected: 2 buffers of IOLINK_ISDU_BUFFER_SIZE (256 default) + overhead */
-    assert_true(sizeof(isdu.buffer) == IOLINK_ISDU_BUFFER_SIZE);
-    assert_true(sizeof(isdu.response_buf) == IOLINK_ISDU_BUFFER_SIZE);
+    assert_true(sizeof(isdu.storage) == 2U * IOLINK_ISDU_BUFFER_SIZE);
+    iolink_isdu_init(&isdu);
+    assert_true(isdu.buffer == &isdu.storage[0]);
+    assert_true(isdu.response_buf == &isdu.storage[IOLINK_ISDU_BUFFER_SIZE]);
 
     /* Verify Event Queue */
     iolink_events_ctx_t events;
-    /* Expected: IOLINK_EVENT_QUEUE_SIZE (4 default) * sizeof(iolink_event_t) */
-    assert_true(sizeof(events.queue) / sizeof(iolink_event_t) == IOLINK_EVENT_QUEUE_SIZE);
+    /* Expected: IOLINK_EVENT_QUEUE_SIZE (4 default) slots */
+    assert_true(sizeof(events.cells) / sizeof(events.cells[0]) == IOLINK_EVENT_QUEUE_SIZE);
 
     /* Verify DLL Process Data buffers */
     iolink_dll_ctx_t dll;
-    assert_true(sizeof(dll.pd_in) == IOLINK_PD_IN_MAX_SIZE);
-    assert_true(sizeof(dll.pd_out) == IOLINK_PD_OUT_MAX_SIZE);
+    assert_true(sizeof(dll.pd_in.slots[0].data) >= IOLINK_PD_IN_MAX_SIZE);
+    assert_true(sizeof(dll.pd_out.slots[0].data) >= IOLINK_PD_OUT_MAX_SIZE);
 }
 
 int main(void)
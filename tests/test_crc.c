@@ -41,11 +41,62 @@ static void test_checksum_ck_basic(void** state)
     assert_int_equal(iolink_checksum_ck(0x00, 0x00), 0x24);
 }
 
+/* Bit-serial reference implementation (pre-table algorithm) */
+static uint8_t crc6_reference(const uint8_t* data, size_t len)
+{
+    uint8_t crc = 0x15U;
+    for (size_t i = 0U; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t j = 0U; j < 8U; j++) {
+            if ((crc & 0x80U) != 0U) {
+                crc = (uint8_t) ((crc << 1U) ^ (0x1DU << 2U));
+            }
+            else {
+                crc <<= 1U;
+            }
+        }
+    }
+    return (uint8_t) ((crc >> 2U) & 0x3FU);
+}
+
+static void test_crc6_table_matches_reference(void** state)
+{
+    (void) state;
+    uint8_t data[40];
+    uint32_t seed = 0x12345678U;
+    for (size_t i = 0U; i < sizeof(data); i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        data[i] = (uint8_t) (seed >> 16);
+    }
+
+    for (uint8_t len = 1U; len <= sizeof(data); len++) {
+        assert_int_equal(iolink_crc6(data, len), crc6_reference(data, len));
+    }
+
+    for (uint16_t b = 0U; b < 256U; b++) {
+        uint8_t one = (uint8_t) b;
+        assert_int_equal(iolink_crc6(&one, 1U), crc6_reference(&one, 1U));
+    }
+}
+
+static void test_crc6_incremental(void** state)
+{
+    (void) state;
+    const uint8_t frame[] = {0x80U, 0x00U, 0x5AU, 0xA5U, 0x3CU};
+    uint8_t crc = IOLINK_CRC6_SEED;
+    for (size_t i = 0U; i < sizeof(frame); i++) {
+        crc = iolink_crc6_update(crc, frame[i]);
+        assert_int_equal(iolink_crc6_final(crc), iolink_crc6(frame, (uint8_t) (i + 1U)));
+    }
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_crc6_basic),
         cmocka_unit_test(test_checksum_ck_basic),
+        cmocka_unit_test(test_crc6_table_matches_reference),
+        cmocka_unit_test(test_crc6_incremental),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -24,6 +24,90 @@
 #include "iolinki/crc.h"
 #include "test_helpers.h"
 
+/* Burst PHY: hands out pre-queued chunks through recv_buf only */
+static const uint8_t* g_burst_data;
+static const size_t* g_burst_sizes;
+static size_t g_burst_count;
+static size_t g_burst_next;
+static size_t g_burst_offset;
+static size_t g_burst_calls;
+static size_t g_burst_sent;
+
+static int burst_recv_buf(uint8_t* buf, size_t len)
+{
+    g_burst_calls++;
+    if (g_burst_next >= g_burst_count) {
+        return 0;
+    }
+    size_t n = g_burst_sizes[g_burst_next++];
+    assert_true(n <= len);
+    memcpy(buf, &g_burst_data[g_burst_offset], n);
+    g_burst_offset += n;
+    return (int) n;
+}
+
+static int burst_recv_byte(uint8_t* byte)
+{
+    (void) byte;
+    fail_msg("recv_byte must not be used when recv_buf is available");
+    return 0;
+}
+
+static int burst_send(const uint8_t* data, size_t len)
+{
+    (void) data;
+    g_burst_sent++;
+    return (int) len;
+}
+
+static const iolink_phy_api_t g_phy_burst = {
+    .send = burst_send, .recv_byte = burst_recv_byte, .recv_buf = burst_recv_buf};
+
+static void burst_feed(const uint8_t* data, const size_t* sizes, size_t count)
+{
+    g_burst_data = data;
+    g_burst_sizes = sizes;
+    g_burst_count = count;
+    g_burst_next = 0U;
+    g_burst_offset = 0U;
+    g_burst_calls = 0U;
+}
+
+/* Timestamping PHY: every byte carries a synthetic capture time */
+static const uint8_t* g_ts_data;
+static const iolink_usec_t* g_ts_stamps;
+static size_t g_ts_len;
+static size_t g_ts_pos;
+
+static int ts_recv_byte_ts(uint8_t* byte, iolink_usec_t* ts_us)
+{
+    if (g_ts_pos >= g_ts_len) {
+        return 0;
+    }
+    *byte = g_ts_data[g_ts_pos];
+    *ts_us = g_ts_stamps[g_ts_pos];
+    g_ts_pos++;
+    return 1;
+}
+
+static int ts_detect_wakeup(void)
+{
+    return 1;
+}
+
+static const iolink_phy_api_t g_phy_ts = {.send = burst_send,
+                                          .recv_byte = burst_recv_byte,
+                                          .detect_wakeup = ts_detect_wakeup,
+                                          .recv_byte_ts = ts_recv_byte_ts};
+
+static void ts_feed(const uint8_t* data, const iolink_usec_t* stamps, size_t len)
+{
+    g_ts_data = data;
+    g_ts_stamps = stamps;
+    g_ts_len = len;
+    g_ts_pos = 0U;
+}
+
 static int test_setup(void** state)
 {
     (void) state;
@@ -234,6 +318,134 @@ static void test_dll_reject_invalid_mc_channel(void** state)
     assert_int_not_equal(stats.framing_errors, 0);
 }
 
+static void test_dll_burst_receive(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    assert_int_equal(iolink_instance_init(&inst, &g_phy_burst, &config), 0);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+    iolink_dll_set_timing_enforcement(ctx, false);
+    iolink_dll_set_sdci_mode(ctx);
+    g_burst_sent = 0U;
+
+    /* Transition command and first Type 1 frame arrive in a single burst */
+    uint8_t rx[2 + 5 + 5];
+    rx[0] = IOLINK_MC_TRANSITION_COMMAND;
+    rx[1] = iolink_checksum_ck(rx[0], 0U);
+    uint8_t frame[5] = {0x80U, 0x00U, 0x11U, 0x00U, 0x00U};
+    frame[4] = iolink_crc6(frame, 4U);
+    memcpy(&rx[2], frame, sizeof(frame));
+
+    /* Second frame split across two bursts */
+    frame[2] = 0x22U;
+    frame[4] = iolink_crc6(frame, 4U);
+    memcpy(&rx[7], frame, sizeof(frame));
+
+    static const size_t sizes[] = {7U, 2U, 3U};
+    burst_feed(rx, sizes, 3U);
+    iolink_dll_process(ctx);
+
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_OPERATE);
+    assert_int_equal(g_burst_sent, 2U);
+    uint8_t out = 0U;
+    assert_int_equal(iolink_instance_pd_output_read(&inst, &out, 1U), 1);
+    assert_int_equal(out, 0x22U);
+    assert_int_equal(ctx->crc_errors, 0U);
+    assert_int_equal(ctx->framing_errors, 0U);
+    /* Three bursts plus the terminating empty read */
+    assert_int_equal(g_burst_calls, 4U);
+}
+
+static void test_dll_phy_timestamps(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    assert_int_equal(iolink_instance_init(&inst, &g_phy_ts, &config), 0);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+    iolink_dll_set_timing_enforcement(ctx, true);
+
+    ts_feed(NULL, NULL, 0U);
+    iolink_dll_process(ctx); /* Wake-up -> SDCI */
+    usleep(200);
+
+    uint8_t frame[5] = {0x80U, 0x00U, 0x00U, 0x00U, 0x00U};
+    frame[4] = iolink_crc6(frame, 4U);
+    uint8_t rx[2 + 5 + 5 + 5];
+    rx[0] = IOLINK_MC_TRANSITION_COMMAND;
+    rx[1] = iolink_checksum_ck(rx[0], 0U);
+    memcpy(&rx[2], frame, 5U);
+    memcpy(&rx[7], frame, 5U);
+    memcpy(&rx[12], frame, 5U);
+
+    /* All bytes arrive in one pass, but their capture times tell the real story:
+     * 40us byte spacing, a 5000us pause before frame 3 and a 1000us stall inside it
+     * (> 416us t_byte at COM2). The 32-bit timebase build starts just before the
+     * counter wraps, so the same checks run across the wrap. */
+#if IOLINK_TIMEBASE_32BIT
+    const iolink_usec_t t0 = 0xFFFFF000U;
+#else
+    const iolink_usec_t t0 = 1000000U;
+#endif
+    const iolink_usec_t stamps[sizeof(rx)] = {
+        t0,          t0 + 40U,    t0 + 400U,   t0 + 440U,   t0 + 480U,   t0 + 520U,
+        t0 + 560U,   t0 + 900U,   t0 + 940U,   t0 + 980U,   t0 + 1020U,  t0 + 1060U,
+        t0 + 6060U,  t0 + 6100U,  t0 + 7100U,  t0 + 7140U,  t0 + 7180U};
+    ts_feed(rx, stamps, sizeof(rx));
+    g_burst_sent = 0U;
+    iolink_dll_process(ctx);
+
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_OPERATE);
+    assert_int_equal(g_burst_sent, 2U);
+    assert_int_equal(ctx->t_byte_violations, 1U);
+
+    iolink_latency_hist_t hist;
+    assert_int_equal(iolink_dll_get_latency_histogram(ctx, IOLINK_LATENCY_BYTE_GAP, &hist), 0);
+    assert_int_equal(hist.max_us, 1000U);
+    assert_int_equal(iolink_dll_get_latency_histogram(ctx, IOLINK_LATENCY_CYCLE, &hist), 0);
+    assert_int_equal(hist.max_us, 520U); /* last byte of transition -> last byte of frame 1 */
+}
+
+/* Zero is an ordinary capture time: the 32-bit timebase passes it on every wrap */
+static void test_dll_timestamp_zero(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    assert_int_equal(iolink_instance_init(&inst, &g_phy_ts, &config), 0);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+    iolink_dll_set_timing_enforcement(ctx, true);
+
+    ts_feed(NULL, NULL, 0U);
+    iolink_dll_process(ctx); /* Wake-up -> SDCI */
+    usleep(200);
+
+    uint8_t rx[2 + 5] = {IOLINK_MC_TRANSITION_COMMAND, 0x00U, 0x80U, 0x00U, 0x00U, 0x00U, 0x00U};
+    rx[1] = iolink_checksum_ck(rx[0], 0U);
+    rx[6] = iolink_crc6(&rx[2], 4U);
+
+    /* 64-bit: the first byte is stamped 0. 32-bit: the transition frame ends (cycle
+     * start) at 0 after the wrap. */
+#if IOLINK_TIMEBASE_32BIT
+    const iolink_usec_t t0 = 0xFFFFFFD8U;
+#else
+    const iolink_usec_t t0 = 0U;
+#endif
+    const iolink_usec_t stamps[sizeof(rx)] = {t0,        t0 + 40U,  t0 + 540U, t0 + 580U,
+                                              t0 + 620U, t0 + 660U, t0 + 700U};
+    ts_feed(rx, stamps, sizeof(rx));
+    iolink_dll_process(ctx);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_OPERATE);
+
+    iolink_latency_hist_t hist;
+    assert_int_equal(iolink_dll_get_latency_histogram(ctx, IOLINK_LATENCY_BYTE_GAP, &hist), 0);
+    assert_int_equal(hist.count, 5U); /* One in the transition frame, four in frame 1 */
+    assert_int_equal(iolink_dll_get_latency_histogram(ctx, IOLINK_LATENCY_CYCLE, &hist), 0);
+    assert_int_equal(hist.count, 1U);
+    assert_int_equal(hist.max_us, 660U);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -244,6 +456,9 @@ int main(void)
                                         test_teardown),
         cmocka_unit_test_setup_teardown(test_dll_reject_invalid_mc_channel, test_setup,
                                         test_teardown),
+        cmocka_unit_test_setup_teardown(test_dll_burst_receive, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_dll_phy_timestamps, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_dll_timestamp_zero, test_setup, test_teardown),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
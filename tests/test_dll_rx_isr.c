@@ -0,0 +1,412 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_dll_rx_isr.c
+ * @brief Interrupt-driven receive: ISR frame assembly and the thread-level queue
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iolinki/iolink.h"
+#include "iolinki/dll.h"
+#include "iolinki/crc.h"
+#include "iolinki/time_utils.h"
+#include "iolinki/platform.h"
+#include "test_helpers.h"
+
+/* Interrupt-fed PHY: no recv hooks, replies are captured */
+static uint8_t g_isr_reply[IOLINK_DLL_TX_BUF_SIZE];
+static size_t g_isr_reply_len;
+static size_t g_isr_sent;
+static int g_isr_wakeup;
+static bool g_in_isr;
+static size_t g_phy_reconfigs;
+
+/*
+ * Interrupt model: the critical section masks the RX interrupt, and a byte
+ * burst that became due meanwhile is delivered when the outermost section
+ * ends. g_irq_when picks the moment; it is checked at every unmask.
+ */
+static int g_irq_mask_depth;
+static bool (*g_irq_when)(const iolink_dll_ctx_t* ctx);
+static iolink_dll_ctx_t* g_irq_ctx;
+static const uint8_t* g_irq_data;
+static size_t g_irq_len;
+static bool g_irq_fired;
+static bool g_irq_result;
+static size_t g_irq_sent; /* Replies sent by the injected burst itself */
+
+static bool isr_feed(iolink_dll_ctx_t* ctx, const uint8_t* data, size_t len);
+
+void iolink_critical_enter(void)
+{
+    g_irq_mask_depth++;
+}
+
+void iolink_critical_exit(void)
+{
+    assert_true(g_irq_mask_depth > 0);
+    g_irq_mask_depth--;
+    if ((g_irq_mask_depth == 0) && (g_irq_when != NULL) && g_irq_when(g_irq_ctx)) {
+        g_irq_when = NULL;
+        size_t sent = g_isr_sent;
+        g_irq_result = isr_feed(g_irq_ctx, g_irq_data, g_irq_len);
+        g_irq_sent = g_isr_sent - sent;
+        g_irq_fired = true;
+    }
+}
+
+static void irq_arm(bool (*when)(const iolink_dll_ctx_t* ctx), iolink_dll_ctx_t* ctx,
+                    const uint8_t* data, size_t len)
+{
+    g_irq_when = when;
+    g_irq_ctx = ctx;
+    g_irq_data = data;
+    g_irq_len = len;
+    g_irq_fired = false;
+    g_irq_result = false;
+    g_irq_sent = 0U;
+}
+
+static int isr_send(const uint8_t* data, size_t len)
+{
+    assert_true(len <= sizeof(g_isr_reply));
+    memcpy(g_isr_reply, data, len);
+    g_isr_reply_len = len;
+    g_isr_sent++;
+    return (int) len;
+}
+
+static int isr_detect_wakeup(void)
+{
+    int detected = g_isr_wakeup;
+    g_isr_wakeup = 0;
+    return detected;
+}
+
+/* The PHY is never reconfigured from interrupt context */
+static void isr_set_mode(iolink_phy_mode_t mode)
+{
+    (void) mode;
+    assert_false(g_in_isr);
+    g_phy_reconfigs++;
+}
+
+static void isr_set_baudrate(iolink_baudrate_t baudrate)
+{
+    (void) baudrate;
+    assert_false(g_in_isr);
+    g_phy_reconfigs++;
+}
+
+static const iolink_phy_api_t g_phy_isr = {.set_mode = isr_set_mode,
+                                           .set_baudrate = isr_set_baudrate,
+                                           .send = isr_send,
+                                           .detect_wakeup = isr_detect_wakeup};
+
+static bool isr_feed(iolink_dll_ctx_t* ctx, const uint8_t* data, size_t len)
+{
+    /* An interrupt cannot preempt a masked section */
+    assert_int_equal(g_irq_mask_depth, 0);
+    bool pending = false;
+    g_in_isr = true;
+    for (size_t i = 0U; i < len; i++) {
+        pending = iolink_dll_rx_isr(ctx, data[i], iolink_time_get_us());
+    }
+    g_in_isr = false;
+    return pending;
+}
+
+/* Type 1_1 request: MC | CKT | PD_Out | OD | CK */
+static void isr_make_frame(uint8_t frame[5], uint8_t pd_out, uint8_t od)
+{
+    frame[0] = 0x80U;
+    frame[1] = 0x00U;
+    frame[2] = pd_out;
+    frame[3] = od;
+    frame[4] = iolink_crc6(frame, 4U);
+}
+
+static bool isr_frame(iolink_dll_ctx_t* ctx, uint8_t od)
+{
+    uint8_t frame[5];
+    isr_make_frame(frame, 0x00U, od);
+    return isr_feed(ctx, frame, sizeof(frame));
+}
+
+static void isr_setup(iolink_instance_t* inst)
+{
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    assert_int_equal(iolink_instance_init(inst, &g_phy_isr, &config), 0);
+    iolink_dll_set_timing_enforcement(&inst->dll, false);
+    g_isr_sent = 0U;
+    g_isr_reply_len = 0U;
+    g_isr_wakeup = 0;
+    g_phy_reconfigs = 0U;
+    g_irq_when = NULL;
+}
+
+/* Wake-up and start-up through the queue, up to ESTAB_COM */
+static void isr_to_estab_com(iolink_instance_t* inst)
+{
+    iolink_dll_ctx_t* ctx = &inst->dll;
+    g_isr_wakeup = 1;
+    iolink_instance_process(inst);
+
+    uint8_t trans[2] = {IOLINK_MC_TRANSITION_COMMAND, 0x00U};
+    trans[1] = iolink_checksum_ck(trans[0], 0U);
+    assert_true(isr_feed(ctx, trans, sizeof(trans)));
+    iolink_instance_process(inst);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_ESTAB_COM);
+}
+
+static void isr_to_operate(iolink_instance_t* inst)
+{
+    isr_to_estab_com(inst);
+    assert_true(isr_frame(&inst->dll, 0x00U));
+    iolink_instance_process(inst);
+    assert_int_equal(inst->dll.state, IOLINK_DLL_STATE_OPERATE);
+}
+
+/* Start-up bytes go through the queue; in OPERATE the ISR answers by itself */
+static void test_rx_isr_operate_reply(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    isr_setup(&inst);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+
+    g_isr_wakeup = 1;
+    iolink_instance_process(&inst);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_AWAITING_COMM);
+
+    uint8_t idle[2] = {0x00U, 0x00U};
+    idle[1] = iolink_checksum_ck(idle[0], 0U);
+    assert_true(isr_feed(ctx, idle, sizeof(idle)));
+    assert_int_equal(g_isr_sent, 0U);
+    iolink_instance_process(&inst);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_PREOPERATE);
+    assert_int_equal(g_isr_sent, 1U);
+
+    uint8_t trans[2] = {IOLINK_MC_TRANSITION_COMMAND, 0x00U};
+    trans[1] = iolink_checksum_ck(trans[0], 0U);
+    assert_true(isr_feed(ctx, trans, sizeof(trans)));
+    iolink_instance_process(&inst);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_ESTAB_COM);
+
+    uint8_t frame[5] = {0x80U, 0x00U, 0x11U, 0x00U, 0x00U};
+    frame[4] = iolink_crc6(frame, 4U);
+    assert_true(isr_feed(ctx, frame, sizeof(frame)));
+    iolink_instance_process(&inst);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_OPERATE);
+    assert_int_equal(g_isr_sent, 2U);
+
+    /* Cyclic frame: reply with the latest PD_In leaves from the last ISR call */
+    uint8_t in = 0x5AU;
+    assert_int_equal(iolink_instance_pd_input_update(&inst, &in, 1U, true), 0);
+    frame[2] = 0x22U;
+    frame[4] = iolink_crc6(frame, 4U);
+    assert_false(isr_feed(ctx, frame, 4U));
+    assert_int_equal(g_isr_sent, 2U);
+    assert_false(iolink_dll_rx_isr(ctx, frame[4], iolink_time_get_us()));
+    assert_int_equal(g_isr_sent, 3U);
+    assert_int_equal(g_isr_reply_len, 4U);
+    assert_int_equal(g_isr_reply[1], 0x5AU);
+    assert_int_equal(g_isr_reply[3], iolink_crc6(g_isr_reply, 3U));
+
+    uint8_t out = 0U;
+    assert_int_equal(iolink_instance_pd_output_read(&inst, &out, 1U), 1);
+    assert_int_equal(out, 0x22U);
+    assert_int_equal(ctx->crc_errors, 0U);
+
+    /* Nothing left for the thread */
+    iolink_usec_t deadline;
+    assert_true(iolink_dll_next_deadline(ctx, &deadline));
+    assert_true(iolink_usec_before(iolink_time_get_us(), deadline));
+}
+
+static void test_rx_isr_queue_overflow(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    isr_setup(&inst);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+
+    for (uint32_t i = 0U; i < IOLINK_DLL_RX_QUEUE_SIZE + 3U; i++) {
+        assert_true(iolink_dll_rx_isr(ctx, 0x00U, iolink_time_get_us()));
+    }
+    iolink_dll_stats_t stats;
+    iolink_dll_get_stats(ctx, &stats);
+    assert_int_equal(stats.rx_queue_drops, 3U);
+
+    /* Queued bytes keep the thread awake until a pass takes them */
+    iolink_usec_t deadline;
+    assert_true(iolink_dll_next_deadline(ctx, &deadline));
+    assert_int_equal(deadline, ctx->pass_us);
+
+    /* SIO mode has no framing: the queue is dropped */
+    iolink_instance_process(&inst);
+    assert_int_equal(ctx->rx_q_head, ctx->rx_q_tail);
+    assert_int_equal(g_isr_sent, 0U);
+}
+
+static bool irq_when_response_ready(const iolink_dll_ctx_t* ctx)
+{
+    return ctx->isdu.state == ISDU_STATE_RESPONSE_READY;
+}
+
+/*
+ * The master starts a new ISDU request in the interrupt that fires right after
+ * the thread publishes the previous response. The new request must survive
+ * the rest of the thread's pass.
+ */
+static void test_rx_isr_isdu_request_after_dispatch(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    isr_setup(&inst);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+    isr_to_operate(&inst);
+
+    /* Read Vendor Name (0x0010), one OD byte per cycle */
+    static const uint8_t request[] = {0x80U, 0x80U, 0x01U, 0x00U, 0x02U, 0x10U, 0x43U, 0x00U};
+    for (size_t i = 0U; (i + 1U) < sizeof(request); i++) {
+        assert_false(isr_frame(ctx, request[i]));
+    }
+    assert_true(isr_frame(ctx, request[sizeof(request) - 1U]));
+    assert_int_equal(ctx->isdu.state, ISDU_STATE_SERVICE_EXECUTE);
+
+    uint8_t restart[5];
+    isr_make_frame(restart, 0x00U, request[0]);
+    irq_arm(irq_when_response_ready, ctx, restart, sizeof(restart));
+    iolink_instance_process(&inst);
+    assert_true(g_irq_fired);
+    assert_int_equal(g_irq_sent, 1U); /* Answered from the ISR, OD empty */
+    assert_int_equal(ctx->isdu.state, ISDU_STATE_HEADER_INITIAL);
+
+    /* The new request completes and is answered */
+    for (size_t i = 1U; (i + 1U) < sizeof(request); i++) {
+        assert_false(isr_frame(ctx, request[i]));
+    }
+    assert_true(isr_frame(ctx, request[sizeof(request) - 1U]));
+    iolink_instance_process(&inst);
+    assert_int_equal(ctx->isdu.state, ISDU_STATE_RESPONSE_READY);
+
+    assert_false(isr_frame(ctx, 0x00U));
+    assert_true((g_isr_reply[2] & IOLINK_ISDU_CTRL_START) != 0U);
+    size_t frames = 1U;
+    while ((ctx->isdu.state == ISDU_STATE_RESPONSE_READY) && (frames < 256U)) {
+        assert_false(isr_frame(ctx, 0x00U));
+        frames++;
+    }
+    assert_int_equal(ctx->isdu.state, ISDU_STATE_IDLE);
+    assert_true(frames > 2U);
+}
+
+static bool irq_when_draining_in_operate(const iolink_dll_ctx_t* ctx)
+{
+    return (ctx->state == IOLINK_DLL_STATE_OPERATE) && (ctx->rx_q_tail != ctx->rx_q_head);
+}
+
+/*
+ * A frame arrives while the thread is still working through queued bytes, just
+ * after the queue brought the link to OPERATE. The ISR must not take over
+ * assembly before the queue is empty: the frame is queued and answered in order.
+ */
+static void test_rx_isr_queue_handoff(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    isr_setup(&inst);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+    isr_to_estab_com(&inst);
+
+    uint8_t first[5];
+    uint8_t second[5];
+    isr_make_frame(first, 0x11U, 0x00U);
+    isr_make_frame(second, 0x22U, 0x00U);
+    assert_true(isr_feed(ctx, first, sizeof(first)));
+
+    size_t sent = g_isr_sent;
+    irq_arm(irq_when_draining_in_operate, ctx, second, sizeof(second));
+    iolink_instance_process(&inst);
+    assert_true(g_irq_fired);
+    assert_true(g_irq_result);
+    assert_int_equal(g_irq_sent, 0U);
+
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_OPERATE);
+    assert_int_equal(g_isr_sent, sent + 2U);
+    assert_int_equal(ctx->rx_q_head, ctx->rx_q_tail);
+    assert_int_equal(ctx->crc_errors, 0U);
+    uint8_t out = 0U;
+    assert_int_equal(iolink_instance_pd_output_read(&inst, &out, 1U), 1);
+    assert_int_equal(out, 0x22U);
+
+    /* Queue empty again: the next frame is answered from the ISR */
+    assert_false(isr_frame(ctx, 0x00U));
+    assert_int_equal(g_isr_sent, sent + 3U);
+}
+
+/* Repeated CRC errors in the ISR: the fallback to SIO is left to the thread */
+static void test_rx_isr_fallback_deferred(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    isr_setup(&inst);
+    iolink_dll_ctx_t* ctx = &inst.dll;
+    isr_to_operate(&inst);
+    g_phy_reconfigs = 0U;
+
+    uint8_t bad[5];
+    isr_make_frame(bad, 0x00U, 0x00U);
+    bad[4] ^= 0x01U;
+    assert_false(isr_feed(ctx, bad, sizeof(bad)));
+    assert_false(isr_feed(ctx, bad, sizeof(bad)));
+    assert_true(isr_feed(ctx, bad, sizeof(bad)));
+    assert_int_equal(ctx->crc_errors, 3U);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_OPERATE);
+    assert_int_equal(ctx->phy_mode, IOLINK_PHY_MODE_SDCI);
+    assert_int_equal(g_phy_reconfigs, 0U);
+
+    /* Fast path is off until the thread has applied it */
+    size_t sent = g_isr_sent;
+    uint32_t head = ctx->rx_q_head;
+    assert_true(isr_frame(ctx, 0x00U));
+    assert_int_equal(ctx->rx_q_head, head + 5U);
+    assert_int_equal(g_isr_sent, sent);
+    iolink_usec_t deadline;
+    assert_true(iolink_dll_next_deadline(ctx, &deadline));
+    assert_int_equal(deadline, ctx->pass_us);
+
+    iolink_instance_process(&inst);
+    assert_int_equal(ctx->state, IOLINK_DLL_STATE_STARTUP);
+    assert_int_equal(ctx->phy_mode, IOLINK_PHY_MODE_SIO);
+    assert_int_equal(ctx->baudrate, IOLINK_BAUDRATE_COM1);
+    assert_true(g_phy_reconfigs > 0U);
+    assert_false(ctx->fallback_pending);
+    assert_int_equal(ctx->rx_q_head, ctx->rx_q_tail);
+    assert_int_equal(ctx->total_retries, 3U);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_rx_isr_operate_reply),
+        cmocka_unit_test(test_rx_isr_queue_overflow),
+        cmocka_unit_test(test_rx_isr_isdu_request_after_dispatch),
+        cmocka_unit_test(test_rx_isr_queue_handoff),
+        cmocka_unit_test(test_rx_isr_fallback_deferred),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -16,11 +16,19 @@
 #include <setjmp.h>
 #include <cmocka.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "iolinki/data_storage.h"
+#include "iolinki/device_info.h"
+#include "iolinki/flash_sim.h"
+#include "iolinki/isdu.h"
+#include "iolinki/params.h"
 #include "test_helpers.h"
 
+#define DS_FLASH_FILE "test_ds_flash.bin"
+#define DS_IMAGE_MAX 128U
+
 static void test_ds_checksum(void** state)
 {
     (void) state;
@@ -34,6 +42,83 @@ static void test_ds_checksum(void** state)
     assert_int_not_equal(cs1, cs3);
 }
 
+/* Per-byte reference, as the checksum was originally specified */
+static uint16_t ds_reference_checksum(const uint8_t* data, size_t len)
+{
+    uint16_t sum1 = 0U;
+    uint16_t sum2 = 0U;
+    for (size_t i = 0U; i < len; ++i) {
+        sum1 = (uint16_t) ((sum1 + data[i]) % 255U);
+        sum2 = (uint16_t) ((sum2 + sum1) % 255U);
+    }
+    return (uint16_t) ((sum2 << 8U) | sum1);
+}
+
+static void test_ds_checksum_matches_reference(void** state)
+{
+    (void) state;
+    static uint8_t data[9000];
+    uint32_t seed = 0x1234567U;
+    for (size_t i = 0U; i < sizeof(data); i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        data[i] = (uint8_t) (seed >> 16U);
+    }
+    (void) memset(&data[100], 0xFF, 5000U); /* Worst case for the chunk sums */
+
+    const size_t lens[] = {0U, 1U, 2U, 254U, 255U, 256U, 4095U, 4096U, 4097U, 9000U};
+    for (size_t i = 0U; i < (sizeof(lens) / sizeof(lens[0])); i++) {
+        assert_int_equal(iolink_ds_calc_checksum(data, lens[i]),
+                         ds_reference_checksum(data, lens[i]));
+    }
+}
+
+/* The cached checksum equals the checksum of a freshly generated image */
+static void ds_expect_image_checksum(iolink_ds_ctx_t* ds)
+{
+    uint8_t image[DS_IMAGE_MAX];
+    size_t size = iolink_ds_image_open(ds);
+    uint16_t cached = ds->current_checksum;
+    for (size_t i = 0U; i < size; i++) {
+        image[i] = iolink_ds_image_byte(ds, i);
+    }
+    assert_int_equal(cached, iolink_ds_calc_checksum(image, size - 2U));
+    assert_int_equal(((uint16_t) image[size - 2U] << 8U) | image[size - 1U], cached);
+}
+
+static void test_ds_checksum_incremental(void** state)
+{
+    (void) state;
+    iolink_ds_ctx_t ds;
+    iolink_ds_stats_t stats;
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    iolink_ds_init(&ds, NULL);
+    iolink_ds_get_stats(&ds, &stats);
+    assert_int_equal(stats.records_serialized, IOLINK_DS_PARAM_COUNT); /* Boot: full pass */
+    ds_expect_image_checksum(&ds);
+
+    /* Unchanged parameters: checks do not touch them */
+    uint16_t checksum = ds.current_checksum;
+    for (int i = 0; i < 50; i++) {
+        iolink_ds_check(&ds, checksum);
+    }
+    iolink_ds_get_stats(&ds, &stats);
+    assert_int_equal(stats.records_serialized, IOLINK_DS_PARAM_COUNT);
+    assert_int_equal(ds.state, IOLINK_DS_STATE_IDLE);
+
+    /* One change: one record is serialized again, merged in place */
+    const char* tag = "cell-9";
+    assert_int_equal(iolink_params_set(IOLINK_IDX_FUNCTION_TAG, 0U, (const uint8_t*) tag,
+                                       strlen(tag), false),
+                     0);
+    iolink_ds_check(&ds, checksum);
+    iolink_ds_get_stats(&ds, &stats);
+    assert_int_equal(stats.records_serialized, IOLINK_DS_PARAM_COUNT + 1U);
+    assert_int_not_equal(ds.current_checksum, checksum);
+    assert_int_equal(ds.state, IOLINK_DS_STATE_DOWNLOAD_REQ);
+    ds_expect_image_checksum(&ds);
+}
+
 static void test_ds_storage_integration(void** state)
 {
     (void) state;
@@ -59,14 +144,18 @@ static void test_ds_state_transitions(void** state)
     iolink_ds_check(&ds, 0xABCD);
     iolink_ds_process(&ds); /* Req -> Downloading */
     assert_int_equal(ds.state, IOLINK_DS_STATE_DOWNLOADING);
-    iolink_ds_process(&ds); /* Downloading -> Idle */
-    assert_int_equal(ds.state, IOLINK_DS_STATE_IDLE);
+    iolink_ds_process(&ds); /* Transfer is driven by the master */
+    assert_int_equal(ds.state, IOLINK_DS_STATE_DOWNLOADING);
+    assert_int_equal(iolink_ds_handle_command(&ds, IOLINK_CMD_PARAM_DOWNLOAD_END, 0), 0);
+    assert_int_equal(ds.state, IOLINK_DS_STATE_IDLE); /* Nothing staged, nothing to commit */
 
     /* 2. Trigger Upload (Master has 0x0000 - empty) */
     iolink_ds_check(&ds, 0x0000);
     iolink_ds_process(&ds); /* Req -> Uploading */
     assert_int_equal(ds.state, IOLINK_DS_STATE_UPLOADING);
-    iolink_ds_process(&ds); /* Uploading -> Idle */
+    iolink_ds_process(&ds);
+    assert_int_equal(ds.state, IOLINK_DS_STATE_UPLOADING);
+    assert_int_equal(iolink_ds_handle_command(&ds, IOLINK_CMD_PARAM_UPLOAD_END, 0), 0);
     assert_int_equal(ds.state, IOLINK_DS_STATE_IDLE);
 }
 
@@ -109,12 +198,294 @@ static void test_ds_commands_unlocked(void** state)
     assert_int_equal(ds.state, IOLINK_DS_STATE_IDLE);
 }
 
+/* Streamed transfer over index 0x0003 with the image in simulated flash */
+static iolink_isdu_ctx_t g_isdu;
+static iolink_ds_ctx_t g_ds;
+
+/* Parameter NVM that survives a simulated power loss (overrides the weak stubs) */
+static uint8_t g_nvm[512];
+static bool g_nvm_valid;
+
+int iolink_nvm_read(uint32_t offset, uint8_t* data, size_t len)
+{
+    if (!g_nvm_valid || (offset > sizeof(g_nvm)) || (len > (sizeof(g_nvm) - offset))) {
+        return -1;
+    }
+    (void) memcpy(data, &g_nvm[offset], len);
+    return 0;
+}
+
+int iolink_nvm_write(uint32_t offset, const uint8_t* data, size_t len)
+{
+    if ((offset > sizeof(g_nvm)) || (len > (sizeof(g_nvm) - offset))) {
+        return -1;
+    }
+    (void) memcpy(&g_nvm[offset], data, len);
+    g_nvm_valid = true;
+    return 0;
+}
+
+static void ds_nvm_erase(void)
+{
+    (void) memset(g_nvm, 0xFF, sizeof(g_nvm));
+    g_nvm_valid = false;
+}
+
+static void ds_device_boot(void)
+{
+    assert_int_equal(iolink_flash_sim_open(DS_FLASH_FILE, IOLINK_DS_SLOT_SIZE, 2U), 0);
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    iolink_ds_init(&g_ds, iolink_flash_sim_api());
+    iolink_isdu_init(&g_isdu);
+    g_isdu.ds_ctx = &g_ds;
+}
+
+/* Reopen the flash and restart the DS engine; parameter RAM is kept */
+static void ds_storage_reboot(void)
+{
+    iolink_flash_sim_close();
+    assert_int_equal(iolink_flash_sim_open(DS_FLASH_FILE, IOLINK_DS_SLOT_SIZE, 2U), 0);
+    iolink_ds_init(&g_ds, iolink_flash_sim_api());
+}
+
+static int ds_flash_setup(void** state)
+{
+    (void) state;
+    (void) remove(DS_FLASH_FILE);
+    ds_nvm_erase();
+    ds_device_boot();
+    return 0;
+}
+
+static int ds_flash_teardown(void** state)
+{
+    (void) state;
+    iolink_flash_sim_close();
+    (void) remove(DS_FLASH_FILE);
+    ds_nvm_erase();
+    return 0;
+}
+
+static void ds_set_tag(uint16_t index, const char* tag)
+{
+    assert_int_equal(iolink_params_set(index, 0U, (const uint8_t*) tag, strlen(tag), true), 0);
+}
+
+static void ds_expect_tag(uint16_t index, const char* tag)
+{
+    char buf[IOLINK_DS_VALUE_MAX + 1U] = {0};
+    assert_int_equal(iolink_params_get(index, 0U, (uint8_t*) buf, IOLINK_DS_VALUE_MAX),
+                     (int) strlen(tag));
+    assert_string_equal(buf, tag);
+}
+
+/* Write a DS_Command (0x0003/1) and return the response length, or -error code */
+static int ds_command(uint8_t cmd)
+{
+    uint8_t resp[2];
+    assert_int_equal(isdu_send_write_request(&g_isdu, IOLINK_IDX_DATA_STORAGE,
+                                             IOLINK_DS_SUBIDX_COMMAND, &cmd, 1U),
+                     1);
+    iolink_isdu_process(&g_isdu);
+    if (g_isdu.state == ISDU_STATE_BUSY) {
+        iolink_ds_process(&g_ds); /* Deferred commit */
+    }
+    int len = isdu_collect_response(&g_isdu, resp, sizeof(resp));
+    return ((len == 2) && (resp[0] == 0x80U)) ? -(int) resp[1] : len;
+}
+
+static int ds_write_chunk(const uint8_t* data, size_t len)
+{
+    uint8_t resp[2];
+    assert_int_equal(isdu_send_write_request(&g_isdu, IOLINK_IDX_DATA_STORAGE,
+                                             IOLINK_DS_SUBIDX_IMAGE, data, len),
+                     1);
+    iolink_isdu_process(&g_isdu);
+    int ret = isdu_collect_response(&g_isdu, resp, sizeof(resp));
+    return ((ret == 2) && (resp[0] == 0x80U)) ? -(int) resp[1] : ret;
+}
+
+static size_t ds_upload(uint8_t* image)
+{
+    uint8_t size_be[4];
+    assert_int_equal(ds_command(0x01U), 0); /* DS_UploadStart */
+    assert_int_equal(isdu_send_read_request(&g_isdu, IOLINK_IDX_DATA_STORAGE,
+                                            IOLINK_DS_SUBIDX_SIZE),
+                     1);
+    iolink_isdu_process(&g_isdu);
+    assert_int_equal(isdu_collect_response(&g_isdu, size_be, sizeof(size_be)), 4);
+    size_t size = ((size_t) size_be[2] << 8U) | size_be[3];
+
+    assert_int_equal(isdu_send_read_request(&g_isdu, IOLINK_IDX_DATA_STORAGE,
+                                            IOLINK_DS_SUBIDX_IMAGE),
+                     1);
+    iolink_isdu_process(&g_isdu);
+    assert_int_equal(isdu_collect_response(&g_isdu, image, DS_IMAGE_MAX), (int) size);
+    assert_int_equal(ds_command(0x02U), 0); /* DS_UploadEnd */
+    return size;
+}
+
+/* Download in chunks: DS_DownloadStart, image writes, DS_DownloadEnd */
+static int ds_download(const uint8_t* image, size_t size)
+{
+    assert_int_equal(ds_command(0x03U), 0);
+    assert_int_equal(ds_write_chunk(image, 4U), -(int) IOLINK_ISDU_ERROR_BUSY); /* Not erased */
+    iolink_ds_process(&g_ds);
+    for (size_t pos = 0U; pos < size; pos += 8U) {
+        size_t n = ((size - pos) < 8U) ? (size - pos) : 8U;
+        assert_int_equal(ds_write_chunk(&image[pos], n), 0);
+    }
+    return ds_command(0x04U);
+}
+
+static void test_ds_streamed_upload_download(void** state)
+{
+    (void) state;
+    uint8_t image[DS_IMAGE_MAX];
+    iolink_ds_stats_t stats;
+
+    ds_set_tag(IOLINK_IDX_APPLICATION_TAG, "press-3");
+    ds_set_tag(IOLINK_IDX_FUNCTION_TAG, "clamp");
+    ds_set_tag(IOLINK_IDX_LOCATION_TAG, "line-7/cell-2");
+
+    size_t size = ds_upload(image);
+    assert_int_equal(size, (3U * 4U) + 7U + 5U + 13U + 2U);
+    const uint8_t first[] = {0x00U, 0x18U, 0x00U, 0x07U, 'p', 'r', 'e', 's', 's', '-', '3'};
+    assert_memory_equal(image, first, sizeof(first));
+    uint16_t checksum = iolink_ds_calc_checksum(image, size - 2U);
+    assert_int_equal(((uint16_t) image[size - 2U] << 8U) | image[size - 1U], checksum);
+    iolink_ds_get_stats(&g_ds, &stats);
+    assert_int_equal(stats.upload_bytes, size);
+
+    /* Replacement device: factory state, then one download of the image */
+    iolink_flash_sim_close();
+    (void) remove(DS_FLASH_FILE);
+    ds_nvm_erase();
+    ds_device_boot();
+    ds_expect_tag(IOLINK_IDX_LOCATION_TAG, "");
+    iolink_ds_check(&g_ds, checksum);
+    assert_int_equal(g_ds.state, IOLINK_DS_STATE_DOWNLOAD_REQ);
+    assert_int_equal(iolink_ds_abort(&g_ds), 0);
+
+    assert_int_equal(ds_download(image, size), 0);
+    ds_expect_tag(IOLINK_IDX_APPLICATION_TAG, "press-3");
+    ds_expect_tag(IOLINK_IDX_FUNCTION_TAG, "clamp");
+    ds_expect_tag(IOLINK_IDX_LOCATION_TAG, "line-7/cell-2");
+    assert_int_equal(g_ds.current_checksum, checksum);
+    iolink_ds_check(&g_ds, checksum);
+    assert_int_equal(g_ds.state, IOLINK_DS_STATE_IDLE);
+
+    iolink_ds_get_stats(&g_ds, &stats);
+    assert_int_equal(stats.commits, 1U);
+    assert_int_equal(stats.download_bytes, size);
+    assert_true(stats.download_us > 0U);
+
+    /* The committed image survives a restart of the engine */
+    ds_storage_reboot();
+    assert_int_equal(g_ds.active_slot, 0U);
+    assert_int_equal(g_ds.seq, 1U);
+    assert_int_equal(g_ds.current_checksum, checksum);
+}
+
+static void test_ds_download_rejects_corrupt_image(void** state)
+{
+    (void) state;
+    uint8_t image[DS_IMAGE_MAX];
+    iolink_ds_stats_t stats;
+
+    ds_set_tag(IOLINK_IDX_FUNCTION_TAG, "good");
+    size_t size = ds_upload(image);
+    assert_int_equal(ds_download(image, size), 0);
+
+    /* Flipped value byte: checksum mismatch, parameters untouched */
+    image[5] ^= 0x01U;
+    assert_int_equal(ds_download(image, size), -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL);
+    ds_expect_tag(IOLINK_IDX_FUNCTION_TAG, "good");
+
+    /* Truncated image */
+    image[5] ^= 0x01U;
+    assert_int_equal(ds_download(image, size - 3U), -(int) IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL);
+
+    iolink_ds_get_stats(&g_ds, &stats);
+    assert_int_equal(stats.commits, 1U);
+    assert_int_equal(stats.rejects, 2U);
+
+    /* The first image is still the committed one */
+    ds_storage_reboot();
+    assert_int_equal(g_ds.active_slot, 0U);
+    assert_int_equal(g_ds.seq, 1U);
+    ds_expect_tag(IOLINK_IDX_FUNCTION_TAG, "good");
+}
+
+static void test_ds_commit_rolls_forward_after_power_loss(void** state)
+{
+    (void) state;
+    uint8_t image[DS_IMAGE_MAX];
+
+    ds_set_tag(IOLINK_IDX_APPLICATION_TAG, "restored");
+    size_t size = ds_upload(image);
+    iolink_params_factory_reset();
+
+    assert_int_equal(ds_command(0x03U), 0);
+    iolink_ds_process(&g_ds);
+    for (size_t pos = 0U; pos < size; pos += 8U) {
+        size_t n = ((size - pos) < 8U) ? (size - pos) : 8U;
+        assert_int_equal(ds_write_chunk(&image[pos], n), 0);
+    }
+    /* Power fails after the 10-byte header commit, before the applied mark */
+    iolink_flash_sim_fail_after(10);
+    (void) ds_command(0x04U);
+    assert_true(iolink_flash_sim_power_lost());
+
+    /* Parameter RAM is lost with the power; boot applies the committed image */
+    iolink_params_factory_reset();
+    iolink_flash_sim_close();
+    ds_device_boot();
+    ds_expect_tag(IOLINK_IDX_APPLICATION_TAG, "restored");
+
+    /* Marked applied: a later local change is not overwritten at the next boot */
+    ds_set_tag(IOLINK_IDX_APPLICATION_TAG, "local");
+    ds_storage_reboot();
+    ds_expect_tag(IOLINK_IDX_APPLICATION_TAG, "local");
+}
+
+static void test_ds_download_survives_power_loss_before_params_flush(void** state)
+{
+    (void) state;
+    uint8_t image[DS_IMAGE_MAX];
+
+    ds_set_tag(IOLINK_IDX_APPLICATION_TAG, "restored");
+    size_t size = ds_upload(image);
+    ds_set_tag(IOLINK_IDX_APPLICATION_TAG, "old");
+    assert_int_equal(iolink_params_flush(), 0);
+
+    /* DownloadEnd is acknowledged and the slot marked applied */
+    assert_int_equal(ds_download(image, size), 0);
+    ds_expect_tag(IOLINK_IDX_APPLICATION_TAG, "restored");
+
+    /* Power fails before the application's next iolink_params_process() */
+    iolink_flash_sim_close();
+    ds_device_boot();
+    ds_expect_tag(IOLINK_IDX_APPLICATION_TAG, "restored");
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_ds_checksum),          cmocka_unit_test(test_ds_storage_integration),
         cmocka_unit_test(test_ds_state_transitions), cmocka_unit_test(test_ds_commands_locked),
         cmocka_unit_test(test_ds_commands_unlocked),
+        cmocka_unit_test(test_ds_checksum_matches_reference),
+        cmocka_unit_test(test_ds_checksum_incremental),
+        cmocka_unit_test_setup_teardown(test_ds_streamed_upload_download, ds_flash_setup,
+                                        ds_flash_teardown),
+        cmocka_unit_test_setup_teardown(test_ds_download_rejects_corrupt_image, ds_flash_setup,
+                                        ds_flash_teardown),
+        cmocka_unit_test_setup_teardown(test_ds_commit_rolls_forward_after_power_loss,
+                                        ds_flash_setup, ds_flash_teardown),
+        cmocka_unit_test_setup_teardown(test_ds_download_survives_power_loss_before_params_flush,
+                                        ds_flash_setup, ds_flash_teardown),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
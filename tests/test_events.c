@@ -43,18 +43,77 @@ static void test_event_queue_overflow(void** state)
     iolink_events_ctx_t ctx;
     iolink_events_init(&ctx);
 
-    /* Fill queue (size 8 by default) */
-    for (uint16_t i = 0U; i < 8U; i++) {
-        iolink_event_trigger(&ctx, i, IOLINK_EVENT_TYPE_NOTIFICATION);
+    /* Fill queue with distinct codes */
+    for (uint16_t i = 0U; i < IOLINK_EVENT_QUEUE_SIZE; i++) {
+        iolink_event_trigger(&ctx, (uint16_t) (0x6000U + i), IOLINK_EVENT_TYPE_ERROR);
     }
 
-    /* 9th event should trigger drop of 1st */
-    iolink_event_trigger(&ctx, 0xFFFF, IOLINK_EVENT_TYPE_ERROR);
+    /* One more distinct event is dropped; queued faults are kept */
+    iolink_event_trigger(&ctx, 0x1804U, IOLINK_EVENT_TYPE_WARNING);
+    assert_int_equal(iolink_events_dropped(&ctx), 1U);
 
     iolink_event_t ev;
-    iolink_events_pop(&ctx, &ev); /* Skip first */
-    /* Verify we can pop others */
+    assert_true(iolink_events_pop(&ctx, &ev));
+    assert_int_equal(ev.code, 0x6000U);
     assert_true(iolink_events_pending(&ctx));
+
+    /* Space freed: the next event fits again */
+    iolink_event_trigger(&ctx, 0x1804U, IOLINK_EVENT_TYPE_WARNING);
+    assert_int_equal(iolink_events_dropped(&ctx), 1U);
+}
+
+static void test_event_storm_coalesced(void** state)
+{
+    (void) state;
+    iolink_events_ctx_t ctx;
+    iolink_events_init(&ctx);
+
+    iolink_event_trigger(&ctx, IOLINK_EVENT_HW_SENSOR_FAULT, IOLINK_EVENT_TYPE_ERROR);
+    for (uint16_t i = 0U; i < 100U; i++) {
+        iolink_event_trigger(&ctx, IOLINK_EVENT_COMM_TIMING, IOLINK_EVENT_TYPE_WARNING);
+    }
+    /* Same code with a different type is a distinct entry */
+    iolink_event_trigger(&ctx, IOLINK_EVENT_COMM_TIMING, IOLINK_EVENT_TYPE_ERROR);
+
+    assert_int_equal(iolink_events_coalesced(&ctx), 99U);
+    assert_int_equal(iolink_events_dropped(&ctx), 0U);
+
+    iolink_event_t ev;
+    assert_true(iolink_events_pop(&ctx, &ev));
+    assert_int_equal(ev.code, IOLINK_EVENT_HW_SENSOR_FAULT);
+    assert_int_equal(ev.occurrences, 1U);
+    assert_true(iolink_events_pop(&ctx, &ev));
+    assert_int_equal(ev.code, IOLINK_EVENT_COMM_TIMING);
+    assert_int_equal(ev.type, IOLINK_EVENT_TYPE_WARNING);
+    assert_int_equal(ev.occurrences, 100U);
+    assert_true(iolink_events_pop(&ctx, &ev));
+    assert_int_equal(ev.type, IOLINK_EVENT_TYPE_ERROR);
+    assert_int_equal(ev.occurrences, 1U);
+    assert_false(iolink_events_pending(&ctx));
+
+    /* Once popped, a repeat starts a new entry */
+    iolink_event_trigger(&ctx, IOLINK_EVENT_COMM_TIMING, IOLINK_EVENT_TYPE_WARNING);
+    assert_true(iolink_events_pop(&ctx, &ev));
+    assert_int_equal(ev.occurrences, 1U);
+}
+
+static void test_event_queue_wraps(void** state)
+{
+    (void) state;
+    iolink_events_ctx_t ctx;
+    iolink_events_init(&ctx);
+
+    iolink_event_t ev;
+    for (uint16_t i = 0U; i < (IOLINK_EVENT_QUEUE_SIZE * 5U); i++) {
+        iolink_event_trigger(&ctx, i, IOLINK_EVENT_TYPE_NOTIFICATION);
+        iolink_event_trigger(&ctx, (uint16_t) (i + 0x8000U), IOLINK_EVENT_TYPE_NOTIFICATION);
+        assert_true(iolink_events_pop(&ctx, &ev));
+        assert_int_equal(ev.code, i);
+        assert_true(iolink_events_pop(&ctx, &ev));
+        assert_int_equal(ev.code, i + 0x8000U);
+    }
+    assert_false(iolink_events_pop(&ctx, &ev));
+    assert_int_equal(iolink_events_dropped(&ctx), 0U);
 }
 
 static void test_standard_codes(void** state)
@@ -148,6 +207,7 @@ int main(void)
         cmocka_unit_test(test_event_queue_flow), cmocka_unit_test(test_event_queue_overflow),
         cmocka_unit_test(test_standard_codes),   cmocka_unit_test(test_phy_diagnostic_codes),
         cmocka_unit_test(test_event_peek),       cmocka_unit_test(test_event_helpers),
+        cmocka_unit_test(test_event_storm_coalesced), cmocka_unit_test(test_event_queue_wraps),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
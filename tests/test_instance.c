@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_instance.c
+ * @brief Unit tests for the handle-based multi-instance API
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "iolinki/iolink.h"
+#include "iolinki/crc.h"
+#include "iolinki/protocol.h"
+#include "test_helpers.h"
+
+/* Two independent in-memory PHYs (one per port) */
+typedef struct
+{
+    uint8_t rx[64];
+    size_t rx_len;
+    size_t rx_pos;
+    uint8_t tx[64];
+    size_t tx_len;
+    int wakeup;
+} port_t;
+
+static port_t g_port_a;
+static port_t g_port_b;
+
+static int port_recv(port_t* p, uint8_t* byte)
+{
+    if (p->rx_pos >= p->rx_len) {
+        return 0;
+    }
+    *byte = p->rx[p->rx_pos++];
+    return 1;
+}
+
+static int port_send(port_t* p, const uint8_t* data, size_t len)
+{
+    (void) memcpy(p->tx, data, len);
+    p->tx_len = len;
+    return (int) len;
+}
+
+static int port_wakeup(port_t* p)
+{
+    int ret = p->wakeup;
+    p->wakeup = 0;
+    return ret;
+}
+
+static int a_recv(uint8_t* byte)
+{
+    return port_recv(&g_port_a, byte);
+}
+static int a_send(const uint8_t* data, size_t len)
+{
+    return port_send(&g_port_a, data, len);
+}
+static int a_wakeup(void)
+{
+    return port_wakeup(&g_port_a);
+}
+static int b_recv(uint8_t* byte)
+{
+    return port_recv(&g_port_b, byte);
+}
+static int b_send(const uint8_t* data, size_t len)
+{
+    return port_send(&g_port_b, data, len);
+}
+static int b_wakeup(void)
+{
+    return port_wakeup(&g_port_b);
+}
+
+static const iolink_phy_api_t g_phy_a = {
+    .send = a_send, .recv_byte = a_recv, .detect_wakeup = a_wakeup};
+static const iolink_phy_api_t g_phy_b = {
+    .send = b_send, .recv_byte = b_recv, .detect_wakeup = b_wakeup};
+
+static void port_feed(port_t* p, const uint8_t* data, size_t len)
+{
+    (void) memcpy(p->rx, data, len);
+    p->rx_len = len;
+    p->rx_pos = 0U;
+}
+
+static void instance_to_operate(iolink_instance_t* inst, port_t* port)
+{
+    port->wakeup = 1;
+    iolink_instance_process(inst);
+    usleep(200);
+
+    uint8_t trans[2] = {IOLINK_MC_TRANSITION_COMMAND, 0U};
+    trans[1] = iolink_checksum_ck(trans[0], 0U);
+    port_feed(port, trans, sizeof(trans));
+    iolink_instance_process(inst);
+
+    /* Type 1_1, PD_out = 1: MC | CKT | PD | OD | CK */
+    uint8_t frame[5] = {0x80U, 0x00U, 0x00U, 0x00U, 0x00U};
+    frame[4] = iolink_crc6(frame, 4U);
+    port_feed(port, frame, sizeof(frame));
+    iolink_instance_process(inst);
+}
+
+static int test_setup(void** state)
+{
+    (void) state;
+    iolink_nvm_mock_cleanup();
+    (void) memset(&g_port_a, 0, sizeof(g_port_a));
+    (void) memset(&g_port_b, 0, sizeof(g_port_b));
+    return 0;
+}
+
+static int test_teardown(void** state)
+{
+    (void) state;
+    iolink_nvm_mock_cleanup();
+    return 0;
+}
+
+static void test_instance_init_rejects_null(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    assert_int_equal(iolink_instance_init(NULL, &g_phy_a, NULL), -1);
+    assert_int_equal(iolink_instance_init(&inst, NULL, NULL), -1);
+}
+
+static void test_instances_are_independent(void** state)
+{
+    (void) state;
+    iolink_instance_t insts[2];
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+
+    assert_int_equal(iolink_instance_init(&insts[0], &g_phy_a, &config), 0);
+    assert_int_equal(iolink_instance_init(&insts[1], &g_phy_b, &config), 0);
+
+    instance_to_operate(&insts[0], &g_port_a);
+    assert_int_equal(iolink_instance_get_state(&insts[0]), IOLINK_DLL_STATE_OPERATE);
+    assert_int_equal(iolink_instance_get_state(&insts[1]), IOLINK_DLL_STATE_STARTUP);
+    assert_int_equal(g_port_a.tx_len, 4U);
+    assert_int_equal(g_port_b.tx_len, 0U);
+
+    /* Process Data stays per instance */
+    uint8_t pd_a = 0x5AU;
+    uint8_t pd_b = 0xA5U;
+    assert_int_equal(iolink_instance_pd_input_update(&insts[0], &pd_a, 1U, true), 0);
+    assert_int_equal(iolink_instance_pd_input_update(&insts[1], &pd_b, 1U, true), 0);
+
+    uint8_t frame[5] = {0x80U, 0x00U, 0x42U, 0x00U, 0x00U};
+    frame[4] = iolink_crc6(frame, 4U);
+    port_feed(&g_port_a, frame, sizeof(frame));
+    iolink_instance_process(&insts[0]);
+    assert_int_equal(g_port_a.tx[1], pd_a);
+
+    uint8_t out = 0U;
+    assert_int_equal(iolink_instance_pd_output_read(&insts[0], &out, 1U), 1);
+    assert_int_equal(out, 0x42U);
+    assert_int_equal(iolink_instance_pd_output_read(&insts[1], &out, 1U), 1);
+    assert_int_equal(out, 0x00U);
+
+    /* Statistics stay per instance */
+    uint8_t bad[5] = {0x80U, 0x00U, 0x00U, 0x00U, 0xFFU};
+    port_feed(&g_port_a, bad, sizeof(bad));
+    iolink_instance_process(&insts[0]);
+
+    iolink_dll_stats_t stats_a;
+    iolink_dll_stats_t stats_b;
+    iolink_instance_get_stats(&insts[0], &stats_a);
+    iolink_instance_get_stats(&insts[1], &stats_b);
+    assert_int_equal(stats_a.crc_errors, 1U);
+    assert_int_equal(stats_b.crc_errors, 0U);
+
+    /* Events stay per instance */
+    iolink_event_trigger(iolink_instance_get_events_ctx(&insts[1]), IOLINK_EVENT_HW_GENERAL_FAULT,
+                         IOLINK_EVENT_TYPE_ERROR);
+    assert_false(iolink_events_pending(iolink_instance_get_events_ctx(&insts[0])));
+    assert_true(iolink_events_pending(iolink_instance_get_events_ctx(&insts[1])));
+}
+
+static void test_global_api_wraps_default_instance(void** state)
+{
+    (void) state;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    assert_int_equal(iolink_init(&g_phy_a, &config), 0);
+
+    iolink_instance_t* def = iolink_get_default_instance();
+    assert_non_null(def);
+    instance_to_operate(def, &g_port_a);
+
+    assert_int_equal(iolink_get_state(), IOLINK_DLL_STATE_OPERATE);
+    assert_true(iolink_get_events_ctx() == iolink_instance_get_events_ctx(def));
+    assert_true(iolink_get_ds_ctx() == iolink_instance_get_ds_ctx(def));
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_instance_init_rejects_null, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_instances_are_independent, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_global_api_wraps_default_instance, test_setup,
+                                        test_teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -434,6 +434,328 @@ static void test_isdu_pdin_descriptor_read(void** state)
     assert_int_equal(byte, IOLINK_ISDU_ERROR_WRITE_PROTECTED);
 }
 
+/* Application index table */
+static uint8_t g_user_param[4] = {0x01U, 0x02U, 0x03U, 0x04U};
+static const uint8_t g_user_const[3] = {0xC0U, 0xFFU, 0xEEU};
+static uint8_t g_cb_subindex;
+
+static int user_read_cb(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex, uint8_t* buf,
+                        size_t max_len)
+{
+    (void) ctx;
+    (void) max_len;
+    g_cb_subindex = subindex;
+    buf[0] = (uint8_t) (index >> 8);
+    buf[1] = (uint8_t) index;
+    return 2;
+}
+
+static int user_write_cb(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                         const uint8_t* data, size_t len)
+{
+    (void) ctx;
+    (void) index;
+    (void) subindex;
+    (void) data;
+    return (len == 1U) ? 0 : -(int) IOLINK_ISDU_ERROR_BUSY;
+}
+
+static const iolink_isdu_entry_t g_user_table[] = {
+    {IOLINK_IDX_PDIN_DESCRIPTOR, 0U, 0U, IOLINK_ISDU_ACCESS_READ, NULL, NULL,
+     (void*) g_user_const, sizeof(g_user_const)},
+    {0x0040U, 0U, 0U, IOLINK_ISDU_ACCESS_RW, NULL, NULL, g_user_param, sizeof(g_user_param)},
+    {0x1000U, 1U, 8U, IOLINK_ISDU_ACCESS_RW, user_read_cb, user_write_cb, NULL, 0U},
+};
+
+static void expect_isdu_error(iolink_isdu_ctx_t* ctx, uint8_t code)
+{
+    uint8_t resp[2];
+    assert_int_equal(isdu_collect_response(ctx, resp, sizeof(resp)), 2);
+    assert_int_equal(resp[0], 0x80U);
+    assert_int_equal(resp[1], code);
+}
+
+static void test_isdu_user_table(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    iolink_isdu_init(&ctx);
+    size_t count = sizeof(g_user_table) / sizeof(g_user_table[0]);
+    assert_int_equal(iolink_isdu_register_table(&ctx, g_user_table, count), 0);
+
+    /* Direct data read */
+    uint8_t resp[8];
+    assert_int_equal(isdu_send_read_request(&ctx, 0x0040U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), 4);
+    assert_memory_equal(resp, g_user_param, 4U);
+
+    /* Direct data write: exact size stored, short write rejected */
+    const uint8_t value[4] = {0xAAU, 0xBBU, 0xCCU, 0xDDU};
+    assert_int_equal(isdu_send_write_request(&ctx, 0x0040U, 0x00, value, 4U), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), 0);
+    assert_memory_equal(g_user_param, value, 4U);
+
+    assert_int_equal(isdu_send_write_request(&ctx, 0x0040U, 0x00, value, 2U), 1);
+    iolink_isdu_process(&ctx);
+    expect_isdu_error(&ctx, IOLINK_ISDU_ERROR_LENGTH_UNDERRUN);
+
+    /* Subindex range and callback */
+    assert_int_equal(isdu_send_read_request(&ctx, 0x1000U, 0x05), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), 2);
+    assert_int_equal(resp[0], 0x10U);
+    assert_int_equal(g_cb_subindex, 5U);
+
+    assert_int_equal(isdu_send_read_request(&ctx, 0x1000U, 0x09), 1);
+    iolink_isdu_process(&ctx);
+    expect_isdu_error(&ctx, IOLINK_ISDU_ERROR_SUBINDEX_NOT_AVAIL);
+
+    /* Callback error code is reported to the master */
+    assert_int_equal(isdu_send_write_request(&ctx, 0x1000U, 0x01, value, 3U), 1);
+    iolink_isdu_process(&ctx);
+    expect_isdu_error(&ctx, IOLINK_ISDU_ERROR_BUSY);
+
+    /* User entry overrides the built-in index, access rights enforced */
+    assert_int_equal(isdu_send_read_request(&ctx, IOLINK_IDX_PDIN_DESCRIPTOR, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), 3);
+    assert_memory_equal(resp, g_user_const, 3U);
+
+    assert_int_equal(isdu_send_write_request(&ctx, IOLINK_IDX_PDIN_DESCRIPTOR, 0x00, value, 3U), 1);
+    iolink_isdu_process(&ctx);
+    expect_isdu_error(&ctx, IOLINK_ISDU_ERROR_WRITE_PROTECTED);
+
+    /* Built-in indices still served, unknown ones rejected */
+    assert_int_equal(isdu_send_read_request(&ctx, IOLINK_IDX_VENDOR_NAME, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(isdu_collect_response(&ctx, resp, 7U), 7);
+
+    assert_int_equal(isdu_send_read_request(&ctx, 0x0041U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    expect_isdu_error(&ctx, IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL);
+}
+
+/* Streamed responses: larger than the ISDU buffer, no staging copy */
+#define STREAM_LEN (IOLINK_ISDU_BUFFER_SIZE + 44U)
+static uint8_t g_stream_data[STREAM_LEN];
+
+static int stream_ref_cb(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex, uint8_t* buf,
+                         size_t max_len)
+{
+    (void) index;
+    (void) subindex;
+    (void) buf;
+    (void) max_len;
+    return iolink_isdu_respond_ref(ctx, g_stream_data, sizeof(g_stream_data));
+}
+
+static uint8_t stream_gen(void* arg, size_t offset)
+{
+    return (uint8_t) (*(const uint8_t*) arg + offset);
+}
+
+static int stream_pull_cb(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex, uint8_t* buf,
+                          size_t max_len)
+{
+    static const uint8_t seed = 0x10U;
+    (void) index;
+    (void) subindex;
+    (void) buf;
+    (void) max_len;
+    return iolink_isdu_respond_pull(ctx, stream_gen, (void*) &seed, STREAM_LEN);
+}
+
+static const iolink_isdu_entry_t g_stream_table[] = {
+    {0x3000U, 0U, 0U, IOLINK_ISDU_ACCESS_READ, stream_ref_cb, NULL, NULL, 0U},
+    {0x3001U, 0U, 0U, IOLINK_ISDU_ACCESS_READ, stream_pull_cb, NULL, NULL, 0U},
+};
+
+static void test_isdu_streamed_response(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_isdu_init(&ctx);
+    assert_int_equal(iolink_isdu_register_table(&ctx, g_stream_table, 2U), 0);
+    for (size_t i = 0U; i < STREAM_LEN; i++) {
+        g_stream_data[i] = (uint8_t) (i * 7U);
+    }
+
+    /* Referenced data: every byte but the last is sent without the Last flag */
+    assert_int_equal(isdu_send_read_request(&ctx, 0x3000U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_true(ctx.response_src == g_stream_data);
+    for (size_t i = 0U; i < STREAM_LEN; i++) {
+        uint8_t ctrl = 0U;
+        uint8_t data = 0U;
+        assert_int_equal(iolink_isdu_get_response_byte(&ctx, &ctrl), 1);
+        assert_int_equal((ctrl & IOLINK_ISDU_CTRL_LAST) != 0U, i == (STREAM_LEN - 1U));
+        assert_int_equal(iolink_isdu_get_response_byte(&ctx, &data), 1);
+        assert_int_equal(data, g_stream_data[i]);
+    }
+    assert_int_equal(ctx.state, ISDU_STATE_IDLE);
+
+    /* Generated data */
+    static uint8_t resp[STREAM_LEN];
+    assert_int_equal(isdu_send_read_request(&ctx, 0x3001U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), (int) STREAM_LEN);
+    for (size_t i = 0U; i < STREAM_LEN; i++) {
+        assert_int_equal(resp[i], (uint8_t) (0x10U + i));
+    }
+
+    /* Errors go back to the internal buffer */
+    assert_int_equal(isdu_send_read_request(&ctx, 0x3002U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_null(ctx.response_pull);
+    expect_isdu_error(&ctx, IOLINK_ISDU_ERROR_SERVICE_NOT_AVAIL);
+}
+
+/* Deferred handlers: accept the request and finish later */
+static uint16_t g_pending_index;
+static uint32_t g_pending_token;
+
+static int deferred_read_cb(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                            uint8_t* buf, size_t max_len)
+{
+    (void) subindex;
+    (void) buf;
+    (void) max_len;
+    g_pending_index = index;
+    g_pending_token = iolink_isdu_transfer_token(ctx);
+    return IOLINK_ISDU_PENDING;
+}
+
+static int deferred_write_cb(iolink_isdu_ctx_t* ctx, uint16_t index, uint8_t subindex,
+                             const uint8_t* data, size_t len)
+{
+    (void) subindex;
+    (void) data;
+    (void) len;
+    g_pending_index = index;
+    g_pending_token = iolink_isdu_transfer_token(ctx);
+    return IOLINK_ISDU_PENDING;
+}
+
+static const iolink_isdu_entry_t g_deferred_table[] = {
+    {0x2000U, 0U, 0U, IOLINK_ISDU_ACCESS_RW, deferred_read_cb, deferred_write_cb, NULL, 0U},
+};
+
+static void test_isdu_deferred_completion(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_isdu_init(&ctx);
+    assert_int_equal(iolink_isdu_register_table(&ctx, g_deferred_table, 1U), 0);
+
+    /* Nothing pending yet */
+    assert_int_equal(iolink_isdu_complete(&ctx, iolink_isdu_transfer_token(&ctx), 0, NULL, 0U),
+                     -1);
+
+    g_pending_index = 0U;
+    assert_int_equal(isdu_send_read_request(&ctx, 0x2000U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(g_pending_index, 0x2000U);
+    assert_int_equal(ctx.state, ISDU_STATE_BUSY);
+
+    /* Busy: OD stays empty, cyclic processing continues */
+    uint8_t byte = 0xFFU;
+    for (int i = 0; i < 3; i++) {
+        iolink_isdu_process(&ctx);
+        assert_int_equal(iolink_isdu_get_response_byte(&ctx, &byte), 0);
+        assert_int_equal(iolink_isdu_collect_byte(&ctx, 0x01U), 0); /* Idle control byte */
+    }
+
+    const uint8_t result[3] = {0x11U, 0x22U, 0x33U};
+    assert_int_equal(iolink_isdu_complete(&ctx, g_pending_token, 0, result, sizeof(result)), 0);
+    assert_int_equal(iolink_isdu_complete(&ctx, g_pending_token, 0, result, sizeof(result)), -1);
+
+    uint8_t resp[4];
+    assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), 3);
+    assert_memory_equal(resp, result, 3U);
+
+    /* Deferred write completed with an error */
+    const uint8_t value[1] = {0x42U};
+    assert_int_equal(isdu_send_write_request(&ctx, 0x2000U, 0x00, value, 1U), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(ctx.state, ISDU_STATE_BUSY);
+    assert_int_equal(
+        iolink_isdu_complete(&ctx, g_pending_token, -(int) IOLINK_ISDU_ERROR_BUSY, NULL, 0U), 0);
+    expect_isdu_error(&ctx, IOLINK_ISDU_ERROR_BUSY);
+}
+
+static void test_isdu_deferred_aborted_by_master(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    iolink_isdu_init(&ctx);
+    assert_int_equal(iolink_isdu_register_table(&ctx, g_deferred_table, 1U), 0);
+
+    assert_int_equal(isdu_send_read_request(&ctx, 0x2000U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(ctx.state, ISDU_STATE_BUSY);
+
+    /* Master gives up and starts a new request: the late completion is dropped */
+    assert_int_equal(isdu_send_read_request(&ctx, IOLINK_IDX_VENDOR_NAME, 0x00), 1);
+    assert_int_equal(iolink_isdu_complete(&ctx, g_pending_token, 0, NULL, 0U), -1);
+    iolink_isdu_process(&ctx);
+
+    char name[8] = {0};
+    assert_int_equal(isdu_collect_response(&ctx, (uint8_t*) name, 7U), 7);
+    assert_memory_equal(name, "iolinki", 7U);
+}
+
+/* A completion for an aborted request must not answer the request that replaced it */
+static void test_isdu_deferred_late_completion_after_abort(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_isdu_init(&ctx);
+    assert_int_equal(iolink_isdu_register_table(&ctx, g_deferred_table, 1U), 0);
+
+    assert_int_equal(isdu_send_read_request(&ctx, 0x2000U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(ctx.state, ISDU_STATE_BUSY);
+    uint32_t stale_token = g_pending_token;
+
+    /* The master aborts and repeats the request, which is deferred again */
+    assert_int_equal(isdu_send_read_request(&ctx, 0x2000U, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    assert_int_equal(ctx.state, ISDU_STATE_BUSY);
+    assert_int_not_equal(g_pending_token, stale_token);
+
+    const uint8_t stale[1] = {0xAAU};
+    assert_int_equal(iolink_isdu_complete(&ctx, stale_token, 0, stale, sizeof(stale)), -1);
+    assert_int_equal(ctx.state, ISDU_STATE_BUSY);
+
+    const uint8_t result[1] = {0x55U};
+    assert_int_equal(iolink_isdu_complete(&ctx, g_pending_token, 0, result, sizeof(result)), 0);
+    uint8_t resp[2];
+    assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), 1);
+    assert_int_equal(resp[0], 0x55U);
+}
+
+static void test_isdu_register_table_rejects_unsorted(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_isdu_init(&ctx);
+
+    const iolink_isdu_entry_t unsorted[] = {
+        {0x0041U, 0U, 0U, IOLINK_ISDU_ACCESS_READ, NULL, NULL, g_user_param, 1U},
+        {0x0040U, 0U, 0U, IOLINK_ISDU_ACCESS_READ, NULL, NULL, g_user_param, 1U},
+    };
+    assert_int_equal(iolink_isdu_register_table(&ctx, unsorted, 2U), -1);
+    assert_int_equal(iolink_isdu_register_table(&ctx, NULL, 1U), -1);
+    assert_int_equal(iolink_isdu_register_table(&ctx, NULL, 0U), 0);
+    assert_null(ctx.user_table);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -455,6 +777,15 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_isdu_location_tag_read_write, test_setup,
                                         test_teardown),
         cmocka_unit_test_setup_teardown(test_isdu_pdin_descriptor_read, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_isdu_user_table, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_isdu_register_table_rejects_unsorted, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_isdu_streamed_response, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_isdu_deferred_completion, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_isdu_deferred_aborted_by_master, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_isdu_deferred_late_completion_after_abort,
+                                        test_setup, test_teardown),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -61,9 +61,9 @@ static void test_isdu_busy_during_execution(void** state)
        Let's check `isdu.c`: `isdu_get_response_byte` sends Control Byte first.
     */
 
-    /* Check response buffer directly for simplicity */
-    assert_int_equal(ctx.response_buf[0], 0x80U);                  /* Error */
-    assert_int_equal(ctx.response_buf[1], IOLINK_ISDU_ERROR_BUSY); /* 0x30 */
+    /* Check response source directly for simplicity */
+    assert_int_equal(ctx.response_src[0], 0x80U);                  /* Error */
+    assert_int_equal(ctx.response_src[1], IOLINK_ISDU_ERROR_BUSY); /* 0x30 */
     assert_int_equal(ctx.response_len, 2);
 }
 
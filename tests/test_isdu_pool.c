@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_isdu_pool.c
+ * @brief ISDU buffer arena: shared pool (2 buffers) with in-place request/response
+ *
+ * Built against a library variant with IOLINK_ISDU_POOL_BUFFERS=2 and
+ * IOLINK_ISDU_SINGLE_BUFFER=1.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iolinki/isdu.h"
+#include "iolinki/params.h"
+#include "iolinki/protocol.h"
+#include "iolinki/device_info.h"
+#include "test_helpers.h"
+
+#if (IOLINK_ISDU_POOL_BUFFERS != 2) || !IOLINK_ISDU_SINGLE_BUFFER
+#error "test_isdu_pool expects IOLINK_ISDU_POOL_BUFFERS=2 and IOLINK_ISDU_SINGLE_BUFFER=1"
+#endif
+
+static iolink_isdu_ctx_t g_ports[3];
+
+static int test_setup(void** state)
+{
+    (void) state;
+    iolink_nvm_mock_cleanup();
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    for (size_t i = 0U; i < 3U; i++) {
+        iolink_isdu_init(&g_ports[i]);
+    }
+    return 0;
+}
+
+static int test_teardown(void** state)
+{
+    (void) state;
+    for (size_t i = 0U; i < 3U; i++) {
+        iolink_isdu_init(&g_ports[i]);
+    }
+    iolink_nvm_mock_cleanup();
+    return 0;
+}
+
+static void expect_vendor_name(iolink_isdu_ctx_t* ctx)
+{
+    char name[8] = {0};
+    assert_int_equal(isdu_collect_response(ctx, (uint8_t*) name, 7U), 7);
+    assert_memory_equal(name, "iolinki", 7U);
+}
+
+static void test_pool_contexts_carry_no_buffers(void** state)
+{
+    (void) state;
+    assert_true(sizeof(iolink_isdu_ctx_t) < IOLINK_ISDU_BUFFER_SIZE);
+    assert_null(g_ports[0].buffer);
+    assert_int_equal(iolink_isdu_pool_free(), 2U);
+}
+
+static void test_pool_lends_only_during_transfer(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t* a = &g_ports[0];
+    iolink_isdu_ctx_t* b = &g_ports[1];
+    iolink_isdu_ctx_t* c = &g_ports[2];
+
+    assert_int_equal(isdu_send_read_request(a, IOLINK_IDX_VENDOR_NAME, 0x00), 1);
+    iolink_isdu_process(a);
+    assert_non_null(a->buffer);
+    assert_true(a->response_buf == a->buffer);
+    assert_int_equal(iolink_isdu_pool_free(), 1U);
+
+    assert_int_equal(isdu_send_read_request(b, IOLINK_IDX_VENDOR_NAME, 0x00), 1);
+    iolink_isdu_process(b);
+    assert_int_equal(iolink_isdu_pool_free(), 0U);
+
+    /* Pool empty: the third port is told to retry */
+    assert_int_equal(isdu_send_read_request(c, IOLINK_IDX_VENDOR_NAME, 0x00), 1);
+    uint8_t resp[2];
+    assert_int_equal(isdu_collect_response(c, resp, sizeof(resp)), 2);
+    assert_int_equal(resp[0], 0x80U);
+    assert_int_equal(resp[1], IOLINK_ISDU_ERROR_BUSY);
+    assert_null(c->buffer);
+
+    /* Finishing a transfer returns its buffer */
+    expect_vendor_name(a);
+    assert_null(a->buffer);
+    assert_int_equal(iolink_isdu_pool_free(), 1U);
+
+    assert_int_equal(isdu_send_read_request(c, IOLINK_IDX_VENDOR_NAME, 0x00), 1);
+    iolink_isdu_process(c);
+    expect_vendor_name(c);
+    expect_vendor_name(b);
+    assert_int_equal(iolink_isdu_pool_free(), 2U);
+}
+
+static void test_single_buffer_write_then_read(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t* a = &g_ports[0];
+    const uint8_t tag[] = "port-a";
+
+    /* The write payload and the response share one buffer */
+    assert_int_equal(
+        isdu_send_write_request(a, IOLINK_IDX_APPLICATION_TAG, 0x00, tag, sizeof(tag) - 1U), 1);
+    iolink_isdu_process(a);
+    uint8_t resp[32];
+    assert_int_equal(isdu_collect_response(a, resp, sizeof(resp)), 0);
+
+    assert_int_equal(isdu_send_read_request(a, IOLINK_IDX_APPLICATION_TAG, 0x00), 1);
+    iolink_isdu_process(a);
+    int len = isdu_collect_response(a, resp, sizeof(resp));
+    assert_true(len >= (int) (sizeof(tag) - 1U));
+    assert_memory_equal(resp, tag, sizeof(tag) - 1U);
+    assert_int_equal(iolink_isdu_pool_free(), 2U);
+}
+
+static void test_reinit_returns_lent_buffer(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t* a = &g_ports[0];
+
+    /* Start a request, then reset the port mid-transfer */
+    assert_int_equal(iolink_isdu_collect_byte(a, 0x80U), 0);
+    assert_int_equal(iolink_isdu_pool_free(), 1U);
+    (void) memset(a, 0, sizeof(*a));
+    iolink_isdu_init(a);
+    assert_int_equal(iolink_isdu_pool_free(), 2U);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_pool_contexts_carry_no_buffers, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_pool_lends_only_during_transfer, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_single_buffer_write_then_read, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_reinit_returns_lent_buffer, test_setup,
+                                        test_teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
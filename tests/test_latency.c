@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_latency.c
+ * @brief Unit tests for latency histograms and their ISDU export
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iolinki/iolink.h"
+#include "iolinki/latency.h"
+#include "iolinki/dll.h"
+#include "iolinki/isdu.h"
+#include "iolinki/protocol.h"
+#include "iolinki/device_info.h"
+#include "iolinki/params.h"
+#include "test_helpers.h"
+
+static uint32_t read_u32_be(const uint8_t* buf)
+{
+    return ((uint32_t) buf[0] << 24) | ((uint32_t) buf[1] << 16) | ((uint32_t) buf[2] << 8) |
+           (uint32_t) buf[3];
+}
+
+static int test_setup(void** state)
+{
+    (void) state;
+    iolink_nvm_mock_cleanup();
+    return 0;
+}
+
+static int test_teardown(void** state)
+{
+    (void) state;
+    iolink_nvm_mock_cleanup();
+    return 0;
+}
+
+/* Built with the default 4 sub-buckets per octave, and as test_latency_log2 with none */
+#if IOLINK_LATENCY_HIST_SUB_BITS == 0
+#define P_100US 127U /* [64, 128) */
+#define BUCKET_100US 7U
+#define BUCKET_200US 8U
+#else
+#define P_100US 111U /* [96, 112) */
+#define BUCKET_100US 22U
+#define BUCKET_200US 26U
+#endif
+
+static void test_latency_buckets(void** state)
+{
+    (void) state;
+    iolink_latency_hist_t hist;
+    iolink_latency_hist_reset(&hist);
+
+#if IOLINK_LATENCY_HIST_SUB_BITS == 0
+    /* Bucket i holds [2^(i-1), 2^i) */
+    iolink_latency_hist_record(&hist, 0U);
+    iolink_latency_hist_record(&hist, 1U);
+    iolink_latency_hist_record(&hist, 3U);
+    iolink_latency_hist_record(&hist, 4U);
+    iolink_latency_hist_record(&hist, 0xFFFFFFFFU);
+
+    assert_int_equal(hist.buckets[0], 1U);
+    assert_int_equal(hist.buckets[1], 1U);
+    assert_int_equal(hist.buckets[2], 1U);
+    assert_int_equal(hist.buckets[3], 1U);
+    assert_int_equal(hist.count, 5U);
+#else
+    /* Exact below 8us, then 4 buckets per octave: [8, 10), [10, 12), ... [96, 112) */
+    const uint32_t samples[] = {0U, 7U, 8U, 9U, 10U, 100U, 111U, 112U, 0xFFFFFFFFU};
+    for (size_t i = 0U; i < (sizeof(samples) / sizeof(samples[0])); i++) {
+        iolink_latency_hist_record(&hist, samples[i]);
+    }
+
+    assert_int_equal(hist.buckets[0], 1U);
+    assert_int_equal(hist.buckets[7], 1U);
+    assert_int_equal(hist.buckets[8], 2U);
+    assert_int_equal(hist.buckets[9], 1U);
+    assert_int_equal(hist.buckets[22], 2U);
+    assert_int_equal(hist.buckets[23], 1U);
+    assert_int_equal(hist.count, 9U);
+#endif
+    assert_int_equal(hist.buckets[IOLINK_LATENCY_HIST_BUCKETS - 1U], 1U);
+    assert_int_equal(hist.max_us, 0xFFFFFFFFU);
+}
+
+static void test_latency_percentiles(void** state)
+{
+    (void) state;
+    iolink_latency_hist_t hist;
+    iolink_latency_hist_reset(&hist);
+    assert_int_equal(iolink_latency_hist_percentile(&hist, 5000U), 0U);
+
+    /* 990 fast samples at 100us, 9 at 1000us, 1 outlier at 3000us */
+    for (int i = 0; i < 990; i++) {
+        iolink_latency_hist_record(&hist, 100U);
+    }
+    for (int i = 0; i < 9; i++) {
+        iolink_latency_hist_record(&hist, 1000U);
+    }
+    iolink_latency_hist_record(&hist, 3000U);
+
+    /* Reported as the upper bound of the bucket holding 100us */
+    assert_int_equal(iolink_latency_hist_percentile(&hist, 5000U), P_100US);
+    assert_int_equal(iolink_latency_hist_percentile(&hist, 9900U), P_100US);
+    /* p99.9 falls into [512, 1024) or [896, 1024) */
+    assert_int_equal(iolink_latency_hist_percentile(&hist, 9990U), 1023U);
+    /* p100 is clamped to the real maximum */
+    assert_int_equal(iolink_latency_hist_percentile(&hist, 10000U), 3000U);
+}
+
+static void test_latency_dll_api(void** state)
+{
+    (void) state;
+    iolink_dll_ctx_t dll;
+    (void) memset(&dll, 0, sizeof(dll));
+    iolink_latency_hist_record(&dll.latency[IOLINK_LATENCY_CYCLE], 1000U);
+
+    iolink_latency_hist_t out;
+    assert_int_equal(iolink_dll_get_latency_histogram(&dll, IOLINK_LATENCY_CYCLE, &out), 0);
+    assert_int_equal(out.count, 1U);
+    assert_int_equal(out.max_us, 1000U);
+    assert_int_equal(iolink_dll_get_latency_histogram(&dll, IOLINK_LATENCY_KIND_COUNT, &out), -1);
+    assert_int_equal(iolink_dll_get_latency_histogram(NULL, IOLINK_LATENCY_CYCLE, &out), -1);
+
+    iolink_dll_reset_latency_histograms(&dll);
+    assert_int_equal(dll.latency[IOLINK_LATENCY_CYCLE].count, 0U);
+}
+
+static void test_latency_recorded_in_operate(void** state)
+{
+    (void) state;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    setup_mock_phy();
+    will_return(mock_phy_init, 0);
+    iolink_init(&g_phy_mock, &config);
+    move_to_operate();
+
+    uint8_t frame[5] = {0x80U, 0x00U, 0x00U, 0x00U, 0x00U};
+    frame[4] = iolink_crc6(frame, 4U);
+    for (int i = 0; i < 5; i++) {
+        will_return(mock_phy_recv_byte, 1);
+        will_return(mock_phy_recv_byte, frame[i]);
+    }
+    will_return(mock_phy_recv_byte, 0);
+    expect_any(mock_phy_send, data);
+    expect_value(mock_phy_send, len, 4);
+    will_return(mock_phy_send, 0);
+    iolink_process();
+
+    const iolink_dll_ctx_t* dll = &iolink_get_default_instance()->dll;
+    iolink_latency_hist_t hist;
+    assert_int_equal(iolink_dll_get_latency_histogram(dll, IOLINK_LATENCY_RESPONSE, &hist), 0);
+    assert_int_equal(hist.count, 2U);
+    assert_int_equal(iolink_dll_get_latency_histogram(dll, IOLINK_LATENCY_CYCLE, &hist), 0);
+    assert_true(hist.count >= 1U);
+    assert_int_equal(iolink_dll_get_latency_histogram(dll, IOLINK_LATENCY_BYTE_GAP, &hist), 0);
+    assert_true(hist.count >= 8U);
+}
+
+static void test_latency_isdu_read(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_dll_ctx_t dll_ctx;
+    (void) memset(&dll_ctx, 0, sizeof(dll_ctx));
+    iolink_latency_hist_record(&dll_ctx.latency[IOLINK_LATENCY_RESPONSE], 100U);
+    iolink_latency_hist_record(&dll_ctx.latency[IOLINK_LATENCY_RESPONSE], 200U);
+
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    iolink_isdu_init(&ctx);
+    ctx.dll_ctx = &dll_ctx;
+
+    /* Summary: 3 kinds x (count, p50, p99, p99.9, max) */
+    assert_int_equal(isdu_send_read_request(&ctx, IOLINK_IDX_LATENCY_HIST, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    uint8_t data[IOLINK_LATENCY_HIST_BUCKETS * 4U];
+    int len = isdu_collect_response(&ctx, data, sizeof(data));
+    assert_int_equal(len, 60);
+    assert_int_equal(read_u32_be(&data[0]), 2U);
+    assert_int_equal(read_u32_be(&data[4]), P_100US);
+    assert_int_equal(read_u32_be(&data[16]), 200U);
+    assert_int_equal(read_u32_be(&data[20]), 0U);
+
+    /* Raw buckets of the response-time histogram */
+    iolink_isdu_init(&ctx);
+    ctx.dll_ctx = &dll_ctx;
+    assert_int_equal(isdu_send_read_request(&ctx, IOLINK_IDX_LATENCY_HIST, 0x01), 1);
+    iolink_isdu_process(&ctx);
+    len = isdu_collect_response(&ctx, data, sizeof(data));
+    assert_int_equal(len, (int) (IOLINK_LATENCY_HIST_BUCKETS * 4U));
+    assert_int_equal(read_u32_be(&data[BUCKET_100US * 4U]), 1U);
+    assert_int_equal(read_u32_be(&data[BUCKET_200US * 4U]), 1U);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_latency_buckets),
+        cmocka_unit_test(test_latency_percentiles),
+        cmocka_unit_test(test_latency_dll_api),
+        cmocka_unit_test_setup_teardown(test_latency_recorded_in_operate, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_latency_isdu_read, test_setup, test_teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
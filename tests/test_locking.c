@@ -11,6 +11,7 @@
 #include <setjmp.h>
 #include <stdint.h>
 #include <cmocka.h>
+#include "iolinki/atomic.h"
 #include "iolinki/events.h"
 #include "iolinki/platform.h"
 
@@ -29,7 +30,7 @@ void iolink_critical_exit(void)
     g_exit_count++;
 }
 
-static void test_event_locking(void** state)
+static void test_event_lock_free(void** state)
 {
     (void) state;
     iolink_events_ctx_t ctx;
@@ -38,24 +39,28 @@ static void test_event_locking(void** state)
     g_enter_count = 0;
     g_exit_count = 0;
 
-    /* Triggering an event should enter critical section */
+    /* Triggering an event must not mask interrupts (callable from ISRs) */
+    iolink_event_trigger(&ctx, 0x1800, IOLINK_EVENT_TYPE_NOTIFICATION);
     iolink_event_trigger(&ctx, 0x1800, IOLINK_EVENT_TYPE_NOTIFICATION);
 
-    assert_int_equal(g_enter_count, 1);
-    assert_int_equal(g_exit_count, 1);
-
-    /* Popping an event should also verify locking */
+    /* Popping is lock-free as well */
     iolink_event_t ev;
-    iolink_events_pop(&ctx, &ev);
+    assert_true(iolink_events_pop(&ctx, &ev));
+    assert_int_equal(ev.occurrences, 2);
 
-    assert_int_equal(g_enter_count, 2);
-    assert_int_equal(g_exit_count, 2);
+#if IOLINK_ATOMIC_NATIVE_CAS
+    assert_int_equal(g_enter_count, 0);
+    assert_int_equal(g_exit_count, 0);
+#else
+    /* Atomic fallback uses critical sections, which must stay balanced */
+    assert_int_equal(g_enter_count, g_exit_count);
+#endif
 }
 
 int main(void)
 {
     const struct CMUnitTest tests[] = {
-        cmocka_unit_test(test_event_locking),
+        cmocka_unit_test(test_event_lock_free),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
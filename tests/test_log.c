@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_log.c
+ * @brief Deferred binary log ring and formatter
+ *
+ * Built against a library variant with IOLINK_LOG_LEVEL=4 and IOLINK_LOG_RING_SIZE=8.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iolinki/log.h"
+#include "iolinki/isdu.h"
+#include "iolinki/params.h"
+#include "iolinki/protocol.h"
+#include "iolinki/device_info.h"
+#include "test_helpers.h"
+
+#if (IOLINK_LOG_LEVEL != 4) || (IOLINK_LOG_RING_SIZE != 8U)
+#error "test_log expects IOLINK_LOG_LEVEL=4 and IOLINK_LOG_RING_SIZE=8"
+#endif
+
+static int test_setup(void** state)
+{
+    (void) state;
+    iolink_log_record_t rec;
+    while (iolink_log_read(&rec)) {
+    }
+    return 0;
+}
+
+static void expect_format(const char* fmt, uint32_t a0, uint32_t a1, const char* expected)
+{
+    iolink_log_record_t rec = {0U, fmt, {a0, a1, 0U, 0U}, IOLINK_LOG_LEVEL_INFO};
+    char text[64];
+    size_t len = iolink_log_format(&rec, text, sizeof(text));
+    assert_string_equal(text, expected);
+    assert_int_equal(len, strlen(expected));
+}
+
+static void test_log_format_conversions(void** state)
+{
+    (void) state;
+    expect_format("plain", 0U, 0U, "plain");
+    expect_format("%u/%d", 7U, (uint32_t) -3, "7/-3");
+    expect_format("MC 0x%02X len %u", 0x0AU, 3U, "MC 0x0A len 3");
+    expect_format("%04x%c", 0xBEU, 'k', "00bek");
+    expect_format("100%% %5u|", 42U, 0U, "100%    42|");
+
+    /* Truncation keeps the text terminated */
+    iolink_log_record_t rec = {0U, "abcdef %u", {123456U, 0U, 0U, 0U}, IOLINK_LOG_LEVEL_INFO};
+    char small[8];
+    assert_int_equal(iolink_log_format(&rec, small, sizeof(small)), 7U);
+    assert_string_equal(small, "abcdef ");
+}
+
+static void test_log_records_in_order(void** state)
+{
+    (void) state;
+    IOLINK_LOG_ERROR("no args");
+    IOLINK_LOG_WARN("one %u", 1U);
+    IOLINK_LOG_DEBUG("four %u %u %u %u", 1U, 2U, 3U, 4U);
+
+    iolink_log_record_t rec;
+    assert_true(iolink_log_read(&rec));
+    assert_int_equal(rec.level, IOLINK_LOG_LEVEL_ERROR);
+    assert_string_equal(rec.fmt, "no args");
+
+    assert_true(iolink_log_read(&rec));
+    assert_int_equal(rec.level, IOLINK_LOG_LEVEL_WARN);
+    assert_int_equal(rec.args[0], 1U);
+
+    assert_true(iolink_log_read(&rec));
+    assert_int_equal(rec.level, IOLINK_LOG_LEVEL_DEBUG);
+    assert_int_equal(rec.args[3], 4U);
+
+    assert_false(iolink_log_read(&rec));
+}
+
+static void test_log_full_ring_drops_newest(void** state)
+{
+    (void) state;
+    uint32_t dropped = iolink_log_dropped();
+
+    /* Several laps, then overfill */
+    for (uint32_t lap = 0U; lap < 3U; lap++) {
+        for (uint32_t i = 0U; i < IOLINK_LOG_RING_SIZE; i++) {
+            IOLINK_LOG_INFO("seq %u", i);
+        }
+        iolink_log_record_t rec;
+        for (uint32_t i = 0U; i < IOLINK_LOG_RING_SIZE; i++) {
+            assert_true(iolink_log_read(&rec));
+            assert_int_equal(rec.args[0], i);
+        }
+        assert_false(iolink_log_read(&rec));
+    }
+
+    for (uint32_t i = 0U; i < IOLINK_LOG_RING_SIZE + 2U; i++) {
+        IOLINK_LOG_INFO("seq %u", i);
+    }
+    assert_int_equal(iolink_log_dropped() - dropped, 2U);
+
+    iolink_log_record_t rec;
+    for (uint32_t i = 0U; i < IOLINK_LOG_RING_SIZE; i++) {
+        assert_true(iolink_log_read(&rec));
+        assert_int_equal(rec.args[0], i);
+    }
+}
+
+typedef struct
+{
+    size_t count;
+    char last[96];
+} sink_state_t;
+
+static void collect_sink(void* arg, const iolink_log_record_t* rec, const char* text)
+{
+    sink_state_t* sink = (sink_state_t*) arg;
+    (void) rec;
+    sink->count++;
+    (void) strncpy(sink->last, text, sizeof(sink->last) - 1U);
+}
+
+static void test_log_isdu_response_is_deferred(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    iolink_isdu_init(&ctx);
+
+    assert_int_equal(isdu_send_read_request(&ctx, IOLINK_IDX_VENDOR_NAME, 0x00), 1);
+    iolink_isdu_process(&ctx);
+    uint8_t resp[8];
+    assert_int_equal(isdu_collect_response(&ctx, resp, 7U), 7);
+
+    /* The reply path only stored a record; text is produced by the drain */
+    sink_state_t sink = {0U, {0}};
+    assert_true(iolink_log_drain(collect_sink, &sink) >= 1U);
+    assert_string_equal(sink.last, "ISDU: response complete, index 0x0010, 7 bytes");
+    assert_int_equal(iolink_log_drain(collect_sink, &sink), 0U);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup(test_log_format_conversions, test_setup),
+        cmocka_unit_test_setup(test_log_records_in_order, test_setup),
+        cmocka_unit_test_setup(test_log_full_ring_drops_newest, test_setup),
+        cmocka_unit_test_setup(test_log_isdu_response_is_deferred, test_setup),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
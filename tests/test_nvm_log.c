@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_nvm_log.c
+ * @brief Log-structured NVM store on the simulated flash, including power loss
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iolinki/nvm_log.h"
+#include "iolinki/flash_sim.h"
+#include "iolinki/params.h"
+#include "iolinki/protocol.h"
+#include "iolinki/device_info.h"
+
+#define FLASH_FILE "test_nvm_log_flash.bin"
+#define SECTOR_SIZE 128U
+#define SECTOR_COUNT 3U
+
+static iolink_nvm_log_t g_log;
+
+static int test_setup(void** state)
+{
+    (void) state;
+    (void) remove(FLASH_FILE);
+    assert_int_equal(iolink_flash_sim_open(FLASH_FILE, SECTOR_SIZE, SECTOR_COUNT), 0);
+    assert_int_equal(
+        iolink_nvm_log_mount(&g_log, iolink_flash_sim_api(), SECTOR_SIZE, SECTOR_COUNT), 0);
+    return 0;
+}
+
+static int test_teardown(void** state)
+{
+    (void) state;
+    iolink_flash_sim_close();
+    (void) remove(FLASH_FILE);
+    return 0;
+}
+
+/* Power cycle: reopen the flash file and mount again */
+static void reboot(void)
+{
+    iolink_flash_sim_close();
+    assert_int_equal(iolink_flash_sim_open(FLASH_FILE, SECTOR_SIZE, SECTOR_COUNT), 0);
+    assert_int_equal(
+        iolink_nvm_log_mount(&g_log, iolink_flash_sim_api(), SECTOR_SIZE, SECTOR_COUNT), 0);
+}
+
+static void put_u32(uint8_t key, uint32_t value)
+{
+    uint8_t buf[8];
+    (void) memset(buf, (int) key, sizeof(buf));
+    (void) memcpy(buf, &value, sizeof(value));
+    assert_int_equal(iolink_nvm_log_write(&g_log, key, buf, sizeof(buf)), 0);
+}
+
+static uint32_t get_u32(uint8_t key)
+{
+    uint8_t buf[8];
+    uint32_t value;
+    assert_int_equal(iolink_nvm_log_read(&g_log, key, buf, sizeof(buf)), (int) sizeof(buf));
+    (void) memcpy(&value, buf, sizeof(value));
+    return value;
+}
+
+static void test_nvm_log_roundtrip(void** state)
+{
+    (void) state;
+    uint8_t buf[16];
+    assert_int_equal(iolink_nvm_log_read(&g_log, 1U, buf, sizeof(buf)), -1);
+
+    assert_int_equal(iolink_nvm_log_write(&g_log, 1U, (const uint8_t*) "hello", 5U), 0);
+    assert_int_equal(iolink_nvm_log_write(&g_log, 2U, NULL, 0U), 0);
+    assert_int_equal(iolink_nvm_log_write(&g_log, 1U, (const uint8_t*) "world!", 6U), 0);
+
+    reboot();
+    assert_int_equal(iolink_nvm_log_read(&g_log, 1U, buf, sizeof(buf)), 6);
+    assert_memory_equal(buf, "world!", 6U);
+    assert_int_equal(iolink_nvm_log_read(&g_log, 2U, buf, sizeof(buf)), 0);
+
+    /* Invalid keys and oversized values are rejected */
+    assert_int_equal(iolink_nvm_log_write(&g_log, IOLINK_NVM_LOG_MAX_KEYS, buf, 1U), -1);
+    uint8_t big[SECTOR_SIZE];
+    (void) memset(big, 0, sizeof(big));
+    assert_int_equal(iolink_nvm_log_write(&g_log, 0U, big, sizeof(big)), -1);
+}
+
+static void test_nvm_log_wear_leveling(void** state)
+{
+    (void) state;
+    for (uint32_t i = 0U; i < 600U; i++) {
+        put_u32((uint8_t) (i % 3U), i);
+    }
+
+    /* Erases rotate through all sectors */
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0U;
+    for (uint8_t sector = 0U; sector < SECTOR_COUNT; sector++) {
+        uint32_t erases = iolink_flash_sim_erase_count(sector);
+        min = (erases < min) ? erases : min;
+        max = (erases > max) ? erases : max;
+    }
+    assert_true(min > 0U);
+    assert_true((max - min) <= 1U);
+
+    reboot();
+    assert_int_equal(get_u32(0U), 597U);
+    assert_int_equal(get_u32(1U), 598U);
+    assert_int_equal(get_u32(2U), 599U);
+}
+
+static void test_nvm_log_background_compaction(void** state)
+{
+    (void) state;
+    iolink_nvm_log_stats_t stats;
+    put_u32(5U, 0xC0FFEEU);
+
+    for (uint32_t i = 0U; i < 200U; i++) {
+        iolink_nvm_log_get_stats(&g_log, &stats);
+        uint32_t erases = stats.sector_erases;
+        put_u32(0U, i);
+        iolink_nvm_log_get_stats(&g_log, &stats);
+        /* The writer never waits for an erase */
+        assert_int_equal(stats.sector_erases, erases);
+        iolink_nvm_log_process(&g_log);
+    }
+    iolink_nvm_log_get_stats(&g_log, &stats);
+    assert_true(stats.background_compactions > 0U);
+    assert_true(stats.records_copied > 0U);
+    assert_int_equal(get_u32(5U), 0xC0FFEEU);
+    assert_int_equal(get_u32(0U), 199U);
+}
+
+/*
+ * Cut power at every byte of a write sequence that spans several sector
+ * changes and reclaims. After reboot each key holds its last committed value
+ * and the log accepts new writes.
+ */
+static void test_nvm_log_power_loss_sweep(void** state)
+{
+    (void) state;
+    const uint32_t writes = 40U;
+    uint32_t budget = 0U;
+
+    for (;;) {
+        (void) test_teardown(NULL);
+        (void) test_setup(NULL);
+        put_u32(1U, 111U);
+        put_u32(2U, 222U);
+
+        iolink_flash_sim_fail_after((int32_t) budget);
+        uint32_t committed = 0U;
+        for (uint32_t i = 1U; i <= writes; i++) {
+            uint8_t buf[8];
+            (void) memset(buf, 0, sizeof(buf));
+            (void) memcpy(buf, &i, sizeof(i));
+            if (iolink_nvm_log_write(&g_log, 0U, buf, sizeof(buf)) != 0) {
+                break;
+            }
+            committed = i;
+        }
+        bool lost = iolink_flash_sim_power_lost();
+
+        reboot();
+        if (committed == 0U) {
+            uint8_t buf[8];
+            assert_int_equal(iolink_nvm_log_read(&g_log, 0U, buf, sizeof(buf)), -1);
+        }
+        else {
+            assert_int_equal(get_u32(0U), committed);
+        }
+        assert_int_equal(get_u32(1U), 111U);
+        assert_int_equal(get_u32(2U), 222U);
+
+        put_u32(0U, 0xABCDU);
+        reboot();
+        assert_int_equal(get_u32(0U), 0xABCDU);
+
+        if (!lost) {
+            assert_int_equal(committed, writes);
+            break; /* Budget covers the whole sequence */
+        }
+        budget++;
+    }
+    assert_true(budget > (2U * SECTOR_SIZE)); /* At least one erase was interrupted */
+}
+
+static void test_nvm_log_params_backend(void** state)
+{
+    (void) state;
+    iolink_device_info_init(NULL);
+    iolink_params_use_nvm_log(&g_log);
+    iolink_params_init();
+
+    const char* tag = "line-7";
+    assert_int_equal(
+        iolink_params_set(IOLINK_IDX_LOCATION_TAG, 0U, (const uint8_t*) tag, strlen(tag), true),
+        0);
+    assert_int_equal(iolink_params_flush(), 0);
+
+    reboot();
+    iolink_params_init();
+    char buf[33] = {0};
+    assert_int_equal(iolink_params_get(IOLINK_IDX_LOCATION_TAG, 0U, (uint8_t*) buf, 32U),
+                     (int) strlen(tag));
+    assert_string_equal(buf, tag);
+
+    iolink_params_use_nvm_log(NULL);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_nvm_log_roundtrip, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_nvm_log_wear_leveling, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_nvm_log_background_compaction, test_setup,
+                                        test_teardown),
+        cmocka_unit_test_setup_teardown(test_nvm_log_power_loss_sweep, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_nvm_log_params_backend, test_setup, test_teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_params.c
+ * @brief Write-behind parameter cache: dirty tracking and coalesced NVM flush
+ *
+ * Built against a library variant with IOLINK_PARAMS_FLUSH_DELAY_MS=20 and
+ * IOLINK_PARAMS_FLUSH_COUNT=4. NVM is a RAM image defined here, which counts
+ * writes and can be made to fail.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "iolinki/params.h"
+#include "iolinki/isdu.h"
+#include "iolinki/protocol.h"
+#include "iolinki/device_info.h"
+#include "iolinki/iolink.h"
+#include "test_helpers.h"
+
+#if (IOLINK_PARAMS_FLUSH_DELAY_MS != 20U) || (IOLINK_PARAMS_FLUSH_COUNT != 4U)
+#error "test_params expects IOLINK_PARAMS_FLUSH_DELAY_MS=20 and IOLINK_PARAMS_FLUSH_COUNT=4"
+#endif
+
+static uint8_t g_nvm[256];
+static size_t g_nvm_used;
+static uint32_t g_nvm_write_calls;
+static bool g_nvm_fail;
+
+int iolink_nvm_read(uint32_t offset, uint8_t* data, size_t len)
+{
+    if ((data == NULL) || ((offset + len) > g_nvm_used)) {
+        return -1;
+    }
+    (void) memcpy(data, &g_nvm[offset], len);
+    return 0;
+}
+
+int iolink_nvm_write(uint32_t offset, const uint8_t* data, size_t len)
+{
+    g_nvm_write_calls++;
+    if (g_nvm_fail || (data == NULL) || ((offset + len) > sizeof(g_nvm))) {
+        return -1;
+    }
+    (void) memcpy(&g_nvm[offset], data, len);
+    if ((offset + len) > g_nvm_used) {
+        g_nvm_used = offset + len;
+    }
+    return 0;
+}
+
+static int test_setup(void** state)
+{
+    (void) state;
+    g_nvm_used = 0U;
+    g_nvm_write_calls = 0U;
+    g_nvm_fail = false;
+    iolink_device_info_init(NULL);
+    iolink_params_init();
+    return 0;
+}
+
+static uint32_t nvm_writes(void)
+{
+    iolink_params_stats_t stats;
+    iolink_params_get_stats(&stats);
+    assert_int_equal(stats.nvm_writes, g_nvm_write_calls);
+    return stats.nvm_writes;
+}
+
+static void set_tag(uint16_t index, const char* tag)
+{
+    assert_int_equal(
+        iolink_params_set(index, 0U, (const uint8_t*) tag, strlen(tag), true), 0);
+}
+
+static void expect_tag(uint16_t index, const char* tag)
+{
+    char buf[33] = {0};
+    assert_int_equal(iolink_params_get(index, 0U, (uint8_t*) buf, sizeof(buf) - 1U),
+                     (int) strlen(tag));
+    assert_string_equal(buf, tag);
+}
+
+static void test_params_write_is_deferred(void** state)
+{
+    (void) state;
+    set_tag(IOLINK_IDX_FUNCTION_TAG, "pump");
+    assert_true(iolink_params_dirty());
+    assert_int_equal(nvm_writes(), 0U);
+
+    /* Not due yet: neither the delay nor the count has been reached */
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 0U);
+
+    usleep(30000);
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 1U);
+    assert_false(iolink_params_dirty());
+
+    /* Survives a reload from NVM */
+    iolink_params_init();
+    expect_tag(IOLINK_IDX_FUNCTION_TAG, "pump");
+}
+
+static void test_params_count_forces_flush(void** state)
+{
+    (void) state;
+    for (int i = 0; i < 3; i++) {
+        set_tag(IOLINK_IDX_LOCATION_TAG, "hall");
+    }
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 0U);
+
+    set_tag(IOLINK_IDX_FUNCTION_TAG, "fan");
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 1U);
+
+    iolink_params_init();
+    expect_tag(IOLINK_IDX_LOCATION_TAG, "hall");
+    expect_tag(IOLINK_IDX_FUNCTION_TAG, "fan");
+}
+
+static void isdu_system_command(iolink_isdu_ctx_t* ctx, uint8_t cmd)
+{
+    assert_int_equal(isdu_send_write_request(ctx, IOLINK_IDX_SYSTEM_COMMAND, 0U, &cmd, 1U), 1);
+    iolink_isdu_process(ctx);
+    uint8_t resp[2];
+    assert_int_equal(isdu_collect_response(ctx, resp, sizeof(resp)), 0);
+}
+
+static void test_params_block_download_flushes_once(void** state)
+{
+    (void) state;
+    iolink_isdu_ctx_t ctx;
+    iolink_isdu_init(&ctx);
+
+    isdu_system_command(&ctx, IOLINK_CMD_PARAM_DOWNLOAD_START);
+
+    /* 20 parameter writes from the master */
+    static const uint16_t indices[] = {IOLINK_IDX_FUNCTION_TAG, IOLINK_IDX_LOCATION_TAG};
+    for (uint8_t i = 0U; i < 20U; i++) {
+        uint8_t tag[4] = {'t', 'a', 'g', (uint8_t) ('A' + i)};
+        assert_int_equal(
+            isdu_send_write_request(&ctx, indices[i % 2U], 0U, tag, sizeof(tag)), 1);
+        iolink_isdu_process(&ctx);
+        uint8_t resp[2];
+        assert_int_equal(isdu_collect_response(&ctx, resp, sizeof(resp)), 0);
+        iolink_params_process();
+    }
+
+    /* Held back during the block, even past the count and delay */
+    usleep(30000);
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 0U);
+
+    isdu_system_command(&ctx, IOLINK_CMD_PARAM_DOWNLOAD_END);
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 1U);
+
+    iolink_params_stats_t stats;
+    iolink_params_get_stats(&stats);
+    assert_int_equal(stats.persisted_sets, 20U);
+
+    iolink_params_init();
+    expect_tag(IOLINK_IDX_FUNCTION_TAG, "tagS");
+    expect_tag(IOLINK_IDX_LOCATION_TAG, "tagT");
+}
+
+static void test_params_failed_write_stays_dirty(void** state)
+{
+    (void) state;
+    set_tag(IOLINK_IDX_LOCATION_TAG, "dock");
+
+    g_nvm_fail = true;
+    assert_int_equal(iolink_params_flush(), -1);
+    assert_true(iolink_params_dirty());
+    g_nvm_fail = false;
+
+    iolink_params_stats_t stats;
+    iolink_params_get_stats(&stats);
+    assert_int_equal(stats.nvm_errors, 1U);
+
+    /* The retry rewrites the whole dirty range */
+    assert_int_equal(iolink_params_flush(), 0);
+    assert_false(iolink_params_dirty());
+    iolink_params_init();
+    expect_tag(IOLINK_IDX_LOCATION_TAG, "dock");
+}
+
+static void test_params_factory_reset_flushes_immediately(void** state)
+{
+    (void) state;
+    set_tag(IOLINK_IDX_FUNCTION_TAG, "old");
+    assert_int_equal(iolink_params_flush(), 0);
+
+    iolink_params_factory_reset();
+    assert_true(iolink_params_dirty());
+    iolink_params_process();
+    assert_false(iolink_params_dirty());
+
+    iolink_params_init();
+    expect_tag(IOLINK_IDX_FUNCTION_TAG, "");
+}
+
+/* Bringing up another port must not reload the shared parameters */
+static void test_params_second_instance_keeps_unsaved(void** state)
+{
+    (void) state;
+    static const iolink_phy_api_t phy = {0};
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    iolink_instance_t port_a;
+    iolink_instance_t port_b;
+    assert_int_equal(iolink_instance_init(&port_a, &phy, &config), 0);
+
+    set_tag(IOLINK_IDX_FUNCTION_TAG, "pump");
+    isdu_system_command(&port_a.dll.isdu, IOLINK_CMD_PARAM_DOWNLOAD_START);
+    uint8_t tag[4] = {'h', 'a', 'l', 'l'};
+    assert_int_equal(
+        isdu_send_write_request(&port_a.dll.isdu, IOLINK_IDX_LOCATION_TAG, 0U, tag, sizeof(tag)),
+        1);
+    iolink_isdu_process(&port_a.dll.isdu);
+    uint8_t resp[2];
+    assert_int_equal(isdu_collect_response(&port_a.dll.isdu, resp, sizeof(resp)), 0);
+
+    assert_int_equal(iolink_instance_init(&port_b, &phy, &config), 0);
+    assert_true(iolink_params_dirty());
+    expect_tag(IOLINK_IDX_FUNCTION_TAG, "pump");
+    expect_tag(IOLINK_IDX_LOCATION_TAG, "hall");
+
+    /* The block download on port A is still running: nothing is flushed yet */
+    usleep(30000);
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 0U);
+
+    isdu_system_command(&port_a.dll.isdu, IOLINK_CMD_PARAM_DOWNLOAD_END);
+    iolink_params_process();
+    assert_int_equal(nvm_writes(), 1U);
+    iolink_params_init();
+    expect_tag(IOLINK_IDX_FUNCTION_TAG, "pump");
+    expect_tag(IOLINK_IDX_LOCATION_TAG, "hall");
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup(test_params_write_is_deferred, test_setup),
+        cmocka_unit_test_setup(test_params_count_forces_flush, test_setup),
+        cmocka_unit_test_setup(test_params_block_download_flushes_once, test_setup),
+        cmocka_unit_test_setup(test_params_failed_write_stays_dirty, test_setup),
+        cmocka_unit_test_setup(test_params_factory_reset_flushes_immediately, test_setup),
+        cmocka_unit_test_setup(test_params_second_instance_keeps_unsaved, test_setup),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -58,10 +58,34 @@ static void test_pd_input_output(void** state)
     iolink_process();
 }
 
+#ifdef IOLINK_FIXED_M_SEQ_TYPE
+/* Build pinned to Type 2_2 with 2/2 PD bytes: other link settings are refused */
+static void test_pd_fixed_link_rejects_other_config(void** state)
+{
+    (void) state;
+    iolink_instance_t inst;
+    iolink_config_t config = {.pd_in_len = 2, .pd_out_len = 2, .m_seq_type = IOLINK_M_SEQ_TYPE_1_2};
+    assert_int_equal(iolink_instance_init(&inst, &g_phy_mock, &config), -1);
+    config.m_seq_type = IOLINK_M_SEQ_TYPE_2_2;
+    config.pd_out_len = 4;
+    assert_int_equal(iolink_instance_init(&inst, &g_phy_mock, &config), -1);
+
+    config.pd_out_len = 2;
+    setup_mock_phy();
+    will_return(mock_phy_init, 0);
+    assert_int_equal(iolink_instance_init(&inst, &g_phy_mock, &config), 0);
+    assert_int_equal(iolink_dll_set_pd_length(&inst.dll, 1U, 2U), -1);
+    assert_int_equal(iolink_dll_set_pd_length(&inst.dll, 2U, 2U), 0);
+}
+#endif
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_pd_input_output),
+#ifdef IOLINK_FIXED_M_SEQ_TYPE
+        cmocka_unit_test(test_pd_fixed_link_rejects_other_config),
+#endif
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
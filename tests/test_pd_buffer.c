@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_pd_buffer.c
+ * @brief Unit tests for the wait-free Process Data triple buffer
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iolinki/pd_buffer.h"
+
+static void publish_byte(iolink_pd_buffer_t* buf, uint8_t value)
+{
+    iolink_pd_slot_t* slot = iolink_pd_buffer_write_slot(buf);
+    slot->data[0] = value;
+    slot->len = 1U;
+    slot->valid = true;
+    iolink_pd_buffer_publish(buf);
+}
+
+static void test_pd_buffer_nothing_published(void** state)
+{
+    (void) state;
+    iolink_pd_buffer_t buf;
+    iolink_pd_buffer_init(&buf);
+
+    assert_false(iolink_pd_buffer_acquire(&buf));
+    const iolink_pd_slot_t* slot = iolink_pd_buffer_read_slot(&buf);
+    assert_int_equal(slot->len, 0U);
+    assert_int_equal(slot->data[0], 0U);
+}
+
+static void test_pd_buffer_latest_wins(void** state)
+{
+    (void) state;
+    iolink_pd_buffer_t buf;
+    iolink_pd_buffer_init(&buf);
+
+    publish_byte(&buf, 0x11U);
+    publish_byte(&buf, 0x22U);
+    publish_byte(&buf, 0x33U);
+
+    assert_true(iolink_pd_buffer_acquire(&buf));
+    assert_int_equal(iolink_pd_buffer_read_slot(&buf)->data[0], 0x33U);
+
+    /* Nothing new: the consumer keeps its sample */
+    assert_false(iolink_pd_buffer_acquire(&buf));
+    assert_int_equal(iolink_pd_buffer_read_slot(&buf)->data[0], 0x33U);
+}
+
+static void test_pd_buffer_reader_slot_is_stable(void** state)
+{
+    (void) state;
+    iolink_pd_buffer_t buf;
+    iolink_pd_buffer_init(&buf);
+
+    publish_byte(&buf, 0xA0U);
+    assert_true(iolink_pd_buffer_acquire(&buf));
+    const iolink_pd_slot_t* held = iolink_pd_buffer_read_slot(&buf);
+
+    /* However often the producer publishes, it never writes the consumer's slot */
+    for (uint8_t i = 0U; i < 10U; i++) {
+        assert_true(iolink_pd_buffer_write_slot(&buf) != held);
+        publish_byte(&buf, i);
+        assert_int_equal(held->data[0], 0xA0U);
+    }
+
+    assert_true(iolink_pd_buffer_acquire(&buf));
+    assert_int_equal(iolink_pd_buffer_read_slot(&buf)->data[0], 9U);
+}
+
+static void test_pd_buffer_slots_distinct(void** state)
+{
+    (void) state;
+    iolink_pd_buffer_t buf;
+    iolink_pd_buffer_init(&buf);
+
+    for (uint8_t i = 0U; i < 8U; i++) {
+        publish_byte(&buf, i);
+        if ((i % 3U) == 0U) {
+            (void) iolink_pd_buffer_acquire(&buf);
+        }
+        uint32_t shared = buf.shared & 0x03U;
+        assert_true(buf.back != buf.front);
+        assert_true(buf.back != shared);
+        assert_true(buf.front != shared);
+    }
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_pd_buffer_nothing_published),
+        cmocka_unit_test(test_pd_buffer_latest_wins),
+        cmocka_unit_test(test_pd_buffer_reader_slot_is_stable),
+        cmocka_unit_test(test_pd_buffer_slots_distinct),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
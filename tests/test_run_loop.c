@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_run_loop.c
+ * @brief Blocking epoll run loop driven by a pipe-backed PHY
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "iolinki/run_loop.h"
+#include "iolinki/dll.h"
+#include "iolinki/crc.h"
+#include "iolinki/protocol.h"
+#include "iolinki/time_utils.h"
+
+static int g_pipe[2] = {-1, -1};
+static uint32_t g_sent_frames;
+static size_t g_sent_len;
+static iolink_instance_t g_inst;
+static iolink_run_loop_t g_loop;
+
+static int pipe_phy_init(void)
+{
+    return 0;
+}
+
+static void pipe_phy_set_mode(iolink_phy_mode_t mode)
+{
+    (void) mode;
+}
+
+static void pipe_phy_set_baudrate(iolink_baudrate_t baudrate)
+{
+    (void) baudrate;
+}
+
+static int pipe_phy_send(const uint8_t* data, size_t len)
+{
+    (void) data;
+    g_sent_frames++;
+    g_sent_len = len;
+    return (int) len;
+}
+
+static int pipe_phy_recv_buf(uint8_t* buf, size_t len)
+{
+    ssize_t n = read(g_pipe[0], buf, len);
+    return (n > 0) ? (int) n : 0;
+}
+
+static int pipe_phy_detect_wakeup(void)
+{
+    uint8_t b;
+    while (read(g_pipe[0], &b, 1) > 0) {
+        if (b == 0x55U) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const iolink_phy_api_t g_pipe_phy = {
+    .init = pipe_phy_init,
+    .set_mode = pipe_phy_set_mode,
+    .set_baudrate = pipe_phy_set_baudrate,
+    .send = pipe_phy_send,
+    .detect_wakeup = pipe_phy_detect_wakeup,
+    .recv_buf = pipe_phy_recv_buf,
+};
+
+static void master_write(const uint8_t* data, size_t len)
+{
+    assert_int_equal(write(g_pipe[1], data, len), (ssize_t) len);
+}
+
+static uint32_t elapsed_ms(iolink_usec_t since)
+{
+    return (uint32_t) (iolink_usec_elapsed(iolink_time_get_us(), since) / 1000U);
+}
+
+static int test_setup(void** state)
+{
+    (void) state;
+    assert_int_equal(pipe(g_pipe), 0);
+    assert_int_equal(fcntl(g_pipe[0], F_SETFL, O_NONBLOCK), 0);
+    g_sent_frames = 0U;
+    g_sent_len = 0U;
+
+    assert_int_equal(iolink_instance_init(&g_inst, &g_pipe_phy, NULL), 0);
+    iolink_dll_set_timing_enforcement(&g_inst.dll, true);
+    assert_int_equal(iolink_run_loop_init(&g_loop, &g_inst, g_pipe[0]), 0);
+    return 0;
+}
+
+static int test_teardown(void** state)
+{
+    (void) state;
+    iolink_run_loop_close(&g_loop);
+    (void) close(g_pipe[0]);
+    (void) close(g_pipe[1]);
+    return 0;
+}
+
+/* Wake-up, then a complete frame: each is handled as soon as it arrives */
+static void test_run_loop_io_wakeup(void** state)
+{
+    (void) state;
+    const uint8_t wakeup = 0x55U;
+    master_write(&wakeup, 1U);
+    assert_int_equal(iolink_run_loop_once(&g_loop, 1000), IOLINK_RUN_LOOP_IO);
+    assert_int_equal(iolink_instance_get_state(&g_inst), IOLINK_DLL_STATE_AWAITING_COMM);
+
+    /* The wake-up hold (t_DWU) ends on the timer, not on max_wait_ms */
+    iolink_usec_t start = iolink_time_get_us();
+    assert_int_equal(iolink_run_loop_once(&g_loop, 1000), IOLINK_RUN_LOOP_TIMER);
+    assert_true(elapsed_ms(start) < 100U);
+
+    uint8_t frame[2] = {0x00U, 0x00U};
+    frame[1] = iolink_checksum_ck(frame[0], 0U);
+    master_write(frame, sizeof(frame));
+    assert_int_equal(iolink_run_loop_once(&g_loop, 1000), IOLINK_RUN_LOOP_IO);
+    assert_int_equal(g_sent_frames, 1U);
+    assert_int_equal(g_sent_len, 2U);
+    assert_int_equal(iolink_instance_get_state(&g_inst), IOLINK_DLL_STATE_PREOPERATE);
+    assert_int_equal(g_loop.io_wakeups, 2U);
+    assert_int_equal(g_loop.timer_wakeups, 1U);
+}
+
+/* SIO mode without traffic: the loop wakes for the wake-up poll, not after max_wait_ms */
+static void test_run_loop_sio_wakeup_poll(void** state)
+{
+    (void) state;
+    iolink_usec_t deadline_us;
+    assert_true(iolink_dll_next_deadline(&g_inst.dll, &deadline_us));
+
+    iolink_usec_t start = iolink_time_get_us();
+    assert_int_equal(iolink_run_loop_once(&g_loop, 1000), IOLINK_RUN_LOOP_TIMER);
+    assert_true(elapsed_ms(start) < 100U);
+    assert_int_equal(g_loop.timer_wakeups, 1U);
+    assert_int_equal(g_loop.idle_wakeups, 0U);
+}
+
+/* A partial frame is dropped at t_byte, then the silent master times out */
+static void test_run_loop_deadlines(void** state)
+{
+    (void) state;
+    const uint8_t wakeup = 0x55U;
+    master_write(&wakeup, 1U);
+    assert_int_equal(iolink_run_loop_once(&g_loop, 1000), IOLINK_RUN_LOOP_IO);
+    assert_int_equal(iolink_run_loop_once(&g_loop, 1000), IOLINK_RUN_LOOP_TIMER);
+
+    const uint8_t mc = 0x00U;
+    master_write(&mc, 1U);
+    assert_int_equal(iolink_run_loop_once(&g_loop, 1000), IOLINK_RUN_LOOP_IO);
+
+    iolink_usec_t start = iolink_time_get_us();
+    assert_int_equal(iolink_run_loop_once(&g_loop, 5000), IOLINK_RUN_LOOP_TIMER);
+    assert_true(elapsed_ms(start) < 100U);
+    iolink_dll_stats_t stats;
+    iolink_dll_get_stats(&g_inst.dll, &stats);
+    assert_int_equal(stats.t_byte_violations, 1U);
+    assert_int_equal(g_sent_frames, 0U);
+
+    /* About 1 s after the last byte the DLL falls back to STARTUP */
+    start = iolink_time_get_us();
+    assert_int_equal(iolink_run_loop_once(&g_loop, 5000), IOLINK_RUN_LOOP_TIMER);
+    assert_true(elapsed_ms(start) < 2000U);
+    assert_int_equal(iolink_instance_get_state(&g_inst), IOLINK_DLL_STATE_STARTUP);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_run_loop_io_wakeup, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_run_loop_sio_wakeup_poll, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_run_loop_deadlines, test_setup, test_teardown),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
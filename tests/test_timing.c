@@ -229,12 +229,91 @@ static void test_t_byte_violation(void** state)
     assert_true(stats.t_byte_violations > 0U);
 }
 
+static void test_next_deadline(void** state)
+{
+    (void) state;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_0, .t_pd_us = 2000U};
+    iolink_usec_t due_us;
+
+    setup_mock_phy();
+    will_return(mock_phy_init, 0);
+    iolink_init(&g_phy_mock, &config);
+    iolink_set_timing_enforcement(true);
+
+    /* Power-on delay */
+    assert_true(iolink_next_deadline_us(&due_us));
+    assert_true(iolink_usec_elapsed(due_us, iolink_time_get_us()) <= 2000U);
+    usleep(3000);
+    iolink_process();
+    assert_int_equal(iolink_get_phy_mode(), IOLINK_PHY_MODE_SIO);
+    assert_true(iolink_next_deadline_us(&due_us));
+    assert_true(iolink_usec_elapsed(due_us, iolink_time_get_us()) <= IOLINK_WAKEUP_POLL_US);
+
+    /* Wake-up hold */
+    iolink_phy_mock_set_wakeup(1);
+    iolink_process();
+    assert_true(iolink_next_deadline_us(&due_us));
+    assert_true(iolink_usec_elapsed(due_us, iolink_time_get_us()) <= IOLINK_T_DWU_US);
+    usleep(200);
+
+    /* A partial frame: t_byte comes long before the activity timeout */
+    will_return(mock_phy_recv_byte, 1);
+    will_return(mock_phy_recv_byte, 0x00);
+    will_return(mock_phy_recv_byte, 0);
+    iolink_process();
+    assert_true(iolink_next_deadline_us(&due_us));
+    assert_true(iolink_usec_elapsed(due_us, iolink_time_get_us()) < 1000U);
+
+    usleep(2000);
+    will_return(mock_phy_recv_byte, 0);
+    iolink_process();
+    iolink_dll_stats_t stats;
+    iolink_get_dll_stats(&stats);
+    assert_int_equal(stats.t_byte_violations, 1U);
+
+    assert_true(iolink_next_deadline_us(&due_us));
+    assert_true(iolink_usec_elapsed(due_us, iolink_time_get_us()) > 900000U);
+}
+
+/* In SIO mode nothing is armed, yet a tickless loop must come back to poll for wake-up */
+static void test_next_deadline_sio_wakeup_poll(void** state)
+{
+    (void) state;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_0};
+    iolink_usec_t due_us;
+
+    setup_mock_phy();
+    will_return(mock_phy_init, 0);
+    iolink_init(&g_phy_mock, &config);
+    iolink_process();
+    assert_int_equal(iolink_get_phy_mode(), IOLINK_PHY_MODE_SIO);
+
+    iolink_usec_t before_us = iolink_time_get_us();
+    assert_true(iolink_next_deadline_us(&due_us));
+    assert_true(iolink_usec_elapsed(due_us, before_us) <= IOLINK_WAKEUP_POLL_US);
+
+    /* Sleeping until the deadline is enough to pick up a latched wake-up request */
+    iolink_phy_mock_set_wakeup(1);
+    while (iolink_usec_before(iolink_time_get_us(), due_us)) {
+        usleep(100);
+    }
+    iolink_process();
+    assert_int_equal(iolink_get_state(), IOLINK_DLL_STATE_AWAITING_COMM);
+    assert_int_equal(iolink_get_phy_mode(), IOLINK_PHY_MODE_SDCI);
+
+    /* Back in SDCI only the wake-up hold is left */
+    assert_true(iolink_next_deadline_us(&due_us));
+    assert_true(iolink_usec_elapsed(due_us, iolink_time_get_us()) <= IOLINK_T_DWU_US);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_time_get_ms),       cmocka_unit_test(test_time_get_us),
         cmocka_unit_test(test_t_cycle_violation), cmocka_unit_test(test_t_ren_violation),
         cmocka_unit_test(test_t_pd_delay),        cmocka_unit_test(test_t_byte_violation),
+        cmocka_unit_test(test_next_deadline),
+        cmocka_unit_test(test_next_deadline_sio_wakeup_poll),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2026 Andrii Shylenko
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of iolinki.
+ * See LICENSE for details.
+ */
+
+/**
+ * @file test_trace.c
+ * @brief Unit tests for the frame trace ring and pcapng export
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iolinki/iolink.h"
+#include "iolinki/trace.h"
+#include "iolinki/trace_pcapng.h"
+#include "test_helpers.h"
+
+static uint8_t g_storage[256];
+
+static int test_setup(void** state)
+{
+    (void) state;
+    iolink_nvm_mock_cleanup();
+    return 0;
+}
+
+static int test_teardown(void** state)
+{
+    (void) state;
+    iolink_nvm_mock_cleanup();
+    return 0;
+}
+
+static void test_trace_init_rejects_bad_size(void** state)
+{
+    (void) state;
+    iolink_trace_ring_t ring;
+    assert_int_equal(iolink_trace_init(&ring, g_storage, 100U), -1);
+    assert_int_equal(iolink_trace_init(&ring, g_storage, 32U), -1);
+    assert_int_equal(iolink_trace_init(&ring, NULL, 256U), -1);
+    assert_int_equal(iolink_trace_init(&ring, g_storage, 256U), 0);
+}
+
+static void test_trace_roundtrip(void** state)
+{
+    (void) state;
+    iolink_trace_ring_t ring;
+    assert_int_equal(iolink_trace_init(&ring, g_storage, sizeof(g_storage)), 0);
+
+    const uint8_t rx[5] = {0x80U, 0x00U, 0x11U, 0x00U, 0x2AU};
+    const uint8_t tx[4] = {0x20U, 0x22U, 0x00U, 0x15U};
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_RX, 4U, IOLINK_TRACE_FLAG_CRC_OK,
+                                   1000000000ULL, rx, sizeof(rx)));
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_TX, 4U, 0U, 1000000150ULL, tx,
+                                   sizeof(tx)));
+
+    iolink_trace_record_t rec;
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_int_equal(rec.dir, IOLINK_TRACE_DIR_RX);
+    assert_int_equal(rec.state, 4U);
+    assert_int_equal(rec.flags, IOLINK_TRACE_FLAG_CRC_OK);
+    assert_true(rec.ts_us == 1000000000ULL);
+    assert_int_equal(rec.len, sizeof(rx));
+    assert_memory_equal(rec.data, rx, sizeof(rx));
+
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_int_equal(rec.dir, IOLINK_TRACE_DIR_TX);
+    assert_true(rec.ts_us == 1000000150ULL);
+    assert_memory_equal(rec.data, tx, sizeof(tx));
+
+    assert_int_equal(iolink_trace_read(&ring, &rec), 0);
+}
+
+static void test_trace_drops_when_full_and_wraps(void** state)
+{
+    (void) state;
+    iolink_trace_ring_t ring;
+    assert_int_equal(iolink_trace_init(&ring, g_storage, 64U), 0);
+
+    uint8_t frame[20];
+    for (uint8_t i = 0U; i < sizeof(frame); i++) {
+        frame[i] = i;
+    }
+
+    /* 23 bytes per record (hdr + 1-byte delta + len + 20): two fit, the third drops */
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_RX, 0U, 0U, 1U, frame, 20U));
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_RX, 0U, 0U, 2U, frame, 20U));
+    assert_false(iolink_trace_write(&ring, IOLINK_TRACE_DIR_RX, 0U, 0U, 3U, frame, 20U));
+    assert_int_equal(iolink_trace_dropped(&ring), 1U);
+
+    /* Consume and keep writing across the wrap point */
+    iolink_trace_record_t rec;
+    uint64_t ts = 10U;
+    for (int i = 0; i < 20; i++) {
+        assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+        assert_memory_equal(&rec.data[1], &frame[1], 19U);
+        frame[0] = (uint8_t) i;
+        assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_TX, 0U, 0U, ts, frame, 20U));
+        ts += 100U;
+    }
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_true(rec.ts_us == ts - 100U);
+    assert_int_equal(rec.data[0], 19U);
+    assert_int_equal(iolink_trace_read(&ring, &rec), 0);
+}
+
+static void test_trace_clamps_after_zero_stamp(void** state)
+{
+    (void) state;
+    iolink_trace_ring_t ring;
+    assert_int_equal(iolink_trace_init(&ring, g_storage, sizeof(g_storage)), 0);
+
+    /* A record stamped 0 is a real previous record; a stamp just before it is clamped */
+    const uint8_t frame[2] = {0x80U, 0x2AU};
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_RX, 0U, 0U, 0U, frame, 2U));
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_TX, 0U, 0U, (iolink_usec_t) 0U - 100U,
+                                   frame, 2U));
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_RX, 0U, 0U, 50U, frame, 2U));
+
+    iolink_trace_record_t rec;
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_true(rec.ts_us == 0U);
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_true(rec.ts_us == 0U);
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_true(rec.ts_us == 50U);
+    assert_int_equal(iolink_trace_read(&ring, &rec), 0);
+}
+
+static void test_trace_dll_records_frames(void** state)
+{
+    (void) state;
+    iolink_config_t config = {.m_seq_type = IOLINK_M_SEQ_TYPE_1_1, .pd_in_len = 1, .pd_out_len = 1};
+    setup_mock_phy();
+    will_return(mock_phy_init, 0);
+    iolink_init(&g_phy_mock, &config);
+    move_to_operate();
+
+    iolink_trace_ring_t ring;
+    assert_int_equal(iolink_trace_init(&ring, g_storage, sizeof(g_storage)), 0);
+    iolink_dll_trace_attach(&iolink_get_default_instance()->dll, &ring);
+
+    uint8_t frame[5] = {0x80U, 0x00U, 0x33U, 0x00U, 0x00U};
+    frame[4] = iolink_crc6(frame, 4U);
+    for (int i = 0; i < 5; i++) {
+        will_return(mock_phy_recv_byte, 1);
+        will_return(mock_phy_recv_byte, frame[i]);
+    }
+    will_return(mock_phy_recv_byte, 0);
+    expect_any(mock_phy_send, data);
+    expect_value(mock_phy_send, len, 4);
+    will_return(mock_phy_send, 0);
+    iolink_process();
+
+    iolink_trace_record_t rec;
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_int_equal(rec.dir, IOLINK_TRACE_DIR_RX);
+    assert_int_equal(rec.state, IOLINK_DLL_STATE_OPERATE);
+    assert_int_equal(rec.flags, IOLINK_TRACE_FLAG_CRC_OK);
+    assert_int_equal(rec.len, 5U);
+    assert_memory_equal(rec.data, frame, 5U);
+    uint64_t rx_ts = rec.ts_us;
+
+    assert_int_equal(iolink_trace_read(&ring, &rec), 1);
+    assert_int_equal(rec.dir, IOLINK_TRACE_DIR_TX);
+    assert_int_equal(rec.len, 4U);
+    assert_true(rec.ts_us >= rx_ts);
+    assert_int_equal(iolink_trace_read(&ring, &rec), 0);
+
+    iolink_dll_trace_attach(&iolink_get_default_instance()->dll, NULL);
+}
+
+static void test_trace_pcapng_export(void** state)
+{
+    (void) state;
+    iolink_trace_ring_t ring;
+    assert_int_equal(iolink_trace_init(&ring, g_storage, sizeof(g_storage)), 0);
+    const uint8_t rx[2] = {0x0FU, 0x25U};
+    assert_true(iolink_trace_write(&ring, IOLINK_TRACE_DIR_RX, 1U, IOLINK_TRACE_FLAG_CRC_OK,
+                                   0x100000002ULL, rx, sizeof(rx)));
+
+    FILE* fp = tmpfile();
+    assert_non_null(fp);
+    assert_int_equal(iolink_trace_pcapng_begin(fp), 0);
+    assert_int_equal(iolink_trace_pcapng_drain(&ring, fp), 1);
+    assert_int_equal(iolink_trace_pcapng_drain(&ring, fp), 0);
+
+    uint8_t buf[128];
+    long size = ftell(fp);
+    assert_int_equal(size, 28 + 20 + 40);
+    rewind(fp);
+    assert_int_equal(fread(buf, 1U, (size_t) size, fp), (size_t) size);
+    (void) fclose(fp);
+
+    uint32_t word;
+    uint16_t half;
+    memcpy(&word, &buf[0], 4U);
+    assert_int_equal(word, 0x0A0D0D0AU);
+    memcpy(&word, &buf[8], 4U);
+    assert_int_equal(word, 0x1A2B3C4DU);
+    memcpy(&word, &buf[28], 4U);
+    assert_int_equal(word, 1U);
+    memcpy(&half, &buf[36], 2U);
+    assert_int_equal(half, IOLINK_TRACE_PCAPNG_LINKTYPE);
+
+    const uint8_t* epb = &buf[48];
+    memcpy(&word, &epb[0], 4U);
+    assert_int_equal(word, 6U);
+    memcpy(&word, &epb[12], 4U);
+    assert_int_equal(word, 1U); /* Timestamp high */
+    memcpy(&word, &epb[16], 4U);
+    assert_int_equal(word, 2U); /* Timestamp low */
+    memcpy(&word, &epb[20], 4U);
+    assert_int_equal(word, 6U); /* Pseudo-header + 2 frame bytes */
+    const uint8_t expected[6] = {IOLINK_TRACE_DIR_RX, 1U, IOLINK_TRACE_FLAG_CRC_OK, 2U, 0x0FU,
+                                 0x25U};
+    assert_memory_equal(&epb[28], expected, sizeof(expected));
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_trace_init_rejects_bad_size),
+        cmocka_unit_test(test_trace_roundtrip),
+        cmocka_unit_test(test_trace_drops_when_full_and_wraps),
+        cmocka_unit_test(test_trace_clamps_after_zero_stamp),
+        cmocka_unit_test_setup_teardown(test_trace_dll_records_frames, test_setup, test_teardown),
+        cmocka_unit_test(test_trace_pcapng_export),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}